@@ -0,0 +1,64 @@
+/*
+  Set the frequency offset of the SiT5811 OCXO using integer math only.
+
+  On AVR platforms double is a 32-bit float. That is far too coarse for the
+  39-bit frequency control word: at 10MHz, float cannot represent a change of
+  less than 1Hz. setFrequencyOffsetPPQ and getFrequencyOffsetPPQ use int64_t
+  parts per quadrillion (1e-15) instead and are exact on every platform.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
+SfeSiT5811ArdI2C myOCXO;
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  int64_t ppq = 1000000000; // +1ppm = 1e9 PPQ
+
+  unsigned long start = micros();
+  myOCXO.setFrequencyOffsetPPQ(ppq); // Set the frequency offset to +1ppm
+  unsigned long elapsed = micros() - start;
+
+  Serial.print("setFrequencyOffsetPPQ took ");
+  Serial.print(elapsed);
+  Serial.println(" us (including the I2C write)");
+
+  // Frequency control word should be 1ppm / 800ppm * 2^38 , rounded to nearest
+  Serial.print("Frequency control word should be 343597384. It is ");
+  Serial.println((long)myOCXO.getFrequencyControlWord()); // Both values fit in a long. (AVR Print does not support int64_t)
+
+  // The offset is quantized to the nearest LSB (2.91 PPQ)
+  Serial.print("Frequency offset should be 1000000001 PPQ. It is ");
+  Serial.println((long)myOCXO.getFrequencyOffsetPPQ());
+}
+
+void loop()
+{
+  // Nothing to do here
+}
@@ -0,0 +1,81 @@
+/*
+  Update the frequency of the SiT5811 OCXO asynchronously.
+
+  In asynchronous mode, setFrequencyHz (and the other setters) only store the new
+  frequency control word and return immediately. poll() writes it when the main loop
+  has time. If the word is changed several times before poll() writes it, only the
+  latest word is written. A callback reports completion or failure.
+
+  Note: Arduino Wire is blocking, so the I2C write happens inside poll(). The setter
+  itself never waits for the bus.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
+SfeSiT5811ArdI2C myOCXO;
+
+// Called by poll() when the write completes or fails
+void writeComplete(bool success, int64_t freq, void *context)
+{
+  (void)context;
+
+  Serial.print("Write of frequency control word ");
+  Serial.print((long)freq); // The words in this example fit in a long. (AVR Print does not support int64_t)
+  Serial.println(success ? " complete" : " FAILED");
+}
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setAsyncCallback(writeComplete);
+  myOCXO.setAsyncMode(true);
+}
+
+void loop()
+{
+  static unsigned long lastChange = 0;
+  static double offset = 0.0;
+
+  if (millis() > (lastChange + 1000))
+  {
+    lastChange = millis();
+
+    // Change the frequency three times. Only the last change will be written
+    myOCXO.setFrequencyHz(10000000.0 + offset + 0.001);
+    myOCXO.setFrequencyHz(10000000.0 + offset + 0.002);
+    myOCXO.setFrequencyHz(10000000.0 + offset + 0.003);
+
+    offset = (offset >= 1.0) ? 0.0 : offset + 0.1;
+  }
+
+  myOCXO.poll(); // Write the pending word when the loop has time
+
+  // Service GNSS, PPS, etc. here
+}
@@ -0,0 +1,90 @@
+/*
+  Log every steering step of the SiT5811 OCXO to a compact binary telemetry buffer.
+
+  Each call of setFrequencyByBiasMillis adds a record to the buffer: the timestamp,
+  the clock bias, the frequency control word, whether the step was limited, and the
+  bus status if the write failed. Records are delta-encoded and are typically 6-8 bytes.
+  The buffer is a fixed-size ring (no heap). If it fills, records are dropped and
+  counted - the steering loop is never delayed.
+
+  The buffer is drained zero-copy: getReadable returns a pointer into the ring which
+  is passed straight to Serial.write, then consume releases the bytes.
+
+  The binary stream is written to Serial1. Capture it and decode it on a PC with
+  extras/host/SiT5811_TelemetryDecode.cpp. The Serial console shows a summary.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
+SfeSiT5811ArdI2C myOCXO;
+
+SfeSiT5811TelemetryN<256> myTelemetry; // 256 bytes: approx. 35 records
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Serial1.begin(115200); // The telemetry stream
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setMaxFrequencyChangePPB(3.0); // Set the maximum frequency change in PPB
+
+  myOCXO.setTelemetry(&myTelemetry); // setFrequencyByBiasMillis now logs each step
+}
+
+void loop()
+{
+  static unsigned long lastStep = 0;
+  static double bias = 200.0e-6; // Replace this with the RxClkBias from your GNSS receiver
+
+  if (millis() > (lastStep + 1000))
+  {
+    lastStep = millis();
+
+    myOCXO.setFrequencyByBiasMillis(bias);
+
+    bias *= 0.9; // Pretend the bias is being removed
+
+    Serial.print("Records: ");
+    Serial.print(myTelemetry.getRecords());
+    Serial.print(" Dropped: ");
+    Serial.println(myTelemetry.getDropped());
+  }
+
+  // Drain the telemetry without copying it. Only write what Serial1 can accept without blocking
+  const uint8_t *data;
+  size_t len = myTelemetry.getReadable(data);
+  if (len > 0)
+  {
+    size_t space = Serial1.availableForWrite();
+    if (len > space)
+      len = space;
+    if (len > 0)
+      myTelemetry.consume(Serial1.write(data, len));
+  }
+}
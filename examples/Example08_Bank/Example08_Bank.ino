@@ -0,0 +1,84 @@
+/*
+  Steer several SiT5811 OCXOs on one I2C bus as a bank.
+
+  The bank scans addresses 0x50 to 0x5F once. Each address gets a single combined
+  register read, which both detects the device and initializes the driver.
+
+  The devices are in asynchronous mode: setFrequencyHz (and the other setters) only
+  stage the new frequency control word. update() writes the staged words across the
+  bank in one batch. setMaxWritesPerUpdate bounds the writes per update, so the bus
+  time per cycle stays bounded as devices are added. Devices which miss an update
+  are written first next time, with their latest word.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+#include <SparkFun_SiT5811_Bank.h>
+
+SfeSiT5811ArdI2CBankN<4> myBank; // Up to four SiT5811s
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  uint8_t found = myBank.begin(Wire); // Scan 0x50 to 0x5F
+
+  Serial.print("Found ");
+  Serial.print(found);
+  Serial.println(" SiT5811s");
+
+  if (found == 0)
+  {
+    Serial.println("No SiT5811s detected! Please check the addresses and try again...");
+    while (1); // Do nothing more
+  }
+
+  for (uint8_t i = 0; i < found; i++)
+  {
+    Serial.print("Address 0x");
+    Serial.print(myBank.getAddress(i), HEX);
+    Serial.print(" clip ");
+    Serial.println(myBank.getDevice(i)->getPullRangeClip());
+
+    myBank.getDevice(i)->setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into each driver
+  }
+
+  myBank.setMaxWritesPerUpdate(2); // Write at most two devices per update
+}
+
+void loop()
+{
+  static unsigned long lastStep = 0;
+  static double offset = 0.0;
+
+  if (millis() > (lastStep + 1000))
+  {
+    lastStep = millis();
+
+    // Stage a new frequency for every device
+    for (uint8_t i = 0; i < myBank.getCount(); i++)
+      myBank.getDevice(i)->setFrequencyHz(10000000.0 + offset + (0.001 * i));
+
+    offset = (offset >= 1.0) ? 0.0 : offset + 0.1;
+  }
+
+  if (myBank.update() < 0) // Write the staged words
+    Serial.println("Write FAILED");
+}
@@ -0,0 +1,126 @@
+/*
+  Save the SiT5811 steering state to EEPROM and restore it after a reboot.
+
+  The discipline loop learns the oscillator's frequency offset in its integrator.
+  Without a snapshot, a reboot (or power cycle) loses it and the loop re-learns it
+  from scratch, with a large time error while it does. With a snapshot, the
+  integrator and the learned drift are restored at boot - before the GNSS receiver
+  has a fix - so the OCXO is steered correctly from the start.
+
+  The snapshot is 44 bytes, with a version and a CRC. A missing or corrupt snapshot
+  is rejected and the loop starts cold, as it would without one.
+
+  This example saves the snapshot every hour. The timestamp is in seconds. Use GNSS or
+  RTC time if you have it, so the learned drift can be extrapolated over the downtime.
+  Here it is zero (unknown) and the drift is not extrapolated.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
+#include <EEPROM.h>
+
+// Store the snapshot in EEPROM, starting at address 0
+class EEPROMStorage : public SfeSiT5811Storage
+{
+public:
+  bool read(uint8_t *data, size_t numBytes)
+  {
+    for (size_t i = 0; i < numBytes; i++)
+      data[i] = EEPROM.read(i);
+    return true;
+  }
+
+  bool write(const uint8_t *data, size_t numBytes)
+  {
+    for (size_t i = 0; i < numBytes; i++)
+    {
+      if (EEPROM.read(i) != data[i]) // Only write the bytes which have changed
+        EEPROM.write(i, data[i]);
+    }
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    return EEPROM.commit();
+#else
+    return true;
+#endif
+  }
+};
+
+SfeSiT5811ArdI2C myOCXO;
+
+EEPROMStorage myStorage;
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+  EEPROM.begin(kSfeSiT5811SnapshotBytes); // The EEPROM is emulated in flash
+#endif
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setMaxFrequencyChangePPB(3.0); // Set the maximum frequency change in PPB
+
+  // Restore the steering state as early as possible
+  if (myOCXO.restoreSnapshot(&myStorage))
+  {
+    Serial.print("Snapshot restored. Frequency: ");
+    Serial.println(myOCXO.getFrequencyHz(), 3);
+  }
+  else
+    Serial.println("No valid snapshot. Starting cold");
+}
+
+void loop()
+{
+  static unsigned long lastStep = 0;
+  static unsigned long lastSave = 0;
+  static double bias = 200.0e-6; // Replace this with the RxClkBias from your GNSS receiver
+
+  if (millis() > (lastStep + 1000))
+  {
+    lastStep = millis();
+
+    myOCXO.setFrequencyByBiasMillis(bias);
+
+    bias *= 0.9; // Pretend the bias is being removed
+
+    Serial.print("Frequency: ");
+    Serial.println(myOCXO.getFrequencyHz(), 3);
+  }
+
+  // Save the snapshot every hour. EEPROM has limited write endurance: don't save every second
+  if (millis() > (lastSave + 3600000))
+  {
+    lastSave = millis();
+
+    if (myOCXO.saveSnapshot(&myStorage))
+      Serial.println("Snapshot saved");
+    else
+      Serial.println("Snapshot save failed!");
+  }
+}
@@ -0,0 +1,92 @@
+/*
+  Keep steering the SiT5811 OCXO when the GNSS bias stops arriving.
+
+  While the bias is arriving, the holdover engine fits a straight line (frequency
+  and drift) to the control words written by setFrequencyByBiasMillis. If the bias
+  stops for more than the timeout (3 seconds), update() writes the predicted control
+  word every second. When the bias returns, steering continues from the prediction.
+
+  Leaving the last control word in place is not good enough: it includes the
+  proportional correction for the last bias. The fit averages that out and follows
+  the drift.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
+SfeSiT5811ArdI2C myOCXO;
+
+SfeSiT5811Holdover myHoldover;
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setMaxFrequencyChangePPB(3.0); // Set the maximum frequency change in PPB
+
+  myHoldover.setTimeConstant(3600.0); // Fit the last hour (approx.) of control words
+  myHoldover.setTimeout(3000); // Start holdover when there has been no bias for 3 seconds
+  myHoldover.setUpdateInterval(1000); // Write the predicted control word every second
+
+  myOCXO.setHoldover(&myHoldover); // setFrequencyByBiasMillis now feeds the fit
+}
+
+void loop()
+{
+  static unsigned long lastStep = 0;
+  static double bias = 200.0e-6; // Replace this with the RxClkBias from your GNSS receiver
+  static bool gnssAvailable = true; // Replace this with your receiver's fix status
+
+  if (millis() > (lastStep + 1000))
+  {
+    lastStep = millis();
+
+    if (gnssAvailable)
+    {
+      myOCXO.setFrequencyByBiasMillis(bias);
+
+      bias *= 0.9; // Pretend the bias is being removed
+    }
+
+    if (myHoldover.isActive())
+    {
+      Serial.print("Holdover for ");
+      Serial.print(myHoldover.getSecondsSinceBias(), 0);
+      Serial.print("s. Estimated time error bound: ");
+      Serial.print(myHoldover.getTimeErrorBound() * 1.0e9, 1);
+      Serial.println("ns");
+    }
+    else
+    {
+      Serial.print("Frequency: ");
+      Serial.println(myOCXO.getFrequencyHz(), 3);
+    }
+  }
+
+  myHoldover.update(); // Does nothing until the bias stops
+}
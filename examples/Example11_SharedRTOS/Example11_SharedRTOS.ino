@@ -0,0 +1,105 @@
+/*
+  Share the SiT5811 OCXO between FreeRTOS tasks on ESP32.
+
+  The steering task calls setFrequencyByBiasMillis once per second. The reporting
+  task prints the frequency and control word four times per second. Both go through
+  SfeSiT5811Shared: the steering is serialized by a FreeRTOS mutex, and the reports
+  copy the last published state without taking the mutex, so they never wait for I2C.
+
+  Anything else which talks to the driver (e.g. changing the discipline) must go
+  between acquire() and release().
+
+  This example needs an ESP32.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+#include <SparkFun_SiT5811_Shared.h>
+
+SfeSiT5811ArdI2C myOCXO;
+
+SfeSiT5811FreeRTOSLock ocxoLock;
+SfeSiT5811Shared sharedOCXO;
+
+void steeringTask(void *parameter)
+{
+  (void)parameter;
+
+  double bias = 200.0e-6; // Replace this with the RxClkBias from your GNSS receiver
+
+  while (1)
+  {
+    sharedOCXO.setFrequencyByBiasMillis(bias); // Serialized: only one task is on the bus
+
+    bias *= 0.9; // Pretend the bias is being removed
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+}
+
+void reportTask(void *parameter)
+{
+  (void)parameter;
+
+  while (1)
+  {
+    sfe_SiT5811_shared_state_t state;
+    sharedOCXO.read(state); // Never blocks. Word, frequency and bias are from the same update
+
+    Serial.print("Update ");
+    Serial.print(state.updates);
+    Serial.print(": frequency ");
+    Serial.print(state.frequencyHz, 3);
+    Serial.print("Hz, control word ");
+    Serial.print((long)(state.frequencyControl >> 32));
+    Serial.print(":");
+    Serial.print((unsigned long)(state.frequencyControl & 0xFFFFFFFF));
+    Serial.print(", bias ");
+    Serial.print(state.lastBiasMillis * 1.0e6, 1);
+    Serial.println("ns");
+
+    vTaskDelay(pdMS_TO_TICKS(250));
+  }
+}
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setMaxFrequencyChangePPB(3.0); // Set the maximum frequency change in PPB
+
+  sharedOCXO.begin(&myOCXO, &ocxoLock); // From here on, use sharedOCXO - not myOCXO
+
+  xTaskCreate(steeringTask, "steering", 4096, nullptr, 2, nullptr); // Steering has the higher priority
+  xTaskCreate(reportTask, "report", 4096, nullptr, 1, nullptr);
+}
+
+void loop()
+{
+  vTaskDelay(pdMS_TO_TICKS(1000)); // Nothing to do: the tasks do the work
+}
@@ -0,0 +1,98 @@
+/*
+  Wait for the SiT5811 oven to settle before disciplining.
+
+  After power-up the oven heater runs at full power, then its power falls as the
+  oven reaches its set point. The Power Indicator register is the oven controller's
+  output. SfeSiT5811Warmup reads it once per second, fits its trend, and reports
+  Ready when the power has stopped changing. Disciplining starts then: sooner than
+  a fixed, pessimistic wait for a fast oven, and later (safely) for a slow one.
+
+  begin also checks the Chip ID if you set the one you expect. Print it once with
+  this example, then pass it to setExpectedChipID.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+#include <SparkFun_SiT5811_Warmup.h>
+
+SfeSiT5811ArdI2C myOCXO;
+
+SfeSiT5811Warmup myWarmup;
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  //myOCXO.setExpectedChipID(0x0000); // Uncomment and set your part's Chip ID. begin will fail if it differs
+
+  if (!myOCXO.begin(kSfeSiT5811StartupMinimal)) // Minimal: one read of 0x00-0x0E, Chip ID included
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  Serial.print("Chip ID: 0x");
+  Serial.println(myOCXO.getChipID(), HEX);
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setMaxFrequencyChangePPB(3.0); // Set the maximum frequency change in PPB
+
+  myWarmup.setSlopeThreshold(0.002); // Settled when the power changes by less than 0.2% per minute
+  myWarmup.setHoldTime(60.0); // for one minute
+  myWarmup.setTimeout(1800.0); // Report a timeout after 30 minutes
+
+  myWarmup.begin(&myOCXO);
+}
+
+void loop()
+{
+  static unsigned long lastStep = 0;
+  static double bias = 200.0e-6; // Replace this with the RxClkBias from your GNSS receiver
+
+  sfe_SiT5811_warmup_t state = myWarmup.update(); // Reads the Power Indicator once per second
+
+  if (millis() > (lastStep + 1000))
+  {
+    lastStep = millis();
+
+    if (state == kSfeSiT5811WarmupReady)
+    {
+      myOCXO.setFrequencyByBiasMillis(bias);
+
+      bias *= 0.9; // Pretend the bias is being removed
+
+      Serial.print("Disciplining. Frequency: ");
+      Serial.println(myOCXO.getFrequencyHz(), 3);
+    }
+    else
+    {
+      const char *names[] = {"Stopped", "Heating", "Settling", "Ready", "Timeout", "Fault"};
+      Serial.print(names[state]);
+      Serial.print(": ");
+      Serial.print(myWarmup.getSeconds(), 0);
+      Serial.print("s, oven power ");
+      Serial.print(myWarmup.getPower() * 100.0, 1);
+      Serial.print("%, trend ");
+      Serial.print(myWarmup.getSlopePerMinute() * 100.0, 3);
+      Serial.println("% per minute");
+    }
+  }
+}
@@ -0,0 +1,100 @@
+/*
+  Sweep the SiT5811 OCXO frequency through a profile, for calibration and test.
+
+  SfeSiT5811Trajectory compiles the profile once, in setup: each point is limited
+  to the pull range and to the slew limit, and stored as a five byte control word.
+  loop() only has to call update: when a point is due it is written, with no
+  floating point math, so each point costs the same.
+
+  At the end the example prints how late the writes were: the mean, the jitter
+  (standard deviation) and the worst case. Anything slow in loop() shows up here.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+#include <SparkFun_SiT5811_Trajectory.h>
+
+SfeSiT5811ArdI2C myOCXO;
+
+SfeSiT5811TrajectoryN<400> myTrajectory; // 40 seconds at 10Hz: 2000 bytes
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  Wire.begin(); // Begin the I2C bus
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myTrajectory.begin(&myOCXO); // The profile starts from the current frequency
+  myTrajectory.setUpdateInterval(100000); // 10Hz. Set this before adding segments
+  myTrajectory.setSlewLimit(100.0); // Change by at most 100ppb per second
+
+  myTrajectory.addStep(1000.0, 15.0); // Step to +1ppm (slewing for 10s) and hold for the rest of 15s
+  myTrajectory.addRamp(-1000.0, 20.0); // Ramp down to -1ppm over 20s
+  myTrajectory.addStep(0.0, 5.0); // Back to the base frequency (the step is slew limited too)
+
+  Serial.print("Profile: ");
+  Serial.print(myTrajectory.getLength());
+  Serial.print(" points, ");
+  Serial.print(myTrajectory.getDurationSeconds(), 1);
+  Serial.print("s. Slew limited points: ");
+  Serial.println(myTrajectory.getSlewLimited());
+
+  myTrajectory.start();
+}
+
+void loop()
+{
+  static unsigned long lastPrint = 0;
+
+  if (myTrajectory.update() == kSfeSiT5811TrajectoryDone) // Writes the next point when it is due
+  {
+    Serial.print("Done. Writes: ");
+    Serial.print(myTrajectory.getWrites());
+    Serial.print(", skipped: ");
+    Serial.print(myTrajectory.getSkipped());
+    Serial.print(", lateness: mean ");
+    Serial.print(myTrajectory.getMeanLatenessMicros(), 1);
+    Serial.print("us, jitter ");
+    Serial.print(myTrajectory.getJitterMicros(), 1);
+    Serial.print("us, max ");
+    Serial.print(myTrajectory.getMaxLatenessMicros());
+    Serial.println("us");
+
+    myOCXO.resetDiscipline(); // Before using setFrequencyByBiasMillis again
+
+    while (1); // Do nothing more
+  }
+
+  if (millis() > (lastPrint + 1000))
+  {
+    lastPrint = millis();
+
+    Serial.print("Point ");
+    Serial.print(myTrajectory.getPosition());
+    Serial.print(": frequency ");
+    Serial.println(myOCXO.getFrequencyHz(), 3);
+  }
+}
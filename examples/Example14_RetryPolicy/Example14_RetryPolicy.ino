@@ -0,0 +1,126 @@
+/*
+  Retry bus errors, recover a stuck bus, and bound the time a frequency update takes.
+
+  By default the driver tries each I2C transaction once and returns false if it
+  fails. With a retry policy it tries again, up to a number of attempts, and it
+  calls your bus recovery function after consecutive failures. It only starts an
+  attempt which can finish by the deadline, so - if each attempt is bounded by the
+  Wire timeout - a frequency update never takes longer than the deadline.
+
+  Run this against examples/SiT5811_Emulator and type n, s, c or r there to inject
+  faults. The retries and recoveries are printed here.
+
+  By: Paul Clark
+  SparkFun Electronics
+  Date: 2024/11/21
+  SparkFun code, firmware, and software is released under the MIT License.
+  Please see LICENSE.md for further details.
+
+*/
+
+// You will need the SparkFun Toolkit. Click here to get it: http://librarymanager/All#SparkFun_Toolkit
+
+#include <SparkFun_SiT5811.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
+SfeSiT5811ArdI2C myOCXO;
+
+// The Wire timeout bounds each attempt. AVR and ESP32 cores can set it. On other cores, change this
+// to your core's own timeout - the retry policy assumes no attempt takes longer
+const uint32_t kWireTimeoutMicros = 10000;
+const uint32_t kTransferMicros = 1000; // The bytes of one transaction at 100kHz, with margin
+
+// Begin the I2C bus, with its timeout
+void beginI2C()
+{
+  Wire.begin();
+#if defined(WIRE_HAS_TIMEOUT) // AVR
+  Wire.setWireTimeout(kWireTimeoutMicros, true); // Reset the bus on a timeout
+#elif defined(ARDUINO_ARCH_ESP32)
+  Wire.setTimeOut(kWireTimeoutMicros / 1000); // Milliseconds
+#endif
+}
+
+// Free a bus which a device is holding (SDA stuck low): clock SCL until SDA is released, then send a stop
+bool recoverI2C()
+{
+  Wire.end();
+
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, OUTPUT);
+  for (int i = 0; (i < 9) && (digitalRead(SDA) == LOW); i++)
+  {
+    digitalWrite(SCL, LOW);
+    delayMicroseconds(5);
+    digitalWrite(SCL, HIGH);
+    delayMicroseconds(5);
+  }
+
+  // Stop: SDA goes high while SCL is high
+  pinMode(SDA, OUTPUT);
+  digitalWrite(SDA, LOW);
+  delayMicroseconds(5);
+  digitalWrite(SCL, HIGH);
+  delayMicroseconds(5);
+  pinMode(SDA, INPUT_PULLUP);
+
+  bool busFree = (digitalRead(SDA) == HIGH);
+
+  beginI2C();
+  return busFree;
+}
+
+void setup()
+{
+  delay(1000); // Allow time for the microcontroller to start up
+
+  Serial.begin(115200); // Begin the Serial console
+  while (!Serial)
+  {
+    delay(100); // Wait for the user to open the Serial Monitor
+  }
+  Serial.println("SparkFun SiT5811 Example");
+
+  beginI2C(); // Begin the I2C bus, limiting each transaction to kWireTimeoutMicros
+
+  sfe_SiT5811_retry_t policy;
+  SfeSiT5811Driver::getDefaultRetryPolicy(policy);
+  policy.attempts = 5; // Try each transaction up to five times
+  policy.deadlineMicros = 50000; // Give up on an update after 50ms
+  policy.attemptMicros = kWireTimeoutMicros + kTransferMicros; // The Wire timeout, plus the bytes
+  policy.recoverAfter = 2; // Call recoverI2C after every two failures in a row
+  myOCXO.setRetryPolicy(policy); // Before begin, so begin retries too
+  myOCXO.setBusRecovery(recoverI2C);
+
+  if (!myOCXO.begin())
+  {
+    Serial.println("SiT5811 not detected! Please check the address and try again...");
+    while (1); // Do nothing more
+  }
+
+  myOCXO.setBaseFrequencyHz(10000000.0); // Pass the oscillator base frequency into the driver
+
+  myOCXO.setMaxFrequencyChangePPB(3.0); // Set the maximum frequency change in PPB
+}
+
+void loop()
+{
+  static double bias = 200.0e-6; // Replace this with the RxClkBias from your GNSS receiver
+
+  unsigned long start = micros();
+  bool ok = myOCXO.setFrequencyByBiasMillis(bias);
+  unsigned long elapsed = micros() - start;
+
+  bias *= 0.9; // Pretend the bias is being removed
+
+  Serial.print(ok ? "Updated" : "Update FAILED");
+  Serial.print(" in ");
+  Serial.print(elapsed);
+  Serial.print("us. Retries: ");
+  Serial.print(myOCXO.getRetries());
+  Serial.print(", bus recoveries: ");
+  Serial.print(myOCXO.getBusRecoveries());
+  Serial.print(", deadline aborts: ");
+  Serial.println(myOCXO.getDeadlineAborts());
+
+  delay(1000);
+}
@@ -1,6 +1,17 @@
 /*
   Emulate the SiT5811 OCXO.
 
+  The registers are held by SfeSiT5811Emulator - the same model the host tests use
+  (extras/host/SiT5811_Faults.cpp) - so this emulator can also inject bus faults.
+  Type a command in the Serial Monitor:
+    n : NACK the next transaction (the write is ignored, or nothing is sent)
+    s : Short: the next transaction transfers half the bytes
+    c : Clock stretch the next transaction (up to 2ms)
+    k : Stuck: ignore everything until u
+    u : Unstick: recover the bus. This is the only way to clear Stuck: the controller's bus
+        recovery (e.g. Example14_RetryPolicy) clocks SCL, which a Wire target never sees
+    r : Random faults on (5% of transactions) or off
+
   By: Paul Clark
   SparkFun Electronics
   Date: 2024/11/21
@@ -12,56 +23,63 @@
         SfeSiT5811Driver::begin() calls readClipRegister() and readRegisters()
         twice, to ensure registerAddress points at 0x00 and 0x0C correctly.
 
+  Note: A Wire target cannot refuse its address, so NACK and Stuck are emulated by
+        ignoring the write or sending nothing. Clock stretching depends on the core
+        holding SCL low while the callback runs.
+
+  Note: The Wire callbacks run in interrupt context on most cores. loop() disables
+        interrupts while it uses the emulator, so a callback never sees it half-updated.
+
 */
 
 #include <Wire.h>
 
+#include <SparkFun_SiT5811_Emulator.h> // Click here to get the library: http://librarymanager/All#SparkFun_SiT5811
+
 #define I2C_DEV_ADDR 0x50
 
 // Emulate registers 0x00 (DCXO Clip) to 0x0E (DCXO LSW) (16-bit, MSB first)
-#define CLIP 0x00 // Change to (e.g.) 0x08 to emulate 200ppm clip range. 
-#define NUM_REG_BYTES (15*2)
-volatile uint8_t registerBytes[NUM_REG_BYTES];
-volatile uint8_t registerAddress = 0;
+#define CLIP 0x00 // Change to (e.g.) 0x08 to emulate 200ppm clip range.
+
+SfeSiT5811Emulator emulator;
+
+// Clock stretching: the emulator waits in the Wire callback
+void stretchClock(uint32_t micros)
+{
+  delayMicroseconds(micros);
+}
 
 // On Request:
-// Write bytes from registerBytes, starting at registerAddress * 2
+// Write bytes from the registers, starting at the register address
 void requestHandler()
 {
-  int i = registerAddress * 2;
-  for (; i < NUM_REG_BYTES; i++)
-    Wire.write(registerBytes[i]);
+  uint8_t theBytes[kSfeSiT5811EmulatorNumRegs * 2];
+  size_t numBytes = emulator.request(theBytes, sizeof(theBytes));
+  if (numBytes > 0)
+    Wire.write(theBytes, numBytes);
 }
 
 // On Receive:
-// Copy the first incoming byte into registerAddress (see notes above)
-// Copy the remaining bytes into registerBytes, starting at registerAddress * 2
+// The first incoming byte is the register address (see notes above)
+// The remaining bytes are written to the registers, starting at the register address
 void receiveHandler(int len)
 {
-  int count = -1;
+  uint8_t theBytes[(kSfeSiT5811EmulatorNumRegs * 2) + 1];
+  size_t numBytes = 0;
   while (Wire.available())
   {
     uint8_t b = Wire.read();
-    switch (count)
-    {
-      case -1:
-        registerAddress = b;
-        break;
-      default:
-        if (((registerAddress * 2) + count) < NUM_REG_BYTES)
-          registerBytes[((registerAddress * 2) + count)] = b;
-        break;
-    }
-    count++;
+    if (numBytes < sizeof(theBytes))
+      theBytes[numBytes++] = b;
   }
+  emulator.receive(theBytes, numBytes);
 }
 
 void setup()
 {
-  // Initialize the register bytes
-  for (int i = 0; i < NUM_REG_BYTES; i++)
-    registerBytes[i] = 0;
-  registerBytes[0] = CLIP; // Store in OCXO Clip MSB
+  // Initialize the registers
+  emulator.setRegister(0x00, ((uint16_t)CLIP) << 8); // Store in OCXO Clip MSB
+  emulator.setDelay(stretchClock);
 
   delay(1000); // Allow time for the microcontroller to start up
 
@@ -80,28 +98,60 @@ void setup()
 void loop()
 {
   static unsigned long lastPrint = 0;
+  static bool randomFaults = false;
+
+  if (Serial.available())
+  {
+    char c = Serial.read();
+    noInterrupts(); // The Wire callbacks use the emulator too
+    if (c == 'n')
+      emulator.injectFault(kSfeSiT5811FaultNack);
+    else if (c == 's')
+      emulator.injectFault(kSfeSiT5811FaultShort);
+    else if (c == 'c')
+      emulator.injectFault(kSfeSiT5811FaultStretch);
+    else if (c == 'k')
+      emulator.injectFault(kSfeSiT5811FaultStuck);
+    else if (c == 'u')
+      emulator.recoverBus();
+    else if (c == 'r')
+    {
+      randomFaults = !randomFaults;
+      emulator.setFaultProbability(kSfeSiT5811FaultNack, randomFaults ? 0.02 : 0.0);
+      emulator.setFaultProbability(kSfeSiT5811FaultShort, randomFaults ? 0.01 : 0.0);
+      emulator.setFaultProbability(kSfeSiT5811FaultStretch, randomFaults ? 0.02 : 0.0);
+    }
+    interrupts();
+
+    if (c == 'r')
+      Serial.println(randomFaults ? "Random faults on" : "Random faults off");
+  }
 
   if (millis() > (lastPrint + 1000))
   {
     lastPrint = millis();
 
-    // Extract the 39-bit Frequency Control Word
-    uint64_t freqControl = ((uint64_t)registerBytes[28]) >> 1;
-    freqControl |= ((uint64_t)registerBytes[27]) << 7;
-    freqControl |= ((uint64_t)registerBytes[26]) << 15;
-    freqControl |= ((uint64_t)registerBytes[25]) << 23;
-    freqControl |= ((uint64_t)registerBytes[24]) << 31;
-    if (freqControl & 0x0000004000000000) // Correct two's complement
-      freqControl |= 0xFFFFFFC000000000;
-    
-    union // Avoid any ambiguity when converting uint64_t to int64_t
-    {
-        uint64_t unsigned64;
-        int64_t signed64;
-    } unsignedSigned64;
-    unsignedSigned64.unsigned64 = freqControl;
+    // Copy everything with interrupts disabled, then print
+    noInterrupts();
+    int64_t freqControl = emulator.getFrequencyControlWord();
+    uint32_t transactions = emulator.getTransactions();
+    uint32_t nacks = emulator.getFaults(kSfeSiT5811FaultNack);
+    uint32_t shorts = emulator.getFaults(kSfeSiT5811FaultShort);
+    uint32_t stretches = emulator.getFaults(kSfeSiT5811FaultStretch);
+    bool stuck = emulator.isStuck();
+    interrupts();
 
     Serial.print("Frequency control is ");
-    Serial.println(unsignedSigned64.signed64);
+    Serial.print(freqControl);
+    Serial.print(". Transactions: ");
+    Serial.print(transactions);
+    Serial.print(", NACK: ");
+    Serial.print(nacks);
+    Serial.print(", short: ");
+    Serial.print(shorts);
+    Serial.print(", stretched: ");
+    Serial.print(stretches);
+    Serial.print(stuck ? ", STUCK" : "");
+    Serial.println();
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,138 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host relay auto-tune
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_AutoTune.cpp
+
+    Description:
+    Runs SfeSiT5811AutoTune against the simulated SiT5811 (SfeSiT5811Simulation), the host
+    mock plant: the loop locks with the default gains, then the relay measures the ultimate
+    gain and period and proposes Pk and Ik with each rule.
+
+    Each set of gains (the defaults, Ziegler-Nichols and Tyreus-Luyben) is then tested from
+    the same cold start (5 ppb offset, 1us time error, 3 ppb slew limit). For each this
+    reports the time to lock (|time error| stays below 20ns) and the RMS time error over the
+    rest of the day.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_AutoTune.cpp -o SiT5811_AutoTune
+    ./SiT5811_AutoTune
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_AutoTune.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+
+static const double kLockThresholdSeconds = 20.0e-9; // Locked when |time error| < 20ns
+static const uint32_t kLockEpochs = 900; // Lock with the default gains before tuning
+static const uint32_t kRunEpochs = 86400; // One day for each set of gains
+
+// Test one set of gains from a cold start
+static void test(const char *name, double Pk, double Ik)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 2); // The same noise for every set, different from the tuning run
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+
+    uint32_t lockEpoch = 0;
+    double sumTimeError2 = 0.0;
+    uint32_t count = 0;
+
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kRunEpochs; e++)
+    {
+        ocxo.setFrequencyByBiasMillis(bias, Pk, Ik);
+        bias = simulation.step();
+
+        double timeError = simulation.getTimeErrorSeconds();
+        if (fabs(timeError) >= kLockThresholdSeconds)
+            lockEpoch = e + 1;
+        if (e >= 3600)
+        {
+            sumTimeError2 += timeError * timeError;
+            count++;
+        }
+    }
+
+    printf("%-16s %8.4f %8.4f %10lu %12.2f\n", name, Pk, Ik, (unsigned long)lockEpoch,
+           sqrt(sumTimeError2 / count) * 1.0e9);
+}
+
+int main(void)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1);
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+
+    // Lock with the default gains
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kLockEpochs; e++)
+    {
+        ocxo.setFrequencyByBiasMillis(bias);
+        bias = simulation.step();
+    }
+
+    // Tune
+    SfeSiT5811AutoTune tuner;
+    tuner.begin(&ocxo);
+    double peak = 0.0;
+    while (!tuner.isFinished())
+    {
+        tuner.update(bias);
+        bias = simulation.step();
+        if (fabs(simulation.getTimeErrorSeconds()) > peak)
+            peak = fabs(simulation.getTimeErrorSeconds());
+    }
+
+    printf("SparkFun SiT5811 relay auto-tune (relay +/-1.5 ppb, 10ns hysteresis)\n\n");
+    printf("State: %s after %lu s. Peak time error during tuning: %.1f ns\n",
+           (tuner.getState() == kSfeSiT5811TuneDone) ? "done" : "FAILED", (unsigned long)tuner.getEpochs(),
+           peak * 1.0e9);
+    printf("Plant gain K: %.3f (ideal 1). Plant delay L: %.2f s (ideal 0.5: one update, sampled)\n",
+           tuner.getPlantGain(), tuner.getPlantDelay());
+    printf("Ultimate gain Ku: %.3f Hz per clock cycle. Ultimate period Tu: %.1f s\n", tuner.getUltimateGain(),
+           tuner.getUltimatePeriod());
+    printf("Center frequency error: %+.3f ppb\n\n",
+           ((tuner.getCenterFrequencyHz() - ocxo.getBaseFrequencyHz()) / ocxo.getBaseFrequencyHz() +
+            simulation.getFreeRunningFrequency()) * 1.0e9);
+
+    double znPk = tuner.getPk();
+    double znIk = tuner.getIk();
+    tuner.setRule(kSfeSiT5811TuneTyreusLuyben);
+    double tlPk = tuner.getPk();
+    double tlIk = tuner.getIk();
+
+    printf("%-16s %8s %8s %10s %12s\n", "gains", "Pk", "Ik", "lock (s)", "RMS TE (ns)");
+    test("default", 0.5, 0.1);
+    test("Ziegler-Nichols", znPk, znIk);
+    test("Tyreus-Luyben", tlPk, tlIk);
+
+    return 0;
+}
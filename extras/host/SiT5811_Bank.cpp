@@ -0,0 +1,223 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host bank benchmark
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Bank.cpp
+
+    Description:
+    Runs SfeSiT5811Bank on a host PC against several in-memory register files
+    (SfeSiT5811RegisterFile) sharing one emulated bus, and reports:
+        The startup transactions and bytes: one SfeSiT5811Driver::begin per
+        device, versus a single bank scan of 0x50 to 0x5F
+        The transactions per update cycle, with and without setMaxWritesPerUpdate,
+        on a blocking bus and on a split-transaction (non-blocking) bus
+    Absent addresses are counted as one transaction of one byte (the NACKed address).
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Bank.cpp -o SiT5811_Bank
+    ./SiT5811_Bank
+
+*/
+
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Bank.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+
+// Several register files on one emulated I2C bus
+class SharedBus : public SfeSiT5811Bus
+{
+public:
+    SharedBus() : _address{0}, _absentTransactions{0}
+    {
+        for (int i = 0; i < 16; i++)
+            _devices[i] = nullptr;
+    }
+
+    void addDevice(uint8_t address, SfeSiT5811RegisterFile *device)
+    {
+        _devices[address - kSfeSiT5811FirstAddr] = device;
+    }
+
+    void resetCounters(void)
+    {
+        _absentTransactions = 0;
+        for (int i = 0; i < 16; i++)
+            if (_devices[i] != nullptr)
+                _devices[i]->resetCounters();
+    }
+
+    uint32_t getTransactions(void)
+    {
+        uint32_t transactions = _absentTransactions;
+        for (int i = 0; i < 16; i++)
+            if (_devices[i] != nullptr)
+                transactions += _devices[i]->getTransactions();
+        return transactions;
+    }
+
+    uint32_t getBytesOnWire(void)
+    {
+        uint32_t bytes = _absentTransactions; // The NACKed address byte
+        for (int i = 0; i < 16; i++)
+            if (_devices[i] != nullptr)
+                bytes += _devices[i]->getBytesOnWire();
+        return bytes;
+    }
+
+    sfe_SiT5811_err_t setAddress(uint8_t address)
+    {
+        _address = address;
+        return kSfeSiT5811ErrOk;
+    }
+
+    sfe_SiT5811_err_t ping(void)
+    {
+        SfeSiT5811RegisterFile *device = selected();
+        return (device == nullptr) ? kSfeSiT5811ErrFail : device->ping();
+    }
+
+    sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes)
+    {
+        SfeSiT5811RegisterFile *device = selected();
+        readBytes = 0;
+        return (device == nullptr) ? kSfeSiT5811ErrFail : device->readRegisterRegion(reg, data, numBytes, readBytes);
+    }
+
+    sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+    {
+        SfeSiT5811RegisterFile *device = selected();
+        return (device == nullptr) ? kSfeSiT5811ErrFail : device->writeRegisterRegion(reg, data, numBytes);
+    }
+
+    sfe_SiT5811_err_t startWriteRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+    {
+        SfeSiT5811RegisterFile *device = selected();
+        _writing = device;
+        return (device == nullptr) ? kSfeSiT5811ErrFail : device->startWriteRegisterRegion(reg, data, numBytes);
+    }
+
+    sfe_SiT5811_err_t pollWrite(void)
+    {
+        return (_writing == nullptr) ? kSfeSiT5811ErrFail : _writing->pollWrite();
+    }
+
+private:
+    SfeSiT5811RegisterFile *selected(void)
+    {
+        SfeSiT5811RegisterFile *device = nullptr;
+        if ((_address >= kSfeSiT5811FirstAddr) && (_address <= kSfeSiT5811LastAddr))
+            device = _devices[_address - kSfeSiT5811FirstAddr];
+        if (device == nullptr)
+            _absentTransactions++;
+        return device;
+    }
+
+    SfeSiT5811RegisterFile *_devices[16];
+    SfeSiT5811RegisterFile *_writing = nullptr;
+    uint8_t _address;
+    uint32_t _absentTransactions;
+};
+
+static const uint8_t kAddresses[] = {0x50, 0x52, 0x58, 0x5A}; // The A0/A1 selectable addresses
+static const uint8_t kNumDevices = sizeof(kAddresses) / sizeof(kAddresses[0]);
+static const uint32_t kCycles = 10000;
+
+// Steer every device each cycle, then update. Report the transactions per cycle and the worst cycle
+static void cycles(const char *name, SfeSiT5811Bank &bank, SharedBus &bus, uint8_t maxWrites, uint8_t writePolls,
+                   SfeSiT5811RegisterFile *files)
+{
+    for (uint8_t i = 0; i < kNumDevices; i++)
+        files[i].setWritePolls(writePolls);
+    bank.setMaxWritesPerUpdate(maxWrites);
+
+    uint32_t worst = 0;
+    uint32_t coalescedBefore = 0;
+    for (uint8_t i = 0; i < bank.getCount(); i++)
+        coalescedBefore += bank.getDevice(i)->getAsyncCoalesced();
+
+    bus.resetCounters();
+    for (uint32_t c = 0; c < kCycles; c++)
+    {
+        for (uint8_t i = 0; i < bank.getCount(); i++)
+            bank.getDevice(i)->setFrequencyControlWord(1000000 + (int64_t)((c + i) & 0xFF));
+
+        uint32_t before = bus.getTransactions();
+        bank.update();
+        uint32_t transactions = bus.getTransactions() - before;
+        if (transactions > worst)
+            worst = transactions;
+    }
+
+    uint32_t coalesced = 0;
+    for (uint8_t i = 0; i < bank.getCount(); i++)
+        coalesced += bank.getDevice(i)->getAsyncCoalesced();
+
+    printf("%-34s %8.2f %8lu %8.2f %10lu\n", name, (double)bus.getTransactions() / kCycles, (unsigned long)worst,
+           (double)bus.getBytesOnWire() / kCycles, (unsigned long)(coalesced - coalescedBefore));
+}
+
+int main(void)
+{
+    SfeSiT5811RegisterFile files[kNumDevices];
+    SharedBus bus;
+    for (uint8_t i = 0; i < kNumDevices; i++)
+    {
+        files[i].setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+        bus.addDevice(kAddresses[i], &files[i]);
+    }
+
+    printf("SparkFun SiT5811 bank benchmark (%u devices at 0x50, 0x52, 0x58, 0x5A)\n\n", (unsigned)kNumDevices);
+
+    // Startup: one driver per device, each with its own begin
+    printf("%-34s %8s %8s\n", "Startup", "xfers", "bytes");
+    {
+        SfeSiT5811AddressedBus addressed[kNumDevices];
+        SfeSiT5811Driver drivers[kNumDevices];
+        bus.resetCounters();
+        for (uint8_t i = 0; i < kNumDevices; i++)
+        {
+            addressed[i].attach(&bus, kAddresses[i]);
+            drivers[i].begin(&addressed[i]);
+        }
+        printf("%-34s %8lu %8lu\n", "SfeSiT5811Driver::begin x 4", (unsigned long)bus.getTransactions(),
+               (unsigned long)bus.getBytesOnWire());
+    }
+
+    SfeSiT5811BankN<8> bank;
+    bus.resetCounters();
+    uint8_t found = bank.begin(&bus);
+    printf("%-34s %8lu %8lu\n", "SfeSiT5811Bank::begin (16 addr)", (unsigned long)bus.getTransactions(),
+           (unsigned long)bus.getBytesOnWire());
+    printf("  (found %u:", (unsigned)found);
+    for (uint8_t i = 0; i < found; i++)
+        printf(" 0x%02X", bank.getAddress(i));
+    printf(")\n\n");
+
+    printf("%-34s %8s %8s %8s %10s\n", "Update cycle (all devices steered)", "xfers", "worst", "bytes", "coalesced");
+    cycles("blocking, no limit", bank, bus, 0, 0, files);
+    cycles("blocking, max 2 writes", bank, bus, 2, 0, files);
+    cycles("split (2 polls), no limit", bank, bus, 0, 2, files);
+
+    // Check the devices hold the staged words once the bank is idle
+    for (uint8_t i = 0; i < kNumDevices; i++)
+        files[i].setWritePolls(0);
+    bank.setMaxWritesPerUpdate(0);
+    while (bank.update() == kSfeSiT5811ErrBusy)
+        ;
+    uint8_t mismatches = 0;
+    for (uint8_t i = 0; i < found; i++)
+        if (files[i].getFrequencyControlWord() != bank.getDevice(i)->getFrequencyControlWord())
+            mismatches++;
+    printf("\nDevices not holding their latest word after the final update: %u\n", (unsigned)mismatches);
+    printf("Write failures: %lu\n", (unsigned long)bank.getFailures());
+
+    return 0;
+}
@@ -0,0 +1,340 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host benchmark
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Benchmark.cpp
+
+    Description:
+    Runs SfeSiT5811Driver on a host PC against the in-memory register file
+    (SfeSiT5811RegisterFile) and reports, per call:
+        I2C transactions
+        Bytes on the wire
+        CPU time
+    The transaction and byte counts are what the driver puts on a real I2C bus.
+    The CPU time is the driver plus the in-memory register file; it does not
+    include the time the real bus would take. Finally it prints the driver's
+    own instrumentation (SfeSiT5811Instrumentation) for the whole run.
+
+    It doubles as a regression check: the transaction count of each call which has a
+    fixed count, a blocking read during an asynchronous write, and the word -> PPQ -> word
+    round trip, are checked. The exit status is non-zero if any check fails.
+
+    The instrumentation reads the clock twice per transaction. To benchmark
+    without it, add -DSFE_SIT5811_INSTRUMENTATION=0 to the build line.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Benchmark.cpp -o SiT5811_Benchmark
+    ./SiT5811_Benchmark
+
+*/
+
+#include <chrono>
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Emulator.h"
+#include "SparkFun_SiT5811_Fixed.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Stability.h"
+
+static const uint32_t kIterations = 200000;
+
+static SfeSiT5811RegisterFile theRegisters;
+static SfeSiT5811Driver theOCXO;
+static SfeSiT5811Fixed<SfeSiT5811Driver, 10000000, 0x0020> theFixedOCXO; // 10MHz, 3.125ppm
+static SfeSiT5811StabilityN<8> theStability; // 8 octaves: 1s to 128s
+
+static const uint32_t kAnyTransactions = 0xFFFFFFFF; // Do not check the transaction count
+
+static uint32_t checkFailures = 0; // Failed checks. Any failure makes the exit status non-zero
+
+// Print one line of the results table
+static void report(const char *name, uint32_t iterations, double elapsedNs)
+{
+    printf("%-34s %8.2f %8.2f %10.1f\n", name,
+           (double)theRegisters.getTransactions() / iterations,
+           (double)theRegisters.getBytesOnWire() / iterations,
+           elapsedNs / iterations);
+}
+
+// Time iterations calls of theCall. theCall is passed the iteration number
+// expected is the number of transactions each call must take, or kAnyTransactions
+template <typename T> static void benchmark(const char *name, uint32_t iterations, uint32_t expected, T theCall)
+{
+    theRegisters.resetCounters();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+        theCall(i);
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+    report(name, iterations, (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+
+    if ((expected != kAnyTransactions) && (theRegisters.getTransactions() != (expected * iterations)))
+    {
+        printf("  FAIL: expected %lu transactions per call\n", (unsigned long)expected);
+        checkFailures++;
+    }
+}
+
+// Compare the integer (PPQ) path against the double path, across the full 39-bit range
+static void accuracy(void)
+{
+    SfeSiT5811RegisterFile registers; // Full 800ppm pull range
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+
+    const int64_t words[] = {kSfeSiT5811ControlWordMin, kSfeSiT5811ControlWordMin + 1, -343597383, -1030792, -1, 0, 1,
+                             1030792, 343597383, kSfeSiT5811ControlWordMax - 1, kSfeSiT5811ControlWordMax};
+
+    uint32_t tested = 0;
+    uint32_t roundTripErrors = 0;
+    double maxPpqDifference = 0.0;
+    uint64_t lfsr = 0x123456789ABCDEF1; // xorshift64 - repeatable pseudo-random words
+
+    for (uint32_t i = 0; i < 1000000 + (sizeof(words) / sizeof(words[0])); i++)
+    {
+        int64_t word;
+        if (i < (sizeof(words) / sizeof(words[0])))
+            word = words[i];
+        else
+        {
+            lfsr ^= lfsr << 13;
+            lfsr ^= lfsr >> 7;
+            lfsr ^= lfsr << 17;
+            word = (int64_t)(lfsr & 0x7FFFFFFFFF) + kSfeSiT5811ControlWordMin; // 39 bits
+        }
+
+        ocxo.setFrequencyControlWord(word);
+        int64_t ppq = ocxo.getFrequencyOffsetPPQ();
+
+        // Round trip: word -> PPQ -> word
+        ocxo.setFrequencyOffsetPPQ(ppq);
+        if (ocxo.getFrequencyControlWord() != word)
+            roundTripErrors++;
+
+        // Difference from the double path, in PPQ
+        double doublePpq = ((ocxo.getFrequencyHz() - ocxo.getBaseFrequencyHz()) / ocxo.getBaseFrequencyHz()) * 1.0e15;
+        double difference = doublePpq - (double)ppq;
+        if (difference < 0.0)
+            difference = 0.0 - difference;
+        if (difference > maxPpqDifference)
+            maxPpqDifference = difference;
+
+        tested++;
+    }
+
+    printf("\nInteger path accuracy (%lu control words, 1 LSB = 2.91 PPQ)\n", (unsigned long)tested);
+    printf("Round trip word -> PPQ -> word errors: %lu\n", (unsigned long)roundTripErrors);
+    printf("Max |double path - integer path|: %.2f PPQ\n", maxPpqDifference);
+
+    if (roundTripErrors > 0)
+    {
+        printf("FAIL: round trip errors\n");
+        checkFailures++;
+    }
+}
+
+// The fixed driver counts the frequencies it limits to the pull range, as the runtime driver does
+static void fixedClamps(void)
+{
+    SfeSiT5811Instrumentation &instr = theFixedOCXO.getInstrumentation();
+    uint32_t before = instr.getPullClamps();
+    theFixedOCXO.setFrequencyHz(10000000.0 + 100.0); // +10ppm: beyond the 3.125ppm limit
+    theFixedOCXO.setFrequencyHz(10000000.0 - 100.0);
+    theFixedOCXO.setFrequencyHz(10000000.0 + 1.0); // +0.1ppm: inside it
+    uint32_t clamps = instr.getPullClamps() - before;
+    uint32_t expected = SFE_SIT5811_INSTRUMENTATION ? 2 : 0;
+
+    printf("\nFixed<10MHz, 32> pull range clamps: %lu of 3\n", (unsigned long)clamps);
+    if (clamps != expected)
+    {
+        printf("FAIL: expected %lu pull range clamps\n", (unsigned long)expected);
+        checkFailures++;
+    }
+}
+
+// A blocking read while an asynchronous write is on the bus: the read must wait for the write,
+// and must not be overtaken by its completion. Call in asynchronous mode, with write polls set
+static void asyncRead(void)
+{
+    theOCXO.setFrequencyControlWord(3000000);
+    theOCXO.poll(); // Start the write. It is on the bus until the fourth poll
+    bool inFlight = theOCXO.isAsyncWriting();
+    bool readOk = theOCXO.readRegisters();
+
+    printf("\nRead during an asynchronous write: %s, driver word %lld, device word %lld\n", readOk ? "ok" : "FAILED",
+           (long long)theOCXO.getFrequencyControlWord(), (long long)theRegisters.getFrequencyControlWord());
+
+    if (!inFlight || !readOk || theOCXO.isAsyncWriting() || (theOCXO.getFrequencyControlWord() != 3000000) ||
+        (theRegisters.getFrequencyControlWord() != 3000000))
+    {
+        printf("FAIL: the read did not wait for the write\n");
+        checkFailures++;
+    }
+}
+
+// An asynchronous write fails while a newer word is pending. Disabling asynchronous mode must discard
+// the pending word: it must not be written by a later poll(), after a synchronous write has replaced it
+static void asyncFailure(void)
+{
+    SfeSiT5811Emulator emulator;
+    SfeSiT5811Driver ocxo;
+
+    ocxo.begin(&emulator);
+    emulator.setWritePolls(2);
+    ocxo.setAsyncMode(true);
+    ocxo.setFrequencyControlWord(1000);
+    ocxo.poll(); // Start writing 1000. It is on the bus until the second poll
+    ocxo.setFrequencyControlWord(2000); // Pending
+    emulator.injectFault(kSfeSiT5811FaultNack); // The write of 1000 fails
+    bool disabled = ocxo.setAsyncMode(false);
+    bool busy = ocxo.isAsyncBusy();
+
+    emulator.setWritePolls(0);
+    ocxo.setFrequencyControlWord(3000);
+    int64_t pending = ocxo.getPendingFrequencyControlWord();
+    ocxo.poll();
+
+    printf("\nAsynchronous write failure with a word pending: setAsyncMode(false) %s, busy %s, pending word %lld, device word %lld\n",
+           disabled ? "true" : "false", busy ? "yes" : "no", (long long)pending, (long long)emulator.getFrequencyControlWord());
+
+    if (disabled || busy || (pending != 3000) || (emulator.getFrequencyControlWord() != 3000))
+    {
+        printf("FAIL: the stale pending word survived setAsyncMode(false)\n");
+        checkFailures++;
+    }
+}
+
+// Print the driver's bus instrumentation for everything above
+static void instrumentation(void)
+{
+    const char *names[kSfeSiT5811OpCount] = {"ping", "read", "write", "async write"};
+    SfeSiT5811Instrumentation &instr = theOCXO.getInstrumentation();
+
+    printf("\nDriver instrumentation (SFE_SIT5811_INSTRUMENTATION=%d)\n", SFE_SIT5811_INSTRUMENTATION);
+    printf("%-12s %10s %10s %8s %8s %8s  %s\n", "Operation", "xfers", "bytes", "fail", "short", "max us", "latency histogram (us: count)");
+    for (uint8_t op = 0; op < kSfeSiT5811OpCount; op++)
+    {
+        sfe_SiT5811_op_t theOp = (sfe_SiT5811_op_t)op;
+        printf("%-12s %10lu %10lu %8lu %8lu %8lu ", names[op], (unsigned long)instr.getTransactions(theOp),
+               (unsigned long)instr.getBytes(theOp), (unsigned long)instr.getFailures(theOp),
+               (unsigned long)instr.getShortReads(theOp), (unsigned long)instr.getMaxMicros(theOp));
+        for (uint8_t b = 0; b < kSfeSiT5811LatencyBuckets; b++)
+            if (instr.getHistogram(theOp, b) > 0)
+                printf(" %s%lu: %lu", (b == kSfeSiT5811LatencyBuckets - 1) ? ">=" : "",
+                       (unsigned long)SfeSiT5811Instrumentation::getBucketMicros(b), (unsigned long)instr.getHistogram(theOp, b));
+        printf("\n");
+    }
+    printf("Pull range clamps: %lu  Control word clamps: %lu  Discipline slew / pull limited: %lu / %lu\n",
+           (unsigned long)instr.getPullClamps(), (unsigned long)instr.getWordClamps(),
+           (unsigned long)theOCXO.getDiscipline().getSlewLimited(), (unsigned long)theOCXO.getDiscipline().getPullLimited());
+}
+
+int main(void)
+{
+    theRegisters.setRegister(kSfeSiT5811RegClip, 0x0020); // Emulate a 3.125ppm pull range limit (32 / 8192 * 800ppm)
+
+    printf("SparkFun SiT5811 host benchmark (%lu iterations per call)\n\n", (unsigned long)kIterations);
+    printf("%-34s %8s %8s %10s\n", "Call", "xfers", "bytes", "ns/call");
+
+    // Startup modes
+    benchmark("begin() emulator (default)", kIterations, 5, [](uint32_t) { theOCXO.begin(&theRegisters); });
+    benchmark("begin() minimal", kIterations,
+              2, [](uint32_t) { theOCXO.begin(&theRegisters, kSfeSiT5811StartupMinimal); });
+    benchmark("begin() verified", kIterations,
+              3, [](uint32_t) { theOCXO.begin(&theRegisters, kSfeSiT5811StartupVerified); });
+    benchmark("begin() seeded", kIterations, 0, [](uint32_t) {
+        theOCXO.seedRegisters(0x0020, 0);
+        theOCXO.begin(&theRegisters, kSfeSiT5811StartupSeeded);
+    });
+
+    benchmark("readRegisters()", kIterations, 1, [](uint32_t) { theOCXO.readRegisters(); });
+
+    benchmark("setFrequencyControlWord()", kIterations,
+              1, [](uint32_t i) { theOCXO.setFrequencyControlWord((int64_t)(i & 0xFFFF) - 0x8000); });
+
+    // Write elision: a small steering step only changes the LSW. An unchanged word is not written at all
+    theOCXO.setFrequencyControlWord(1000000);
+    benchmark("setFrequencyControlWord() step", kIterations,
+              1, [](uint32_t i) { theOCXO.setFrequencyControlWord(1000001 + (i & 0x3)); });
+    theOCXO.setFrequencyControlWord(1000000);
+    benchmark("setFrequencyControlWord() no-op", kIterations,
+              0, [](uint32_t) { theOCXO.setFrequencyControlWord(1000000); });
+    theOCXO.setFullWrites(true);
+    benchmark("setFullWrites(true) step", kIterations,
+              1, [](uint32_t i) { theOCXO.setFrequencyControlWord(1000000 + (i & 0x3)); });
+    theOCXO.setFullWrites(false);
+
+    benchmark("setFrequencyHz()", kIterations,
+              kAnyTransactions, [](uint32_t i) { theOCXO.setFrequencyHz(10000000.0 + ((double)(i & 0xFF) * 1.0e-3)); });
+
+    benchmark("getFrequencyHz()", kIterations, 0, [](uint32_t) {
+        volatile double freq = theOCXO.getFrequencyHz();
+        (void)freq;
+    });
+
+    benchmark("setFrequencyOffsetPPQ()", kIterations,
+              kAnyTransactions, [](uint32_t i) { theOCXO.setFrequencyOffsetPPQ((int64_t)(i & 0xFF) * 10000000); });
+
+    benchmark("getFrequencyOffsetPPQ()", kIterations, 0, [](uint32_t) {
+        volatile int64_t ppq = theOCXO.getFrequencyOffsetPPQ();
+        (void)ppq;
+    });
+
+    theFixedOCXO.begin(&theRegisters);
+
+    benchmark("Fixed<10MHz, 32>::setFrequencyHz()", kIterations,
+              kAnyTransactions, [](uint32_t i) { theFixedOCXO.setFrequencyHz(10000000.0 + ((double)(i & 0xFF) * 1.0e-3)); });
+
+    benchmark("Fixed<10MHz, 32>::getFrequencyHz()", kIterations, 0, [](uint32_t) {
+        volatile double freq = theFixedOCXO.getFrequencyHz();
+        (void)freq;
+    });
+
+    // Asynchronous mode, on a bus which takes 4 polls to complete each write. With one word set per poll,
+    // one write starts every five calls and four in five words are coalesced.
+    // The enqueue and each poll cost nanoseconds, not a transaction
+    theRegisters.setWritePolls(4);
+    theOCXO.setAsyncMode(true);
+    benchmark("async setFrequencyControlWord()", kIterations,
+              0, [](uint32_t i) { theOCXO.setFrequencyControlWord(2000000 + (i & 0xFF)); });
+    theOCXO.setAsyncMode(false);
+    theOCXO.setAsyncMode(true);
+    benchmark("async set + poll()", kIterations, kAnyTransactions, [](uint32_t i) {
+        theOCXO.setFrequencyControlWord(2000000 + (i & 0xFF));
+        theOCXO.poll();
+    });
+    printf("  (coalesced %lu of %lu words)\n", (unsigned long)theOCXO.getAsyncCoalesced(), (unsigned long)kIterations);
+    asyncRead();
+    theOCXO.setAsyncMode(false);
+    theRegisters.setWritePolls(0);
+    asyncFailure();
+    fixedClamps();
+
+    theOCXO.setFrequencyHz(10000000.0);
+    theOCXO.setMaxFrequencyChangePPB(3.0);
+    benchmark("setFrequencyByBiasMillis()", kIterations,
+              kAnyTransactions, [](uint32_t i) { theOCXO.setFrequencyByBiasMillis((i & 1) ? 200.0e-6 : -200.0e-6); });
+
+    benchmark("Stability<8>::addBiasMillis()", kIterations,
+              0, [](uint32_t i) { theStability.addBiasMillis((double)(i % 7) * 1.0e-6); });
+
+    instrumentation();
+
+    accuracy();
+
+    if (checkFailures > 0)
+    {
+        printf("\n%lu check(s) FAILED\n", (unsigned long)checkFailures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host bus fault test
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Faults.cpp
+
+    Description:
+    Runs SfeSiT5811Driver against SfeSiT5811Emulator, which injects I2C faults (NACK,
+    short transfers, clock stretching, a stuck bus) and models the time each transaction
+    takes at 400kHz with a 10ms bus timeout. The time is simulated: the emulator advances
+    it, and the driver's retry clock (setRetryClock) reads it, so the deadline is exact and
+    the run is repeatable.
+
+    The retry policy: up to 8 attempts, a 50ms deadline, 11ms per attempt (the bus timeout
+    plus the longest transfer), and a bus recovery after every 2 consecutive failures.
+
+    Part 1 sets 20000 control words (each one changes, so each one writes) per fault pattern.
+    Part 2 reads all the registers 20000 times per pattern. For each it reports:
+        The operations which failed, the retries, the bus recoveries and the deadline aborts
+        The mean and maximum time per operation
+        Wrong: operations which reported success with the wrong word (must be zero)
+        Whether every operation finished within the deadline
+    The last pattern of each part is repeated without the retry policy, for comparison.
+    The exit status is non-zero if any operation returned the wrong word, or any operation
+    with the retry policy missed the deadline.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Faults.cpp -o SiT5811_Faults
+    ./SiT5811_Faults
+
+    The deadline does not depend on the instrumentation. To check, build without it:
+    g++ -O2 -std=c++11 -DSFE_SIT5811_INSTRUMENTATION=0 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Faults.cpp -o SiT5811_Faults
+
+*/
+
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Emulator.h"
+
+static const uint32_t kOperations = 20000;
+static const uint32_t kTimeoutMicros = 10000; // The bus timeout
+static const uint32_t kDeadlineMicros = 50000;
+
+// The simulated time: the emulator advances it, the driver's retry clock reads it
+static uint32_t simulatedMicros = 0;
+
+static void advance(uint32_t micros)
+{
+    simulatedMicros += micros;
+}
+
+static uint32_t simulatedClock(void)
+{
+    return simulatedMicros;
+}
+
+// A fault pattern: random faults, plus a burst every period operations
+typedef struct
+{
+    const char *name;
+    double nack;
+    double shortTransfer;
+    double stretch;
+    double stuck;
+    uint32_t stretchMicros;
+    sfe_SiT5811_fault_t burstFault;
+    uint8_t burstCount;
+    uint32_t burstPeriod;
+} pattern_t;
+
+static const pattern_t kPatterns[] = {
+    {"no faults", 0.0, 0.0, 0.0, 0.0, 2000, kSfeSiT5811FaultNone, 0, 0},
+    {"1 NACK every 10", 0.0, 0.0, 0.0, 0.0, 2000, kSfeSiT5811FaultNack, 1, 10},
+    {"3 NACKs every 50", 0.0, 0.0, 0.0, 0.0, 2000, kSfeSiT5811FaultNack, 3, 50},
+    {"8 NACKs every 500", 0.0, 0.0, 0.0, 0.0, 2000, kSfeSiT5811FaultNack, 8, 500},
+    {"1 short every 10", 0.0, 0.0, 0.0, 0.0, 2000, kSfeSiT5811FaultShort, 1, 10},
+    {"stretch <2ms 20%", 0.0, 0.0, 0.2, 0.0, 2000, kSfeSiT5811FaultNone, 0, 0},
+    {"stretch <20ms 10%", 0.0, 0.0, 0.1, 0.0, 20000, kSfeSiT5811FaultNone, 0, 0},
+    {"stuck every 100", 0.0, 0.0, 0.0, 0.0, 2000, kSfeSiT5811FaultStuck, 1, 100},
+    {"mix 5%", 0.02, 0.01, 0.015, 0.005, 20000, kSfeSiT5811FaultNone, 0, 0},
+    {"mix 30%", 0.1, 0.05, 0.1, 0.05, 20000, kSfeSiT5811FaultNone, 0, 0},
+};
+static const unsigned kNumPatterns = sizeof(kPatterns) / sizeof(kPatterns[0]);
+
+static bool allWithinDeadline = true;
+static uint32_t totalWrong = 0;
+
+// Run one pattern. write: set control words, else read all the registers
+static void run(const pattern_t &pattern, bool write, bool retries)
+{
+    SfeSiT5811Emulator emulator;
+    emulator.setDelay(advance);
+    emulator.setTimeoutMicros(kTimeoutMicros);
+
+    SfeSiT5811Driver ocxo;
+    ocxo.setRetryClock(simulatedClock);
+    ocxo.begin(&emulator, kSfeSiT5811StartupMinimal);
+
+    sfe_SiT5811_retry_t policy;
+    SfeSiT5811Driver::getDefaultRetryPolicy(policy);
+    if (retries)
+    {
+        policy.attempts = 8;
+        policy.deadlineMicros = kDeadlineMicros;
+        policy.attemptMicros = 11000; // The timeout, plus 30 bytes at 23us, rounded up
+        policy.recoverAfter = 2;
+    }
+    ocxo.setRetryPolicy(policy);
+
+    emulator.setStretchMicros(pattern.stretchMicros);
+    emulator.setFaultProbability(kSfeSiT5811FaultNack, pattern.nack);
+    emulator.setFaultProbability(kSfeSiT5811FaultShort, pattern.shortTransfer);
+    emulator.setFaultProbability(kSfeSiT5811FaultStretch, pattern.stretch);
+    emulator.setFaultProbability(kSfeSiT5811FaultStuck, pattern.stuck);
+
+    uint32_t failed = 0;
+    uint32_t wrong = 0;
+    uint32_t longest = 0;
+    double total = 0.0;
+    uint32_t word = 0x12345;
+
+    for (uint32_t i = 0; i < kOperations; i++)
+    {
+        if (emulator.isStuck() && !retries)
+            emulator.recoverBus(); // Without a policy, recovery is up to the caller. Do it between operations
+
+        if ((pattern.burstPeriod > 0) && ((i % pattern.burstPeriod) == 0))
+            emulator.injectFault(pattern.burstFault, pattern.burstCount);
+
+        uint32_t start = simulatedMicros;
+        bool ok;
+        int64_t expected;
+        if (write)
+        {
+            word = (word * 1103515245) + 12345; // A different word each time
+            expected = ((int64_t)(int32_t)word) * 37;
+            ok = ocxo.setFrequencyControlWord(expected);
+        }
+        else
+        {
+            emulator.setRegister(kSfeSiT5811RegControlLSW, (uint16_t)(i << 1)); // Change the word under the driver
+            expected = emulator.getFrequencyControlWord();
+            ok = ocxo.readAllRegisters();
+        }
+        uint32_t elapsed = simulatedMicros - start;
+
+        if (!ok)
+            failed++;
+        else if ((ocxo.getFrequencyControlWord() != expected) || (emulator.getFrequencyControlWord() != expected))
+            wrong++;
+
+        total += elapsed;
+        if (elapsed > longest)
+            longest = elapsed;
+    }
+
+    bool within = (longest <= kDeadlineMicros);
+    if (retries && !within)
+        allWithinDeadline = false;
+    totalWrong += wrong;
+
+    char name[40];
+    snprintf(name, sizeof(name), "%s%s", pattern.name, retries ? "" : ", no retries");
+    printf("%-30s %8lu %8lu %8lu %8lu %10.1f %10lu %6lu %8s\n", name, (unsigned long)failed,
+           (unsigned long)ocxo.getRetries(), (unsigned long)ocxo.getBusRecoveries(),
+           (unsigned long)ocxo.getDeadlineAborts(), total / kOperations, (unsigned long)longest, (unsigned long)wrong,
+           retries ? (within ? "yes" : "NO") : "-");
+}
+
+static void part(bool write)
+{
+    printf("%-30s %8s %8s %8s %8s %10s %10s %6s %8s\n", "pattern", "failed", "retries", "recover", "aborts",
+           "mean (us)", "max (us)", "wrong", "deadline");
+    for (unsigned p = 0; p < kNumPatterns; p++)
+        run(kPatterns[p], write, true);
+    run(kPatterns[kNumPatterns - 1], write, false);
+}
+
+int main(void)
+{
+    printf("SparkFun SiT5811 bus faults (400kHz, %lums bus timeout, %lums deadline, %lu operations per pattern)\n\n",
+           (unsigned long)(kTimeoutMicros / 1000), (unsigned long)(kDeadlineMicros / 1000), (unsigned long)kOperations);
+
+    printf("Part 1: setFrequencyControlWord\n");
+    part(true);
+
+    printf("\nPart 2: readAllRegisters\n");
+    part(false);
+
+    printf("\nEvery operation with the retry policy finished within the deadline: %s\n",
+           allWithinDeadline ? "yes" : "NO");
+    printf("Operations which returned the wrong word: %lu\n", (unsigned long)totalWrong);
+
+    if (!allWithinDeadline || (totalWrong > 0))
+    {
+        printf("FAIL\n");
+        return 1;
+    }
+
+    return 0;
+}
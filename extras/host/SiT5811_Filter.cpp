@@ -0,0 +1,382 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host bias pre-filter comparison
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Filter.cpp
+
+    Description:
+    Disciplines the simulated SiT5811 (SfeSiT5811Simulation) for a day with the default
+    PI gains, with bad biases added to the GNSS RX clock bias: 0.5% of the epochs are
+    outliers of +/-0.2 to 2us (e.g. multipath), once an hour there is a burst of three,
+    and every four hours a gross error of 50us. The median and EWMA stages delay the bias,
+    so those runs use lower gains. Compares no filter with SfeSiT5811FilterN<9> configured with different stages,
+    with the driver's default maximum frequency change and with it set to 3ppb.
+    For each this reports:
+        The number of biases rejected (and the number of outliers injected)
+        The time to lock (|time error| stays below 20ns)
+        The RMS and peak time error after the first hour
+        The number of updates limited by the maximum frequency change
+        The time taken by the filter per bias
+    The same is repeated with no outliers, to show the cost of the filter when the GNSS
+    is clean: false rejections and added time error.
+
+    First, it checks the filter against a sort-based reference on random input: the sliding
+    median for odd and even windows, from the first sample, and the rate gate and Hampel
+    rejections. The exit status is non-zero if any check fails.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Filter.cpp -o SiT5811_Filter
+    ./SiT5811_Filter
+
+*/
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+
+static const uint32_t kRunEpochs = 86400; // One day at 1Hz
+static const uint32_t kSettleEpochs = 3600; // Statistics start after the first hour
+static const double kLockThresholdSeconds = 20.0e-9; // Locked when |time error| < 20ns
+static const uint32_t kOutliersPer1000 = 5; // 0.5% of the epochs
+static const uint32_t kBurstEpochs = 3600; // A burst of three outliers every hour
+static const uint32_t kGlitchEpochs = 4 * 3600; // A gross error every four hours
+static const double kGlitchMillis = 50.0e-3; // 50us
+
+// A small PRNG for the outliers, so they do not disturb the simulation's noise
+static uint32_t outlierState;
+
+static uint32_t outlierRandom(void)
+{
+    outlierState = (outlierState * 1664525UL) + 1013904223UL;
+    return outlierState >> 8;
+}
+
+// A bad bias: +/-0.2 to 2us, in milliseconds
+static double outlierMillis(void)
+{
+    double magnitude = 0.2e-3 + (1.8e-3 * (double)(outlierRandom() % 1000) / 1000.0);
+    return ((outlierRandom() & 1) != 0) ? magnitude : (0.0 - magnitude);
+}
+
+static const uint32_t kCheckSamples = 20000; // Random biases per check
+static const double kMADScale = 1.4826; // As the filter
+
+static uint32_t checkFailures = 0; // Failed checks. Any failure makes the exit status non-zero
+
+// The checks' own PRNG
+static uint32_t checkState = 1;
+
+static uint32_t checkRandom(void)
+{
+    checkState = (checkState * 1664525UL) + 1013904223UL;
+    return checkState >> 8;
+}
+
+// A random bias in milliseconds: approx. 5ns noise on a coarse grid (so there are ties),
+// 1% outliers of up to +/-2us and 0.2% gross errors of 50us. Every 5000 samples the bias steps by 10us
+static double checkBias(uint32_t i)
+{
+    double bias = ((double)(i / 5000) * 10.0e-3) + ((double)((checkRandom() % 21) + (checkRandom() % 21)) - 20.0) * 0.5e-6;
+    uint32_t r = checkRandom() % 1000;
+    if (r < 10)
+        bias += ((double)(checkRandom() % 4001) - 2000.0) * 1.0e-6;
+    else if (r < 12)
+        bias += kGlitchMillis;
+    return bias;
+}
+
+// The median of the last count values of a history, by sorting
+static double sortedMedian(const double *history, uint32_t count)
+{
+    double sorted[64];
+    std::copy(history, history + count, sorted);
+    std::sort(sorted, sorted + count);
+    if ((count & 1) != 0)
+        return sorted[count / 2];
+    return 0.5 * (sorted[count / 2] + sorted[(count / 2) - 1]);
+}
+
+// Check the sliding median against sorting the window, from the first sample
+template <uint8_t N> static void checkMedian(void)
+{
+    SfeSiT5811FilterN<N> filter;
+    filter.setStages(kSfeSiT5811FilterMedian);
+
+    double window[N];
+    uint32_t mismatches = 0;
+    checkState = N;
+    for (uint32_t i = 0; i < kCheckSamples; i++)
+    {
+        double bias = checkBias(i);
+        window[i % N] = bias;
+        uint32_t count = (i < N) ? (i + 1) : N;
+
+        double median = filter.filter(bias);
+        if (median != sortedMedian(window, count))
+            mismatches++;
+    }
+
+    printf("Median, N = %2u: %lu mismatches in %lu samples\n", (unsigned)N, (unsigned long)mismatches,
+           (unsigned long)kCheckSamples);
+    if (mismatches > 0)
+    {
+        printf("FAIL: the sliding median does not match the sorted window\n");
+        checkFailures++;
+    }
+}
+
+// Check the rate gate and Hampel rejections against the documented rules, with sorted windows
+template <uint8_t N, uint8_t ScaleWindow> static void checkRejections(void)
+{
+    const double rateLimitMillis = 4.0e-3;
+    const uint8_t maxConsecutive = 3;
+    const double threshold = 4.0;
+    const double minScaleMillis = 1.0e-6;
+
+    SfeSiT5811FilterN<N, ScaleWindow> filter;
+    filter.setStages(kSfeSiT5811FilterRateGate | kSfeSiT5811FilterHampel);
+    filter.setRateGate(rateLimitMillis * 1.0e-3, maxConsecutive);
+    filter.setHampel(threshold, minScaleMillis * 1.0e-3);
+
+    double window[N];
+    double deviations[ScaleWindow];
+    uint32_t count = 0;
+    uint32_t deviationCount = 0;
+    bool havePassed = false;
+    double lastPassed = 0.0;
+    uint8_t consecutive = 0;
+    uint32_t rateRejected = 0;
+    uint32_t hampelRejected = 0;
+    uint32_t mismatches = 0;
+
+    checkState = N + ScaleWindow;
+    for (uint32_t i = 0; i < kCheckSamples; i++)
+    {
+        double bias = checkBias(i);
+        double x = bias;
+        bool rejected = false;
+
+        // Rate gate
+        if (havePassed && (fabs(x - lastPassed) > rateLimitMillis) && (consecutive < maxConsecutive))
+        {
+            consecutive++;
+            rateRejected++;
+            rejected = true;
+            x = lastPassed;
+        }
+        else
+        {
+            consecutive = 0;
+            havePassed = true;
+            lastPassed = x;
+        }
+
+        // Hampel: the deviation from the median of the previous N, against the MAD of the last ScaleWindow deviations
+        bool predicted = (count >= 3);
+        double prior = (count > 0) ? sortedMedian(window, (count < N) ? count : N) : 0.0;
+        window[count % N] = x;
+        count++;
+        if (predicted)
+        {
+            double deviation = fabs(x - prior);
+            deviations[deviationCount % ScaleWindow] = deviation;
+            deviationCount++;
+            uint32_t scaleCount = (deviationCount < ScaleWindow) ? deviationCount : ScaleWindow;
+            double scale = kMADScale * sortedMedian(deviations, scaleCount);
+            if (scale < minScaleMillis)
+                scale = minScaleMillis;
+            if ((scaleCount >= 3) && !rejected && (deviation > (threshold * scale)))
+            {
+                hampelRejected++;
+                rejected = true;
+                x = prior;
+            }
+        }
+
+        double filtered = filter.filter(bias);
+        if ((filtered != x) || (filter.isRejected() != rejected))
+            mismatches++;
+    }
+
+    printf("Rejections, N = %2u, scale window %2u: rate gate %lu (reference %lu), Hampel %lu (reference %lu), %lu "
+           "mismatched outputs\n",
+           (unsigned)N, (unsigned)ScaleWindow, (unsigned long)filter.getRateRejected(), (unsigned long)rateRejected,
+           (unsigned long)filter.getHampelRejected(), (unsigned long)hampelRejected, (unsigned long)mismatches);
+    if ((mismatches > 0) || (filter.getRateRejected() != rateRejected) || (filter.getHampelRejected() != hampelRejected) ||
+        (rateRejected == 0) || (hampelRejected == 0))
+    {
+        printf("FAIL: the rejections do not match the reference\n");
+        checkFailures++;
+    }
+}
+
+typedef struct
+{
+    const char *name;
+    bool filtered;
+    uint8_t stages;
+    double Pk;
+    double Ik;
+} config_t;
+
+static void run(const config_t &config, bool outliers, double maxChangePPB)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1); // Same noise for every configuration
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    if (maxChangePPB > 0.0)
+        ocxo.setMaxFrequencyChangePPB(maxChangePPB);
+
+    SfeSiT5811FilterN<9> filter;
+    if (config.filtered)
+    {
+        filter.setStages(config.stages);
+        filter.setRateGate(4.0e-6); // Above the 3.125ppm pull range: 3.125us per second
+        ocxo.setFilter(&filter);
+    }
+
+    outlierState = 12345;
+    uint32_t injected = 0;
+    uint32_t burst = 0;
+    double peak = 0.0;
+    double sumTimeError2 = 0.0;
+    uint32_t count = 0;
+    double filterSeconds = 0.0;
+    uint32_t lockEpoch = 0;
+
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kRunEpochs; e++)
+    {
+        double measured = bias;
+        if (outliers)
+        {
+            if ((e % kBurstEpochs) == (kBurstEpochs / 2))
+                burst = 3;
+            if ((e % kGlitchEpochs) == (kGlitchEpochs / 4))
+            {
+                measured += kGlitchMillis;
+                injected++;
+            }
+            if ((burst > 0) || ((outlierRandom() % 1000) < kOutliersPer1000))
+            {
+                measured += outlierMillis();
+                injected++;
+                if (burst > 0)
+                    burst--;
+            }
+        }
+
+        ocxo.setFrequencyByBiasMillis(measured, config.Pk, config.Ik);
+        bias = simulation.step();
+
+        double timeError = simulation.getTimeErrorSeconds();
+        if (fabs(timeError) >= kLockThresholdSeconds)
+            lockEpoch = e + 1;
+
+        if (e >= kSettleEpochs)
+        {
+            if (fabs(timeError) > peak)
+                peak = fabs(timeError);
+            sumTimeError2 += timeError * timeError;
+            count++;
+        }
+    }
+
+    // Time the filter on its own, on the same kind of input
+    if (config.filtered)
+    {
+        SfeSiT5811FilterN<9> timed;
+        timed.setStages(config.stages);
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        double sink = 0.0;
+        for (uint32_t e = 0; e < kRunEpochs; e++)
+            sink += timed.filter(((double)(outlierRandom() % 1000) - 500.0) * 1.0e-8);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        filterSeconds = ((double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) * 1.0e-9));
+        if (sink == 12345.0)
+            printf(" "); // Keep the loop
+    }
+
+    char rejected[32];
+    if (config.filtered)
+        snprintf(rejected, sizeof(rejected), "%lu / %lu", (unsigned long)filter.getRejected(), (unsigned long)injected);
+    else
+        snprintf(rejected, sizeof(rejected), "- / %lu", (unsigned long)injected);
+
+    printf("%-22s %14s %10lu %12.2f %12.2f %10lu %10.0f\n", config.name, rejected, (unsigned long)lockEpoch,
+           sqrt(sumTimeError2 / count) * 1.0e9, peak * 1.0e9, (unsigned long)ocxo.getDiscipline().getSlewLimited(),
+           config.filtered ? (filterSeconds * 1.0e9 / (double)kRunEpochs) : 0.0);
+}
+
+int main(void)
+{
+    const config_t configs[] = {
+        {"no filter", false, 0, 0.5, 0.1},
+        {"rate gate", true, kSfeSiT5811FilterRateGate, 0.5, 0.1},
+        {"Hampel (default)", true, kSfeSiT5811FilterHampel, 0.5, 0.1},
+        {"rate gate + Hampel", true, kSfeSiT5811FilterRateGate | kSfeSiT5811FilterHampel, 0.5, 0.1},
+        {"Hampel + median", true, kSfeSiT5811FilterHampel | kSfeSiT5811FilterMedian, 0.1, 0.005},
+        {"Hampel + EWMA", true, kSfeSiT5811FilterHampel | kSfeSiT5811FilterEWMA, 0.3, 0.03},
+    };
+
+    printf("SparkFun SiT5811 bias pre-filter checks (%lu random biases each)\n\n", (unsigned long)kCheckSamples);
+    checkMedian<3>();
+    checkMedian<4>();
+    checkMedian<5>();
+    checkMedian<8>();
+    checkMedian<9>();
+    checkMedian<16>();
+    checkMedian<31>();
+    checkRejections<9, 32>();
+    checkRejections<8, 16>();
+    checkRejections<31, 3>();
+
+    printf("\nSparkFun SiT5811 bias pre-filter (%lu s, 9 sample window, statistics after %lu s)\n",
+           (unsigned long)kRunEpochs, (unsigned long)kSettleEpochs);
+
+    const double maxChanges[] = {0.0, 3.0}; // The driver default (no practical limit), and 3ppb
+
+    for (unsigned m = 0; m < sizeof(maxChanges) / sizeof(maxChanges[0]); m++)
+    {
+        for (int outliers = 1; outliers >= 0; outliers--)
+        {
+            char limit[32];
+            if (maxChanges[m] > 0.0)
+                snprintf(limit, sizeof(limit), "%.0fppb", maxChanges[m]);
+            else
+                snprintf(limit, sizeof(limit), "the default");
+            printf("\n%s, maximum frequency change %s:\n", outliers ? "With outliers" : "Clean GNSS", limit);
+            printf("%-22s %14s %10s %12s %12s %10s %10s\n", "filter", "rejected", "lock (s)", "RMS TE (ns)",
+                   "peak TE (ns)", "slew lim.", "ns/bias");
+            for (unsigned c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+                run(configs[c], outliers != 0, maxChanges[m]);
+        }
+    }
+
+    if (checkFailures > 0)
+    {
+        printf("\n%lu check(s) FAILED\n", (unsigned long)checkFailures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host holdover comparison
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Holdover.cpp
+
+    Description:
+    Disciplines the simulated SiT5811 (SfeSiT5811Simulation) for a day, then the GNSS
+    bias stops. Compares leaving the last control word in place with SfeSiT5811Holdover
+    (fit time constants of 15 minutes, 1 hour and 4 hours), for outages of 1, 4 and
+    12 hours. For each this reports the true time error at the end of the outage and
+    the holdover's estimated time error bound. Then the bias returns and it reports the
+    time to re-lock (|time error| stays below 20ns).
+
+    The simulation includes aging (0.05 ppb/day) and a daily temperature cycle, so the
+    frequency keeps moving during the outage.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Holdover.cpp -o SiT5811_Holdover
+    ./SiT5811_Holdover
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Holdover.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+
+static const double kLockThresholdSeconds = 20.0e-9; // Locked when |time error| < 20ns
+static const uint32_t kLockedEpochs = 86400; // One day at 1Hz before the outage
+static const uint32_t kRelockEpochs = 3600; // One hour after the outage
+
+static uint32_t simulatedMillis = 0; // The holdover clock: the simulation epoch
+
+static uint32_t simulationClock(void)
+{
+    return simulatedMillis;
+}
+
+// The time error at the end of the outage, the bound, and the time to re-lock after it
+typedef struct
+{
+    double timeError;
+    double bound;
+    uint32_t relock;
+} result_t;
+
+// Run the day, then the outage, then the re-lock. timeConstant 0: no holdover
+static result_t run(double timeConstant, uint32_t outageEpochs)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1); // Same noise for every run
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+
+    SfeSiT5811Holdover holdover;
+    holdover.setClock(simulationClock);
+    if (timeConstant > 0.0)
+    {
+        holdover.setTimeConstant(timeConstant);
+        ocxo.setHoldover(&holdover);
+    }
+
+    simulatedMillis = 0;
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kLockedEpochs; e++)
+    {
+        ocxo.setFrequencyByBiasMillis(bias);
+        holdover.update();
+        simulatedMillis += 1000;
+        bias = simulation.step();
+    }
+
+    // The outage: no bias
+    for (uint32_t e = 0; e < outageEpochs; e++)
+    {
+        holdover.update();
+        simulatedMillis += 1000;
+        bias = simulation.step();
+    }
+
+    result_t result;
+    result.timeError = simulation.getTimeErrorSeconds();
+    result.bound = holdover.getTimeErrorBound();
+
+    // The bias returns
+    result.relock = 0;
+    for (uint32_t e = 0; e < kRelockEpochs; e++)
+    {
+        ocxo.setFrequencyByBiasMillis(bias);
+        holdover.update();
+        simulatedMillis += 1000;
+        bias = simulation.step();
+        if (fabs(simulation.getTimeErrorSeconds()) >= kLockThresholdSeconds)
+            result.relock = e + 1;
+    }
+
+    return result;
+}
+
+int main(void)
+{
+    const uint32_t outages[] = {3600, 4 * 3600, 12 * 3600};
+    const double timeConstants[] = {0.0, 900.0, 3600.0, 4 * 3600.0};
+
+    printf("SparkFun SiT5811 holdover (%lu s locked, then the GNSS bias stops)\n\n", (unsigned long)kLockedEpochs);
+    printf("%-10s %-14s %16s %16s %12s\n", "outage (h)", "steering", "time error (ns)", "est. bound (ns)",
+           "re-lock (s)");
+
+    for (unsigned o = 0; o < sizeof(outages) / sizeof(outages[0]); o++)
+    {
+        for (unsigned t = 0; t < sizeof(timeConstants) / sizeof(timeConstants[0]); t++)
+        {
+            result_t result = run(timeConstants[t], outages[o]);
+
+            char steering[32];
+            if (timeConstants[t] == 0.0)
+                snprintf(steering, sizeof(steering), "last word");
+            else
+                snprintf(steering, sizeof(steering), "holdover %.0fs", timeConstants[t]);
+
+            if (timeConstants[t] == 0.0)
+                printf("%-10.0f %-14s %16.1f %16s %12lu\n", outages[o] / 3600.0, steering,
+                       result.timeError * 1.0e9, "-", (unsigned long)result.relock);
+            else
+                printf("%-10.0f %-14s %16.1f %16.1f %12lu\n", outages[o] / 3600.0, steering,
+                       result.timeError * 1.0e9, result.bound * 1.0e9, (unsigned long)result.relock);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host steering law comparison
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Kalman.cpp
+
+    Description:
+    Steers the simulated SiT5811 (SfeSiT5811Simulation) for a day with each steering law:
+    PI (the default gains), the two-state Kalman filter and the three-state Kalman filter.
+    Each law sees the same oscillator and GNSS noise, at the typical 5ns GNSS noise and at
+    a noisier 20ns (with the Kalman measurement noise set to match). For each this reports:
+        The time to lock (|time error| stays below 20ns, or 60ns at 20ns GNSS noise)
+        The RMS and peak time error after the first hour
+        The RMS fractional frequency error after the first hour
+    It also times the update, to show the cost per epoch.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Kalman.cpp -o SiT5811_Kalman
+    ./SiT5811_Kalman
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+
+static const uint32_t kRunEpochs = 86400; // One day at 1Hz
+static const uint32_t kSettleEpochs = 3600; // Statistics start after the first hour
+
+static const char *steeringName(sfe_SiT5811_steering_t mode)
+{
+    switch (mode)
+    {
+    case kSfeSiT5811SteeringPI:
+        return "PI";
+    case kSfeSiT5811SteeringKalman2:
+        return "Kalman 2-state";
+    default:
+        return "Kalman 3-state";
+    }
+}
+
+static void run(sfe_SiT5811_steering_t mode, double gnssNoiseSeconds)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+    params.gnssNoiseSeconds = gnssNoiseSeconds;
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1); // Same noise for every law
+
+    SfeSiT5811Driver ocxo;
+    SfeSiT5811Kalman kalman;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+    kalman.setMeasurementNoise(gnssNoiseSeconds);
+    ocxo.setSteeringMode(mode, (mode == kSfeSiT5811SteeringPI) ? nullptr : &kalman);
+
+    double lockThreshold = 4.0 * gnssNoiseSeconds;
+    uint32_t lockEpoch = 0;
+    double peak = 0.0;
+    double sumTimeError2 = 0.0;
+    double sumFrequency2 = 0.0;
+    uint32_t count = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kRunEpochs; e++)
+    {
+        ocxo.setFrequencyByBiasMillis(bias);
+        bias = simulation.step();
+
+        double timeError = simulation.getTimeErrorSeconds();
+        if (fabs(timeError) >= lockThreshold)
+            lockEpoch = e + 1;
+
+        if (e >= kSettleEpochs)
+        {
+            if (fabs(timeError) > peak)
+                peak = fabs(timeError);
+            sumTimeError2 += timeError * timeError;
+            double frequency = simulation.getFractionalFrequency();
+            sumFrequency2 += frequency * frequency;
+            count++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double nsPerEpoch =
+        (((double)(end.tv_sec - start.tv_sec) * 1.0e9) + (double)(end.tv_nsec - start.tv_nsec)) / (double)kRunEpochs;
+
+    printf("%-16s %8.0f %10lu %12.2f %12.2f %14.4f %12.0f\n", steeringName(mode), gnssNoiseSeconds * 1.0e9,
+           (unsigned long)lockEpoch, sqrt(sumTimeError2 / count) * 1.0e9, peak * 1.0e9,
+           sqrt(sumFrequency2 / count) * 1.0e9, nsPerEpoch);
+}
+
+int main(void)
+{
+    const double gnssNoise[] = {5.0e-9, 20.0e-9};
+    const sfe_SiT5811_steering_t modes[] = {kSfeSiT5811SteeringPI, kSfeSiT5811SteeringKalman2,
+                                            kSfeSiT5811SteeringKalman3};
+
+    printf("SparkFun SiT5811 steering laws (%lu s, statistics after %lu s)\n\n", (unsigned long)kRunEpochs,
+           (unsigned long)kSettleEpochs);
+    printf("%-16s %8s %10s %12s %12s %14s %12s\n", "steering", "GNSS (ns)", "lock (s)", "RMS TE (ns)", "peak TE (ns)",
+           "RMS freq (ppb)", "ns/epoch");
+
+    for (unsigned n = 0; n < sizeof(gnssNoise) / sizeof(gnssNoise[0]); n++)
+        for (unsigned m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+            run(modes[m], gnssNoise[n]);
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host PPS capture test
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_PPS.cpp
+
+    Description:
+    Part 1 exercises SfeSiT5811PPSQueue with a thread standing in for the ISR. The producer
+    thread pushes a sequence of counter values, yielding after each; the consumer (the main
+    thread) pops them, once freely and once pausing so the ring overflows. Every popped
+    edge must be the previous one plus one plus the edges dropped before it. It reports the
+    edges pushed, popped, dropped (as carried by the next edge) and refused by push, the
+    sequence errors (which must be zero) and the time per edge, including the yields.
+
+    Part 2 disciplines the simulated SiT5811 (SfeSiT5811Simulation) for a day from the
+    PPS path: SfeSiT5811PPS with a 10MHz counter clocked by the OCXO, and with a 100MHz
+    counter, compared with the RxClkBias path. The counter starts just before it wraps,
+    and every 1000 seconds the main loop stalls for three edges. The PPS edges carry the
+    same GNSS noise as RxClkBias. The PPS path holds the phase it had at the first edge,
+    so its time error is reported relative to that.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -pthread -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_PPS.cpp -o SiT5811_PPS
+    ./SiT5811_PPS
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <time.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_PPS.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+
+static const uint32_t kPushes = 2000000; // Part 1: edges pushed by the producer thread
+static const uint32_t kRunEpochs = 86400; // Part 2: one day at 1Hz
+static const uint32_t kSettleEpochs = 3600; // Statistics start after the first hour
+static const uint32_t kStallEpochs = 1000; // The main loop stalls every 1000 seconds
+static const uint32_t kStallEdges = 3; // for three edges
+
+static double secondsSince(const struct timespec &start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start.tv_sec) + ((double)(now.tv_nsec - start.tv_nsec) * 1.0e-9);
+}
+
+// Part 1: the producer thread pushes 1, 2, 3 ... The consumer checks the sequence
+static void stress(bool slowConsumer)
+{
+    static SfeSiT5811PPSQueueN<16> queue;
+    queue.reset();
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    std::atomic<bool> done(false);
+    uint32_t refused = 0;
+    std::thread producer([&refused, &done]() {
+        for (uint32_t count = 1; count <= kPushes; count++)
+        {
+            if (!queue.push(count))
+                refused++;
+            std::this_thread::yield(); // Edges arrive one at a time, even on a single core host
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t expected = 1;
+    uint32_t popped = 0;
+    uint32_t dropped = 0;
+    uint32_t errors = 0;
+    while (true)
+    {
+        sfe_SiT5811_pps_edge_t edge;
+        if (!queue.pop(edge))
+        {
+            if (done.load(std::memory_order_acquire) && !queue.pop(edge))
+                break; // The producer has finished and the ring is empty
+            if (!done.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+        }
+
+        popped++;
+        dropped += edge.dropped;
+        if ((edge.dropped < 255) && (edge.count != (expected + edge.dropped)))
+            errors++; // The count saturates at 255: beyond it the sequence cannot be checked
+        expected = edge.count + 1;
+
+        if (slowConsumer && ((popped % 256) == 0))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Let the producer overflow the ring
+    }
+
+    producer.join();
+    double seconds = secondsSince(start);
+
+    // refused exceeds dropped: the carried count saturates at 255, and the last drops have no edge to carry them
+    printf("%-16s %10lu %10lu %10lu %10lu %8lu %10.0f\n", slowConsumer ? "slow consumer" : "free consumer",
+           (unsigned long)kPushes, (unsigned long)popped, (unsigned long)dropped, (unsigned long)refused,
+           (unsigned long)errors, seconds * 1.0e9 / (double)kPushes);
+}
+
+// Part 2: countsPerSecond 0 steers with RxClkBias instead
+static void discipline(uint32_t countsPerSecond)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1); // Same noise for every run
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+
+    SfeSiT5811PPSQueueN<8> queue;
+    SfeSiT5811PPS pps;
+    pps.begin(&queue, &ocxo, countsPerSecond);
+
+    const int64_t counterStart = 0xFFFFFFFFLL - (3LL * (int64_t)countsPerSecond); // Wraps after three seconds
+
+    double reference = 0.0;
+    double peak = 0.0;
+    double sumTimeError2 = 0.0;
+    uint32_t count = 0;
+
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kRunEpochs; e++)
+    {
+        if (countsPerSecond == 0)
+            ocxo.setFrequencyByBiasMillis(bias);
+        else
+        {
+            // The ISR: the counter value at the PPS edge. The edge has the GNSS noise on it
+            double edgeSeconds = (double)e + (bias * 1.0e-3);
+            int64_t counter = counterStart + (int64_t)floor(edgeSeconds * (double)countsPerSecond);
+            queue.push((uint32_t)counter);
+
+            // The main loop
+            if ((e % kStallEpochs) >= kStallEdges)
+                pps.update();
+        }
+
+        if (e == 0)
+            reference = (countsPerSecond == 0) ? 0.0 : simulation.getTimeErrorSeconds();
+
+        bias = simulation.step();
+
+        if (e >= kSettleEpochs)
+        {
+            double timeError = simulation.getTimeErrorSeconds() - reference;
+            if (fabs(timeError) > peak)
+                peak = fabs(timeError);
+            sumTimeError2 += timeError * timeError;
+            count++;
+        }
+    }
+
+    char source[32];
+    if (countsPerSecond == 0)
+        snprintf(source, sizeof(source), "RxClkBias");
+    else
+        snprintf(source, sizeof(source), "PPS %luMHz", (unsigned long)(countsPerSecond / 1000000));
+
+    printf("%-16s %12.2f %12.2f %8lu %8lu %8lu\n", source, sqrt(sumTimeError2 / count) * 1.0e9, peak * 1.0e9,
+           (unsigned long)pps.getEdges(), (unsigned long)pps.getSkipped(), (unsigned long)pps.getRejected());
+}
+
+int main(void)
+{
+    printf("SparkFun SiT5811 PPS capture\n\n");
+
+    printf("Part 1: SfeSiT5811PPSQueueN<16>, producer thread standing in for the ISR\n");
+    printf("%-16s %10s %10s %10s %10s %8s %10s\n", "", "pushed", "popped", "dropped", "refused", "errors", "ns/edge");
+    stress(false);
+    stress(true);
+
+    printf("\nPart 2: %lu s disciplined, statistics after %lu s\n", (unsigned long)kRunEpochs,
+           (unsigned long)kSettleEpochs);
+    printf("%-16s %12s %12s %8s %8s %8s\n", "bias source", "RMS TE (ns)", "peak TE (ns)", "edges", "skipped",
+           "rejected");
+    discipline(0);
+    discipline(10000000);
+    discipline(100000000);
+
+    return 0;
+}
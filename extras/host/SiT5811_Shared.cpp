@@ -0,0 +1,273 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host shared driver test
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Shared.cpp
+
+    Description:
+    Exercises SfeSiT5811Shared with threads standing in for RTOS tasks. The bus is a
+    SfeSiT5811RegisterFile which sleeps for 150us per transaction, like a blocking I2C
+    driver at 400kHz.
+
+    Part 1 (stress): two writer threads set control words from a table whose entries
+    differ in both 32-bit halves, while reader threads copy the state. Each state read
+    must be one table entry throughout: word, frequency and PPQ all from the same entry.
+    Each reader also checks that the update count never goes backwards. It reports the
+    writes, the reads and the inconsistent reads (which must be zero: if not, the exit
+    status is non-zero).
+
+    Part 2 (benchmark): one writer steers with setFrequencyByBiasMillis as fast as it can,
+    while reader threads call getFrequencyHz: through the seqlock, and for comparison by
+    taking the writers' lock (std::mutex) around the driver's own getFrequencyHz. It
+    reports the writes per second and the read latency: mean, 99th percentile and maximum.
+    The maximum includes the host scheduler; the lock shows the reads waiting for the bus.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -pthread -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Shared.cpp -o SiT5811_Shared
+    ./SiT5811_Shared
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Shared.h"
+
+static const uint32_t kBusMicros = 150; // Per transaction
+static const uint32_t kRunMillis = 2000; // Per test
+static const unsigned kReaders = 3;
+
+// A register file which takes as long as I2C
+class SlowRegisterFile : public SfeSiT5811RegisterFile
+{
+public:
+    sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(kBusMicros));
+        return SfeSiT5811RegisterFile::readRegisterRegion(reg, data, numBytes, readBytes);
+    }
+
+    sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(kBusMicros));
+        return SfeSiT5811RegisterFile::writeRegisterRegion(reg, data, numBytes);
+    }
+};
+
+// The host equivalent of SfeSiT5811FreeRTOSLock
+class MutexLock : public SfeSiT5811Lock
+{
+public:
+    void lock(void) { _mutex.lock(); }
+    void unlock(void) { _mutex.unlock(); }
+
+private:
+    std::mutex _mutex;
+};
+
+static uint64_t nowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+// Part 1: every 32-bit half differs between entries, so a torn copy matches none of them
+static const int64_t kTable[] = {-274877906944LL, 274877906943LL, 0x0A5A5A5A5ALL, 0x1234567890LL, -0x2345678901LL};
+static const unsigned kTableSize = sizeof(kTable) / sizeof(kTable[0]);
+
+// Return the number of inconsistent reads
+static uint32_t stress(void)
+{
+    SlowRegisterFile registers;
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setFullWrites(true);
+
+    // The frequency and PPQ for each word, from a private driver
+    double hz[kTableSize];
+    int64_t ppq[kTableSize];
+    {
+        SfeSiT5811RegisterFile reference;
+        SfeSiT5811Driver check;
+        check.begin(&reference);
+        for (unsigned i = 0; i < kTableSize; i++)
+        {
+            check.setFrequencyControlWord(kTable[i]);
+            hz[i] = check.getFrequencyHz();
+            ppq[i] = check.getFrequencyOffsetPPQ();
+        }
+    }
+
+    MutexLock lock;
+    SfeSiT5811Shared shared;
+    shared.begin(&ocxo, &lock);
+    shared.setFrequencyControlWord(kTable[0]);
+
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> writes(0);
+    std::atomic<uint32_t> reads(0);
+    std::atomic<uint32_t> errors(0);
+
+    auto writer = [&](unsigned first) {
+        for (unsigned i = first; !done.load(); i++)
+        {
+            shared.setFrequencyControlWord(kTable[i % kTableSize]);
+            writes++;
+        }
+    };
+
+    auto reader = [&]() {
+        uint32_t lastUpdates = 0;
+        uint32_t count = 0;
+        while (!done.load())
+        {
+            sfe_SiT5811_shared_state_t state;
+            shared.read(state);
+            count++;
+
+            unsigned i = 0;
+            while ((i < kTableSize) && (kTable[i] != state.frequencyControl))
+                i++;
+            if ((i == kTableSize) || (state.frequencyHz != hz[i]) || (state.frequencyOffsetPPQ != ppq[i]) ||
+                (state.updates < lastUpdates))
+                errors++;
+            lastUpdates = state.updates;
+
+            if ((count % 64) == 0)
+                std::this_thread::yield(); // Give the writers a chance on a single core host
+        }
+        reads += count;
+    };
+
+    std::vector<std::thread> threads;
+    threads.push_back(std::thread(writer, 0));
+    threads.push_back(std::thread(writer, 2));
+    for (unsigned r = 0; r < kReaders; r++)
+        threads.push_back(std::thread(reader));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(kRunMillis));
+    done.store(true);
+    for (unsigned t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    printf("%-22s %10lu %12lu %12lu\n", "2 writers, 3 readers", (unsigned long)writes.load(),
+           (unsigned long)reads.load(), (unsigned long)errors.load());
+
+    return errors.load();
+}
+
+// Part 2: readers through the seqlock, or through the writers' lock
+static void benchmark(bool seqlock)
+{
+    SlowRegisterFile registers;
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+
+    MutexLock lock;
+    SfeSiT5811Shared shared;
+    shared.begin(&ocxo, &lock);
+
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> writes(0);
+    std::mutex latencyMutex;
+    std::vector<uint32_t> latencies; // ns
+
+    std::thread writer([&]() {
+        double bias = 1.0e-3;
+        while (!done.load())
+        {
+            shared.setFrequencyByBiasMillis(bias);
+            bias = -bias; // Keep the word changing, so every update writes
+            writes++;
+        }
+    });
+
+    auto reader = [&]() {
+        std::vector<uint32_t> mine;
+        mine.reserve(1 << 20);
+        double sink = 0.0;
+        while (!done.load())
+        {
+            uint64_t start = nowNanos();
+            if (seqlock)
+                sink += shared.getFrequencyHz();
+            else
+            {
+                lock.lock();
+                sink += ocxo.getFrequencyHz();
+                lock.unlock();
+            }
+            uint64_t elapsed = nowNanos() - start;
+            mine.push_back((uint32_t)std::min(elapsed, (uint64_t)0xFFFFFFFF));
+
+            if ((mine.size() % 64) == 0)
+                std::this_thread::yield();
+        }
+        if (sink == 1.0)
+            printf(" "); // Keep the reads
+
+        std::lock_guard<std::mutex> guard(latencyMutex);
+        latencies.insert(latencies.end(), mine.begin(), mine.end());
+    };
+
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < kReaders; r++)
+        readers.push_back(std::thread(reader));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(kRunMillis));
+    done.store(true);
+    writer.join();
+    for (unsigned r = 0; r < readers.size(); r++)
+        readers[r].join();
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (size_t i = 0; i < latencies.size(); i++)
+        sum += latencies[i];
+    uint32_t p99 = latencies[(latencies.size() * 99) / 100];
+    uint32_t worst = latencies[latencies.size() - 1];
+
+    printf("%-22s %10.0f %10lu %10.0f %10.1f %10.1f\n", seqlock ? "seqlock" : "lock (std::mutex)",
+           (double)writes.load() * 1000.0 / (double)kRunMillis, (unsigned long)latencies.size(),
+           sum / (double)latencies.size(), (double)p99 * 1.0e-3, (double)worst * 1.0e-3);
+}
+
+int main(void)
+{
+    printf("SparkFun SiT5811 shared driver (%uus per bus transaction, %ums per test, %u cores)\n\n",
+           (unsigned)kBusMicros, (unsigned)kRunMillis, std::thread::hardware_concurrency());
+
+    printf("Part 1: consistency\n");
+    printf("%-22s %10s %12s %12s\n", "", "writes", "reads", "inconsistent");
+    uint32_t inconsistent = stress();
+
+    printf("\nPart 2: %u readers calling getFrequencyHz while one writer steers\n", kReaders);
+    printf("%-22s %10s %10s %10s %10s %10s\n", "readers use", "writes/s", "reads", "mean (ns)", "p99 (us)",
+           "max (us)");
+    benchmark(true);
+    benchmark(false);
+
+    if (inconsistent > 0)
+    {
+        printf("\nFAIL: %lu inconsistent reads\n", (unsigned long)inconsistent);
+        return 1;
+    }
+
+    return 0;
+}
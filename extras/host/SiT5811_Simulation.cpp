@@ -0,0 +1,135 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host discipline loop simulation
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Simulation.cpp
+
+    Description:
+    Sweeps the setFrequencyByBiasMillis Pk and Ik terms against the simulated
+    SiT5811 and GNSS receiver (SfeSiT5811Simulation). The driver is unmodified:
+    it writes the control word into a SfeSiT5811RegisterFile and the simulated
+    oscillator reads it back. For each Pk / Ik pair this reports:
+        The time to lock (the first epoch after which |time error| stays below the lock threshold)
+        The RMS and peak time error over the second half of the run
+        The number of slew-limited updates
+    then the ADEV, TDEV and MTIE of the default Pk / Ik run (SfeSiT5811Stability),
+    and finally the simulation speed in epochs per second.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Simulation.cpp -o SiT5811_Simulation
+    ./SiT5811_Simulation [epochs]
+
+*/
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+#include "SparkFun_SiT5811_Stability.h"
+
+static const double kLockThresholdSeconds = 20.0e-9; // Locked when |time error| < 20ns
+
+int main(int argc, char **argv)
+{
+    uint32_t epochs = 172800; // Two days at 1Hz
+    if (argc > 1)
+        epochs = (uint32_t)strtoul(argv[1], nullptr, 10);
+
+    const double Pks[] = {0.1, 0.2, 0.5, 1.0};
+    const double Iks[] = {0.01, 0.05, 0.1, 0.2};
+
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    printf("SparkFun SiT5811 discipline loop simulation (%lu epochs per run)\n\n", (unsigned long)epochs);
+    printf("%6s %6s %10s %12s %12s %10s\n", "Pk", "Ik", "lock (s)", "RMS (ns)", "peak (ns)", "limited");
+
+    uint64_t totalEpochs = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (size_t p = 0; p < sizeof(Pks) / sizeof(Pks[0]); p++)
+    {
+        for (size_t i = 0; i < sizeof(Iks) / sizeof(Iks[0]); i++)
+        {
+            SfeSiT5811RegisterFile registers;
+            registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+            SfeSiT5811Simulation simulation(registers);
+            simulation.begin(params, 1); // Same noise for every run
+
+            SfeSiT5811Driver ocxo;
+            ocxo.begin(&registers);
+            ocxo.setBaseFrequencyHz(10000000.0);
+            ocxo.setMaxFrequencyChangePPB(3.0);
+
+            uint32_t lockEpoch = 0;
+            double sumSquares = 0.0;
+            double peak = 0.0;
+
+            for (uint32_t e = 0; e < epochs; e++)
+            {
+                double bias = simulation.step();
+                ocxo.setFrequencyByBiasMillis(bias, Pks[p], Iks[i]);
+
+                double timeError = fabs(simulation.getTimeErrorSeconds());
+                if (timeError >= kLockThresholdSeconds)
+                    lockEpoch = e + 1;
+                if (e >= (epochs / 2))
+                {
+                    sumSquares += timeError * timeError;
+                    if (timeError > peak)
+                        peak = timeError;
+                }
+            }
+            totalEpochs += epochs;
+
+            double rms = sqrt(sumSquares / (epochs - (epochs / 2)));
+            if (lockEpoch < epochs)
+                printf("%6.2f %6.2f %10.0f %12.2f %12.2f %10lu\n", Pks[p], Iks[i], lockEpoch * params.epochSeconds, rms * 1.0e9,
+                       peak * 1.0e9, (unsigned long)ocxo.getDiscipline().getSlewLimited());
+            else
+                printf("%6.2f %6.2f %10s %12.2f %12.2f %10lu\n", Pks[p], Iks[i], "no lock", rms * 1.0e9, peak * 1.0e9,
+                       (unsigned long)ocxo.getDiscipline().getSlewLimited());
+        }
+    }
+
+    // Stability of the default Pk / Ik
+    {
+        SfeSiT5811RegisterFile registers;
+        registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+        SfeSiT5811Simulation simulation(registers);
+        simulation.begin(params, 1);
+
+        SfeSiT5811Driver ocxo;
+        ocxo.begin(&registers);
+        ocxo.setMaxFrequencyChangePPB(3.0);
+
+        static SfeSiT5811StabilityN<12> stability(params.epochSeconds); // 1s to 2048s
+        ocxo.setStabilityEstimator(&stability);
+
+        for (uint32_t e = 0; e < epochs; e++)
+            ocxo.setFrequencyByBiasMillis(simulation.step()); // Default Pk and Ik
+        totalEpochs += epochs;
+
+        printf("\nStability of the RxClkBias with the default Pk / Ik\n");
+        printf("%8s %12s %12s %12s\n", "tau (s)", "ADEV", "TDEV (ns)", "MTIE (ns)");
+        for (uint8_t k = 0; k < stability.getOctaves(); k++)
+            printf("%8.0f %12.3e %12.3f %12.3f\n", stability.getTau(k), stability.getADEV(k), stability.getTDEV(k) * 1.0e9,
+                   stability.getMTIE(k) * 1.0e9);
+    }
+
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+    printf("\n%.2f million epochs per second (driver + simulation)\n", ((double)totalEpochs / seconds) / 1.0e6);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host telemetry decoder
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_TelemetryDecode.cpp
+
+    Description:
+    Decodes a SfeSiT5811Telemetry stream (e.g. captured from Serial.write of
+    getReadable) and prints one CSV line per record:
+        timestamp_ms,bias_ps,control_word,slew_limited,pull_limited,bus_status
+
+    With no file, it runs the discipline loop against the simulated SiT5811
+    (SfeSiT5811Simulation) with a small telemetry buffer, drains the buffer as
+    it goes, decodes the stream and reports the bytes per record and the number
+    of records which did not match what was logged.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_TelemetryDecode.cpp -o SiT5811_TelemetryDecode
+    ./SiT5811_TelemetryDecode [file | -]
+
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+#include "SparkFun_SiT5811_Telemetry.h"
+
+static void printRecord(const sfe_SiT5811_telemetry_record_t &record)
+{
+    printf("%lu,%lld,%lld,%d,%d,%ld\n", (unsigned long)record.timestamp, (long long)record.biasPs,
+           (long long)record.controlWord, (record.flags & kSfeSiT5811TelemetryFlagSlewLimited) ? 1 : 0,
+           (record.flags & kSfeSiT5811TelemetryFlagPullLimited) ? 1 : 0, (long)record.busStatus);
+}
+
+static int decodeFile(FILE *in)
+{
+    SfeSiT5811TelemetryDecoder decoder;
+    sfe_SiT5811_telemetry_record_t record;
+    unsigned long records = 0;
+
+    printf("timestamp_ms,bias_ps,control_word,slew_limited,pull_limited,bus_status\n");
+
+    int c;
+    while ((c = fgetc(in)) != EOF)
+    {
+        if (decoder.decode((uint8_t)c, record))
+        {
+            printRecord(record);
+            records++;
+        }
+    }
+
+    fprintf(stderr, "%lu records, %lu skipped before a keyframe, %lu malformed\n", records,
+            (unsigned long)decoder.getUnsynced(), (unsigned long)decoder.getMalformed());
+    return 0;
+}
+
+static int selfTest(void)
+{
+    const uint32_t epochs = 86400; // One day at 1Hz
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+    simulation.begin(params, 1);
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setBaseFrequencyHz(10000000.0);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+
+    SfeSiT5811TelemetryN<256> telemetry;
+    ocxo.setTelemetry(&telemetry);
+
+    SfeSiT5811TelemetryDecoder decoder;
+    sfe_SiT5811_telemetry_record_t record;
+
+    // What was logged, for comparison with what was decoded
+    static int64_t loggedWords[epochs];
+    static int64_t loggedBiasPs[epochs];
+    uint32_t decoded = 0;
+    uint32_t mismatches = 0;
+    uint32_t limited = 0;
+    uint64_t bytes = 0;
+
+    for (uint32_t e = 0; e < epochs; e++)
+    {
+        double bias = simulation.step();
+        ocxo.setFrequencyByBiasMillis(bias);
+
+        double ps = bias * 1.0e9;
+        loggedBiasPs[e] = (int64_t)((ps >= 0.0) ? (ps + 0.5) : (ps - 0.5));
+        loggedWords[e] = ocxo.getFrequencyControlWord();
+
+        // Drain - zero-copy - as a sketch would with Serial.write
+        const uint8_t *data;
+        size_t len;
+        while ((len = telemetry.getReadable(data)) > 0)
+        {
+            for (size_t i = 0; i < len; i++)
+            {
+                if (decoder.decode(data[i], record))
+                {
+                    if ((record.timestamp >= epochs) || (record.biasPs != loggedBiasPs[record.timestamp]) ||
+                        (record.controlWord != loggedWords[record.timestamp]))
+                        mismatches++;
+                    if (record.flags & (kSfeSiT5811TelemetryFlagSlewLimited | kSfeSiT5811TelemetryFlagPullLimited))
+                        limited++;
+                    decoded++;
+                }
+            }
+            bytes += len;
+            telemetry.consume(len);
+        }
+    }
+
+    printf("SparkFun SiT5811 telemetry round trip (%lu epochs)\n\n", (unsigned long)epochs);
+    printf("Records logged:   %lu\n", (unsigned long)telemetry.getRecords());
+    printf("Records dropped:  %lu\n", (unsigned long)telemetry.getDropped());
+    printf("Records decoded:  %lu\n", (unsigned long)decoded);
+    printf("Mismatches:       %lu\n", (unsigned long)mismatches);
+    printf("Limited steps:    %lu\n", (unsigned long)limited);
+    printf("Bytes:            %llu\n", (unsigned long long)bytes);
+    printf("Bytes per record: %.2f (vs %u for a raw double bias + int64_t word + uint32_t timestamp)\n",
+           decoded ? (double)bytes / (double)decoded : 0.0, (unsigned)(sizeof(double) + sizeof(int64_t) + sizeof(uint32_t)));
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return selfTest();
+
+    if (strcmp(argv[1], "-") == 0)
+        return decodeFile(stdin);
+
+    FILE *in = fopen(argv[1], "rb");
+    if (in == nullptr)
+    {
+        fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+    int result = decodeFile(in);
+    fclose(in);
+    return result;
+}
@@ -0,0 +1,281 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host trajectory test
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Trajectory.cpp
+
+    Description:
+    Compiles a calibration profile into a SfeSiT5811Trajectory at 100Hz with a 100ppb/s
+    slew limit and a 3.125ppm pull range: +1ppm step, ramps down to -2ppm and on towards
+    -5ppm (beyond the pull range), a five step sweep from -1ppm to +1ppm, then back to zero.
+
+    Part 1 checks the compiled table against the usual way of doing this: a loop which
+    works out each point with double math (target, pull range, slew limit) and calls
+    setFrequencyHz. Every word must match. It reports the points, the table size, the
+    compile time, the points limited by the pull range and by the slew limit, and the
+    largest change between points (which must not exceed the slew limit).
+
+    Part 2 plays the profile with a simulated clock and compares the CPU time per point
+    with the setFrequencyHz loop. Both write the same words through the same write path,
+    so the bus traffic is identical; the difference is the per-point math. On a host with
+    an FPU it is small. On AVR, where double is software floating point, it is not.
+
+    Part 3 plays a three second ramp in real time (10ms interval, CLOCK_MONOTONIC) from
+    main loops of different styles, and reports the writes, the skipped points and the
+    lateness of the writes: mean, standard deviation (jitter) and maximum. The maximum
+    includes the host scheduler.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Trajectory.cpp -o SiT5811_Trajectory
+    ./SiT5811_Trajectory
+
+*/
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Trajectory.h"
+
+static const uint32_t kIntervalMicros = 10000; // 100Hz
+static const double kSlewPPBPerSecond = 100.0;
+static const uint16_t kPoints = 12000; // 120 seconds at 100Hz: 60000 bytes
+static const unsigned kRepeats = 20; // For the timing
+
+// The profile, as steps ('S') and ramps ('R'). The sweep is expanded into steps
+typedef struct
+{
+    char kind;
+    double ppb;
+    double seconds;
+} segment_t;
+
+static const segment_t kProfile[] = {{'S', 1000.0, 20.0},  {'R', -2000.0, 40.0}, {'R', -5000.0, 10.0},
+                                     {'S', -1000.0, 5.0},  {'S', -500.0, 5.0},   {'S', 0.0, 5.0},
+                                     {'S', 500.0, 5.0},    {'S', 1000.0, 5.0},   {'S', 0.0, 15.0}};
+static const unsigned kSegments = sizeof(kProfile) / sizeof(kProfile[0]);
+
+static SfeSiT5811TrajectoryN<kPoints> theTrajectory;
+
+// The simulated time, for SfeSiT5811Trajectory::setClock
+static uint32_t simulatedMicros = 0;
+
+static uint32_t simulatedClock(void)
+{
+    return simulatedMicros;
+}
+
+static double nowNanos(void)
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static void beginDriver(SfeSiT5811RegisterFile &registers, SfeSiT5811Driver &ocxo)
+{
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    ocxo.begin(&registers);
+    ocxo.setBaseFrequencyHz(10000000.0);
+}
+
+static void compile(SfeSiT5811Driver &ocxo)
+{
+    theTrajectory.begin(&ocxo);
+    theTrajectory.setUpdateInterval(kIntervalMicros);
+    theTrajectory.setSlewLimit(kSlewPPBPerSecond);
+    theTrajectory.addStep(1000.0, 20.0);
+    theTrajectory.addRamp(-2000.0, 40.0);
+    theTrajectory.addRamp(-5000.0, 10.0);
+    theTrajectory.addSweep(-1000.0, 1000.0, 5, 5.0);
+    theTrajectory.addStep(0.0, 15.0);
+}
+
+// The setFrequencyHz loop: the per-point math, then the write. Returns the points written.
+// words (if not nullptr) returns each word written
+static uint32_t frequencyLoop(SfeSiT5811Driver &ocxo, std::vector<int64_t> *words)
+{
+    double base = ocxo.getBaseFrequencyHz();
+    double maxPPB = ocxo.getMaxPullAvailable() * 1.0e9;
+    double maxStep = kSlewPPBPerSecond * kIntervalMicros * 1.0e-6;
+    double target = 0.0;
+    double last = 0.0;
+    uint32_t written = 0;
+
+    for (unsigned s = 0; s < kSegments; s++)
+    {
+        uint32_t points = (uint32_t)floor((kProfile[s].seconds * 1.0e6 / kIntervalMicros) + 0.5);
+        double from = target;
+        for (uint32_t i = 1; i <= points; i++)
+        {
+            if (kProfile[s].kind == 'R')
+                target = from + ((kProfile[s].ppb - from) * (double)i / (double)points);
+            else
+                target = kProfile[s].ppb;
+
+            double ppb = target;
+            if (ppb > maxPPB)
+                ppb = maxPPB;
+            if (ppb < -maxPPB)
+                ppb = -maxPPB;
+            if (ppb > (last + maxStep))
+                ppb = last + maxStep;
+            else if (ppb < (last - maxStep))
+                ppb = last - maxStep;
+            last = ppb;
+
+            ocxo.setFrequencyHz(base + (base * ppb * 1.0e-9));
+            written++;
+            if (words != nullptr)
+                words->push_back(ocxo.getFrequencyControlWord());
+        }
+        target = kProfile[s].ppb;
+    }
+    return written;
+}
+
+// Part 1
+static void check(void)
+{
+    SfeSiT5811RegisterFile registers;
+    SfeSiT5811Driver ocxo;
+    beginDriver(registers, ocxo);
+
+    double start = nowNanos();
+    compile(ocxo);
+    double elapsed = nowNanos() - start;
+
+    std::vector<int64_t> words;
+    SfeSiT5811RegisterFile loopRegisters;
+    SfeSiT5811Driver loopOCXO;
+    beginDriver(loopRegisters, loopOCXO);
+    frequencyLoop(loopOCXO, &words);
+
+    uint32_t mismatches = (words.size() == theTrajectory.getLength()) ? 0 : 1;
+    double largestStep = 0.0;
+    double lastHz = ocxo.getFrequencyHz();
+    for (uint16_t i = 0; (i < theTrajectory.getLength()) && (i < words.size()); i++)
+    {
+        int64_t word = theTrajectory.getPoint(i);
+        if (word != words[i])
+            mismatches++;
+
+        ocxo.setFrequencyControlWord(word);
+        double hz = ocxo.getFrequencyHz();
+        double step = fabs(hz - lastHz) * 1.0e9 / ocxo.getBaseFrequencyHz();
+        if (step > largestStep)
+            largestStep = step;
+        lastHz = hz;
+    }
+
+    uint16_t length = theTrajectory.getLength();
+    printf("%-34s %10u\n", "points", (unsigned)length);
+    printf("%-34s %10.1f\n", "duration (s)", theTrajectory.getDurationSeconds());
+    printf("%-34s %10lu\n", "table bytes (5 per point)", (unsigned long)length * kSfeSiT5811TrajectoryWordBytes);
+    printf("%-34s %10lu\n", "as int64_t (8 per point)", (unsigned long)length * 8);
+    printf("%-34s %10.1f\n", "compile (ns per point)", elapsed / length);
+    printf("%-34s %10u\n", "limited by the pull range", (unsigned)theTrajectory.getClamped());
+    printf("%-34s %10u\n", "limited by the slew limit", (unsigned)theTrajectory.getSlewLimited());
+    printf("%-34s %10.4f\n", "largest step (ppb)", largestStep);
+    printf("%-34s %10.4f\n", "slew limit per point (ppb)", kSlewPPBPerSecond * kIntervalMicros * 1.0e-6);
+    printf("%-34s %10lu\n", "words differing from the loop", (unsigned long)mismatches);
+    printf("%-34s %10s\n", "table full", theTrajectory.isFull() ? "yes" : "no");
+}
+
+// Part 2
+static void cost(void)
+{
+    SfeSiT5811RegisterFile registers;
+    SfeSiT5811Driver ocxo;
+    beginDriver(registers, ocxo);
+    compile(ocxo);
+    theTrajectory.setClock(simulatedClock);
+
+    registers.resetCounters();
+    uint32_t points = 0;
+    double start = nowNanos();
+    for (unsigned r = 0; r < kRepeats; r++)
+    {
+        theTrajectory.start();
+        while (theTrajectory.update() == kSfeSiT5811TrajectoryRunning)
+            simulatedMicros += kIntervalMicros;
+        points += theTrajectory.getWrites();
+    }
+    double elapsed = nowNanos() - start;
+    printf("%-34s %10.1f %12.2f\n", "SfeSiT5811Trajectory::update", elapsed / points,
+           (double)registers.getTransactions() / points);
+
+    SfeSiT5811RegisterFile loopRegisters;
+    SfeSiT5811Driver loopOCXO;
+    beginDriver(loopRegisters, loopOCXO);
+    points = 0;
+    start = nowNanos();
+    for (unsigned r = 0; r < kRepeats; r++)
+        points += frequencyLoop(loopOCXO, nullptr);
+    elapsed = nowNanos() - start;
+    printf("%-34s %10.1f %12.2f\n", "math + setFrequencyHz", elapsed / points,
+           (double)loopRegisters.getTransactions() / points);
+
+    theTrajectory.setClock(nullptr);
+}
+
+// Part 3: sleepMaxMicros is the most work the main loop does between updates
+static void jitter(const char *name, uint32_t sleepMaxMicros)
+{
+    SfeSiT5811RegisterFile registers;
+    SfeSiT5811Driver ocxo;
+    beginDriver(registers, ocxo);
+
+    SfeSiT5811TrajectoryN<300> ramp; // Three seconds at 100Hz
+    ramp.begin(&ocxo);
+    ramp.setUpdateInterval(kIntervalMicros);
+    ramp.addRamp(500.0, 3.0);
+
+    srand(1);
+    ramp.start();
+    while (ramp.update() == kSfeSiT5811TrajectoryRunning)
+    {
+        if (sleepMaxMicros == 0)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(rand() % sleepMaxMicros));
+    }
+
+    printf("%-26s %8lu %8lu %11.1f %11.1f %11lu\n", name, (unsigned long)ramp.getWrites(),
+           (unsigned long)ramp.getSkipped(), ramp.getMeanLatenessMicros(), ramp.getJitterMicros(),
+           (unsigned long)ramp.getMaxLatenessMicros());
+}
+
+int main(void)
+{
+    printf("SparkFun SiT5811 frequency trajectory (%luHz updates, %.0fppb/s slew limit, 3.125ppm pull range)\n\n",
+           (unsigned long)(1000000 / kIntervalMicros), kSlewPPBPerSecond);
+
+    printf("Part 1: compiled profile\n");
+    check();
+
+    printf("\nPart 2: playback cost, %u runs of the profile\n", kRepeats);
+    printf("%-34s %10s %12s\n", "per point", "CPU (ns)", "transactions");
+    cost();
+
+    printf("\nPart 3: real-time playback of a 3s ramp, %lums interval\n", (unsigned long)(kIntervalMicros / 1000));
+    printf("%-26s %8s %8s %11s %11s %11s\n", "main loop", "writes", "skipped", "mean (us)", "jitter (us)",
+           "max (us)");
+    jitter("tight (yield)", 0);
+    jitter("work up to 1ms", 1000);
+    jitter("work up to 5ms", 5000);
+    jitter("work up to 25ms", 25000);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host warm-start comparison
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_WarmStart.cpp
+
+    Description:
+    Disciplines the simulated SiT5811 (SfeSiT5811Simulation) for a day, saves a
+    snapshot to a file (SfeSiT5811Storage), then power-cycles: the control word returns
+    to zero. The processor is running again after kBootEpochs, but the GNSS takes
+    kReacquireEpochs to provide a bias again. The loop starts either cold (seeded from
+    getFrequencyHz, as before: the OCXO free-runs until the GNSS is back) or warm (the
+    snapshot is restored at boot, so the OCXO is steered while the GNSS reacquires).
+    For each this reports:
+        The fractional frequency error when the GNSS is back
+        The time to re-lock (|time error| stays below 20ns)
+        The peak time error after the reboot
+    Finally it checks that a corrupted snapshot is rejected.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_WarmStart.cpp -o SiT5811_WarmStart
+    ./SiT5811_WarmStart [snapshot file]
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+#include "SparkFun_SiT5811_Snapshot.h"
+
+static const double kLockThresholdSeconds = 20.0e-9; // Locked when |time error| < 20ns
+static const uint32_t kRunEpochs = 86400; // One day at 1Hz before the reboot
+static const uint32_t kBootEpochs = 2; // The processor boots in two seconds
+static const uint32_t kReacquireEpochs = 60; // The GNSS is back after one minute
+static const uint32_t kAfterEpochs = 3600; // One hour after the reboot
+
+// Stores the snapshot in a file
+class FileStorage : public SfeSiT5811Storage
+{
+public:
+    FileStorage(const char *path) : _path{path}
+    {
+    }
+
+    bool read(uint8_t *data, size_t numBytes)
+    {
+        FILE *file = fopen(_path, "rb");
+        if (file == nullptr)
+            return false;
+        bool result = (fread(data, 1, numBytes, file) == numBytes);
+        fclose(file);
+        return result;
+    }
+
+    bool write(const uint8_t *data, size_t numBytes)
+    {
+        FILE *file = fopen(_path, "wb");
+        if (file == nullptr)
+            return false;
+        bool result = (fwrite(data, 1, numBytes, file) == numBytes);
+        fclose(file);
+        return result;
+    }
+
+private:
+    const char *_path;
+};
+
+// Run the day, save the snapshot, reboot and run for another hour, warm or cold
+static void run(const char *name, bool warm, FileStorage &storage)
+{
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1); // Same noise for both runs
+
+    {
+        SfeSiT5811Driver ocxo;
+        ocxo.begin(&registers);
+        ocxo.setMaxFrequencyChangePPB(3.0);
+
+        for (uint32_t e = 0; e < kRunEpochs; e++)
+            ocxo.setFrequencyByBiasMillis(simulation.step());
+
+        ocxo.saveSnapshot(&storage, simulation.getEpoch()); // The epoch is the timestamp (s)
+    }
+
+    // Power cycle: the control word returns to zero
+    registers.setRegister(kSfeSiT5811RegControlMSW, 0);
+    registers.setRegister(kSfeSiT5811RegControlNSW, 0);
+    registers.setRegister(kSfeSiT5811RegControlLSW, 0);
+    for (uint32_t e = 0; e < kBootEpochs; e++)
+        simulation.step();
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+    ocxo.setMaxFrequencyChangePPB(3.0);
+    bool restored = warm && ocxo.restoreSnapshot(&storage, simulation.getEpoch());
+
+    // No bias until the GNSS is back
+    double bias = 0.0;
+    for (uint32_t e = kBootEpochs; e < kReacquireEpochs; e++)
+        bias = simulation.step();
+    double reacquiredFrequencyError = simulation.getFractionalFrequency();
+
+    uint32_t lockEpoch = 0;
+    double peak = 0.0;
+    for (uint32_t e = 0; e < kAfterEpochs; e++)
+    {
+        ocxo.setFrequencyByBiasMillis(bias);
+        bias = simulation.step();
+
+        double timeError = fabs(simulation.getTimeErrorSeconds());
+        if (timeError >= kLockThresholdSeconds)
+            lockEpoch = e + 1;
+        if (timeError > peak)
+            peak = timeError;
+    }
+
+    printf("%-6s %9s %14.3f %10lu %12.1f\n", name, warm ? (restored ? "yes" : "FAILED") : "-", reacquiredFrequencyError * 1.0e9,
+           (unsigned long)lockEpoch, peak * 1.0e9);
+}
+
+int main(int argc, char **argv)
+{
+    FileStorage storage((argc > 1) ? argv[1] : "SiT5811_snapshot.bin");
+
+    printf("SparkFun SiT5811 warm start (%lu s run, power cycle, %lu s boot, %lu s GNSS reacquisition)\n\n",
+           (unsigned long)kRunEpochs, (unsigned long)kBootEpochs, (unsigned long)kReacquireEpochs);
+    printf("%-6s %9s %14s %10s %12s\n", "Start", "restored", "freq err (ppb)", "lock (s)", "peak (ns)");
+
+    run("cold", false, storage);
+    run("warm", true, storage);
+
+    // A corrupted snapshot must be rejected
+    uint8_t buffer[kSfeSiT5811SnapshotBytes];
+    sfe_SiT5811_snapshot_t snapshot;
+    storage.read(buffer, kSfeSiT5811SnapshotBytes);
+    bool valid = SfeSiT5811Snapshot::deserialize(buffer, kSfeSiT5811SnapshotBytes, snapshot);
+    printf("\nSnapshot: %s, integrator %+.3f ppb, drift %+.3e per second\n", valid ? "valid" : "INVALID",
+           (double)snapshot.integratorPPQ * 1.0e-6, (double)snapshot.driftMilliPPQ * 1.0e-18);
+    buffer[20] ^= 0x01;
+    valid = SfeSiT5811Snapshot::deserialize(buffer, kSfeSiT5811SnapshotBytes, snapshot);
+    printf("Snapshot with one bit flipped: %s\n", valid ? "ACCEPTED" : "rejected");
+
+    return 0;
+}
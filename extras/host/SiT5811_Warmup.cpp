@@ -0,0 +1,192 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library - host warm-up and readiness test
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SiT5811_Warmup.cpp
+
+    Description:
+    Part 1 checks the Chip ID in begin, for each startup mode, with the expected ID set to
+    the simulated part's ID, to a different ID, and not set. It reports the result and the
+    bus transactions.
+
+    Part 2 simulates the SiT5811 (SfeSiT5811Simulation) from a cold power-up: the oven heater
+    at full power for 90s, then settling, with a 500ppb warm-up frequency offset settling
+    with it. Two ovens: one settling with a 100s time constant, one with 400s. Disciplining
+    (setFrequencyByBiasMillis, default gains) starts after a fixed wait, or when
+    SfeSiT5811Warmup reports Ready. For each start it reports:
+        The start time, the warm-up offset left then and its rate of change
+        The power and the fitted power slope at the start
+        The lock time (|time error| stays below 20ns), from power-up
+        The RMS and peak time error from 10 minutes after the start to the end (3 hours)
+    A fixed wait is either too long for the fast oven or too short for the slow one.
+
+    Build and run (from the root of the library):
+    g++ -O2 -std=c++11 -Isrc src/SparkFun_SiT5811*.cpp extras/host/SiT5811_Warmup.cpp -o SiT5811_Warmup
+    ./SiT5811_Warmup
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_RegisterFile.h"
+#include "SparkFun_SiT5811_Simulation.h"
+#include "SparkFun_SiT5811_Warmup.h"
+
+static const uint16_t kChipID = 0x5811; // An example ID for the simulated part
+static const uint32_t kRunEpochs = 3 * 3600; // Three hours at 1Hz
+static const uint32_t kStatisticsAfter = 600; // Seconds after the start
+static const double kLockThresholdSeconds = 20.0e-9; // Locked when |time error| < 20ns
+
+// The simulated time, for SfeSiT5811Warmup::setClock
+static uint32_t simulatedMillis = 0;
+
+static uint32_t simulatedClock(void)
+{
+    return simulatedMillis;
+}
+
+// Part 1
+static void chipIDCheck(sfe_SiT5811_startup_t mode, const char *name, uint16_t expected)
+{
+    SfeSiT5811RegisterFile registers;
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+    params.chipID = kChipID;
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params);
+    simulation.step(); // Fill the Power Indicator
+
+    SfeSiT5811Driver ocxo;
+    ocxo.setExpectedChipID(expected);
+    registers.resetCounters();
+    bool result = ocxo.begin(&registers, mode);
+
+    char expectedText[16];
+    if (expected == kSfeSiT5811ChipIDAny)
+        snprintf(expectedText, sizeof(expectedText), "any");
+    else
+        snprintf(expectedText, sizeof(expectedText), "0x%04X", expected);
+
+    printf("%-10s %10s %8s %10lu %8.3f\n", name, expectedText, result ? "ok" : "FAIL",
+           (unsigned long)registers.getTransactions(), ocxo.getPowerFraction());
+}
+
+// Part 2: waitSeconds 0 uses SfeSiT5811Warmup
+static void warmup(double ovenTimeConstant, uint32_t waitSeconds)
+{
+    SfeSiT5811RegisterFile registers;
+    registers.setRegister(kSfeSiT5811RegClip, 0x0020); // 3.125ppm
+    sfe_SiT5811_sim_params_t params;
+    SfeSiT5811Simulation::getDefaultParameters(params);
+    params.ovenTimeConstantSeconds = ovenTimeConstant;
+    SfeSiT5811Simulation simulation(registers);
+    simulation.begin(params, 1); // Same noise for every run
+
+    SfeSiT5811Driver ocxo;
+    ocxo.begin(&registers);
+
+    simulatedMillis = 0;
+    SfeSiT5811Warmup monitor;
+    monitor.setClock(simulatedClock);
+    monitor.begin(&ocxo);
+
+    bool started = false;
+    uint32_t startEpoch = 0;
+    double offsetAtStart = 0.0;
+    double driftAtStart = 0.0;
+    double powerAtStart = 0.0;
+    double slopeAtStart = 0.0;
+    uint32_t lockEpoch = 0;
+    double peak = 0.0;
+    double sumTimeError2 = 0.0;
+    uint32_t count = 0;
+
+    double bias = simulation.step();
+    for (uint32_t e = 0; e < kRunEpochs; e++)
+    {
+        simulatedMillis = e * 1000;
+        monitor.update(); // Reads the Power Indicator each second, for the report
+
+        if (!started)
+        {
+            if (waitSeconds > 0)
+                started = (e >= waitSeconds);
+            else
+                started = monitor.isReady();
+            if (started)
+            {
+                startEpoch = e;
+                offsetAtStart = simulation.getWarmupFrequency();
+                driftAtStart = offsetAtStart * -60.0 / ovenTimeConstant; // Per minute
+                powerAtStart = monitor.getPower();
+                slopeAtStart = monitor.getSlopePerMinute();
+            }
+        }
+
+        if (started)
+            ocxo.setFrequencyByBiasMillis(bias);
+
+        bias = simulation.step();
+
+        double timeError = simulation.getTimeErrorSeconds();
+        if (!started || (fabs(timeError) >= kLockThresholdSeconds))
+            lockEpoch = e + 1;
+
+        if (started && (e >= (startEpoch + kStatisticsAfter)))
+        {
+            if (fabs(timeError) > peak)
+                peak = fabs(timeError);
+            sumTimeError2 += timeError * timeError;
+            count++;
+        }
+    }
+
+    char name[32];
+    if (waitSeconds > 0)
+        snprintf(name, sizeof(name), "wait %lus", (unsigned long)waitSeconds);
+    else
+        snprintf(name, sizeof(name), "SfeSiT5811Warmup");
+
+    printf("%-18s %8lu %10.2f %10.3f %8.3f %10.4f %9lu %11.2f %11.2f\n", name, (unsigned long)startEpoch,
+           offsetAtStart * 1.0e9, driftAtStart * 1.0e9, powerAtStart, slopeAtStart, (unsigned long)lockEpoch,
+           sqrt(sumTimeError2 / count) * 1.0e9, peak * 1.0e9);
+}
+
+int main(void)
+{
+    printf("SparkFun SiT5811 warm-up and readiness\n\n");
+
+    printf("Part 1: Chip ID check in begin (simulated Chip ID 0x%04X)\n", kChipID);
+    printf("%-10s %10s %8s %10s %8s\n", "mode", "expected", "begin", "transact.", "power");
+    const sfe_SiT5811_startup_t modes[] = {kSfeSiT5811StartupEmulator, kSfeSiT5811StartupMinimal,
+                                           kSfeSiT5811StartupVerified};
+    const char *modeNames[] = {"Emulator", "Minimal", "Verified"};
+    for (unsigned m = 0; m < 3; m++)
+    {
+        chipIDCheck(modes[m], modeNames[m], kSfeSiT5811ChipIDAny);
+        chipIDCheck(modes[m], modeNames[m], kChipID);
+        chipIDCheck(modes[m], modeNames[m], 0x1234);
+    }
+
+    const double ovens[] = {100.0, 400.0};
+    const uint32_t waits[] = {600, 1800, 0};
+    for (unsigned o = 0; o < sizeof(ovens) / sizeof(ovens[0]); o++)
+    {
+        printf("\nPart 2: cold start, oven 90s at full power then a %.0fs time constant, 500ppb warm-up offset\n",
+               ovens[o]);
+        printf("%-18s %8s %10s %10s %8s %10s %9s %11s %11s\n", "start after", "start(s)", "offset", "ppb/min",
+               "power", "slope/min", "lock (s)", "RMS TE(ns)", "peak TE(ns)");
+        for (unsigned w = 0; w < sizeof(waits) / sizeof(waits[0]); w++)
+            warmup(ovens[o], waits[w]);
+    }
+
+    return 0;
+}
@@ -19,14 +19,49 @@
 */
 
 #include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Clock.h"
 
 /// @brief Begin communication with the SiT5811. Read the registers.
-/// @return true if readRegisters is successful.
-bool SfeSiT5811Driver::begin()
+/// @param mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
+/// @return true if the device responded and the registers were read (or seeded)
+bool SfeSiT5811Driver::begin(sfe_SiT5811_startup_t mode)
 {
-    if (_theBus->ping() != kSTkErrOk)
+    if (_theBus == nullptr)
         return false;
 
+    if (mode == kSfeSiT5811StartupSeeded)
+        return true; // Use the values from seedRegisters. No transactions
+
+    if (!busPing())
+        return false;
+
+    if (mode == kSfeSiT5811StartupMinimal)
+        return readAllRegisters() && chipIDMatches();
+
+    if (mode == kSfeSiT5811StartupVerified)
+    {
+        // Read everything twice. The two reads must agree
+        if (!readAllRegisters())
+            return false;
+        uint16_t clip = _clip;
+        int64_t freq = _frequencyControl;
+        uint16_t chipID = _chipID;
+        if (!readAllRegisters())
+            return false;
+        return (clip == _clip) && (freq == _frequencyControl) && (chipID == _chipID) && chipIDMatches();
+    }
+
+    if (_expectedChipID != kSfeSiT5811ChipIDAny)
+    {
+        // Read the Chip ID twice - in case the user is using the emulator
+        if (!readChipID())
+            return false;
+        if (!readChipID())
+            return false;
+        if (!chipIDMatches())
+            return false;
+    }
+
     // Read the Clip register twice - in case the user is using the emulator
     // (This ensures the emulator registerAddress points at 0x00 correctly)
     if (readClipRegister())
@@ -39,19 +74,154 @@ bool SfeSiT5811Driver::begin()
     return false;
 }
 
+/// @brief Begin communication with the SiT5811 using the specified bus. Read the registers.
+/// @param theBus the bus the SiT5811 is attached to (e.g. a SfeSiT5811RegisterFile)
+/// @param mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
+/// @return true if the device responded and the registers were read (or seeded)
+bool SfeSiT5811Driver::begin(SfeSiT5811Bus *theBus, sfe_SiT5811_startup_t mode)
+{
+    setCommunicationBus(theBus);
+
+    return begin(mode);
+}
+
+/// @brief Set the driver's copies of the registers without reading them - for begin(kSfeSiT5811StartupSeeded)
+/// @param clip the 13-bit Clip register value
+/// @param freq the 39-bit frequency control word as int64_t (signed, two's complement)
+/// Note: the first control word write after seeding writes all three registers, in case the seed is stale.
+void SfeSiT5811Driver::seedRegisters(uint16_t clip, int64_t freq)
+{
+    sfe_SiT5811_reg_clip_t clipReg;
+    clipReg.word = clip;
+    _clip = clipReg.clip;
+
+    updateScaling(); // The available pull range has changed
+
+    _frequencyControl = freq;
+    _frequencyControlKnown = false; // Not read from the device
+}
+
 /// @brief Read the SiT5811 OCXO Clip register and update the driver's internal copy
 /// @return true if the read is successful
 bool SfeSiT5811Driver::readClipRegister(void)
 {
     uint8_t theBytes[2];
-    size_t readBytes;
 
     // Read 2 bytes, starting at address kSfeSiT5811RegClip (0x00)
-    if (_theBus->readRegisterRegion(kSfeSiT5811RegClip, (uint8_t *)&theBytes[0], 2, readBytes) != kSTkErrOk)
+    if (!busRead(kSfeSiT5811RegClip, theBytes, 2))
+        return false;
+
+    clipFromBytes(theBytes);
+
+    return true;
+}
+
+/// @brief Read the three SiT5811 frequency control registers and update the driver's internal copies
+/// @return true if the read is successful
+bool SfeSiT5811Driver::readRegisters(void)
+{
+    uint8_t theBytes[6];
+
+    // Read 6 bytes, starting at address kSfeSiT5811RegControlMSW (0x0C)
+    if (!busRead(kSfeSiT5811RegControlMSW, theBytes, 6))
+        return false;
+
+    controlWordFromBytes(theBytes);
+
+    return true;
+}
+
+/// @brief Read the Clip and the three frequency control registers in a single transaction
+/// @return true if the read is successful
+/// Note: this reads all fifteen registers (0x00 to 0x0E, 30 bytes). It is one transaction instead of two,
+///       and an absent device fails on the address byte, so it doubles as a presence check.
+///       The Power Indicator and Chip ID copies are updated too.
+bool SfeSiT5811Driver::readAllRegisters(void)
+{
+    const size_t numBytes = (kSfeSiT5811RegControlLSW + 1) * 2;
+    uint8_t theBytes[numBytes];
+
+    // Read 30 bytes, starting at address kSfeSiT5811RegClip (0x00)
+    if (!busRead(kSfeSiT5811RegClip, theBytes, numBytes))
+        return false;
+
+    clipFromBytes(&theBytes[kSfeSiT5811RegClip * 2]);
+    powerFromBytes(&theBytes[kSfeSiT5811RegPowerMSW * 2]);
+    _chipID = (((uint16_t)theBytes[kSfeSiT5811RegChipID * 2]) << 8) | ((uint16_t)theBytes[(kSfeSiT5811RegChipID * 2) + 1]);
+    controlWordFromBytes(&theBytes[kSfeSiT5811RegControlMSW * 2]);
+
+    return true;
+}
+
+/// @brief Read the two SiT5811 Power Indicator registers and update the driver's internal copy
+/// @return true if the read is successful
+bool SfeSiT5811Driver::readPowerIndicator(void)
+{
+    uint8_t theBytes[4];
+
+    // Read 4 bytes, starting at address kSfeSiT5811RegPowerMSW (0x01)
+    if (!busRead(kSfeSiT5811RegPowerMSW, theBytes, 4))
         return false;
-    if (readBytes != 2)
+
+    powerFromBytes(theBytes);
+
+    return true;
+}
+
+/// @brief Read the SiT5811 Chip ID register and update the driver's internal copy
+/// @return true if the read is successful
+bool SfeSiT5811Driver::readChipID(void)
+{
+    uint8_t theBytes[2];
+
+    // Read 2 bytes, starting at address kSfeSiT5811RegChipID (0x03)
+    if (!busRead(kSfeSiT5811RegChipID, theBytes, 2))
         return false;
 
+    _chipID = (((uint16_t)theBytes[0]) << 8) | ((uint16_t)theBytes[1]); // Chip ID - MSB first
+
+    return true;
+}
+
+/// @brief Get the 18-bit Power Indicator (oven PID output) - from the driver's internal copy
+/// @return The Power Indicator: 0 (heater off) to kSfeSiT5811PowerIndicatorMax (full power)
+uint32_t SfeSiT5811Driver::getPowerIndicator(void)
+{
+    return _powerIndicator;
+}
+
+/// @brief Get the Power Indicator as a fraction of full power - from the driver's internal copy
+/// @return The oven power: 0.0 to 1.0
+double SfeSiT5811Driver::getPowerFraction(void)
+{
+    return (double)_powerIndicator / (double)kSfeSiT5811PowerIndicatorMax;
+}
+
+/// @brief Get the 16-bit Chip ID - from the driver's internal copy
+/// @return The Chip ID
+uint16_t SfeSiT5811Driver::getChipID(void)
+{
+    return _chipID;
+}
+
+/// @brief Set the Chip ID which begin expects. begin fails if the Chip ID read is different
+/// @param id the Chip ID. kSfeSiT5811ChipIDAny (default): do not check
+void SfeSiT5811Driver::setExpectedChipID(uint16_t id)
+{
+    _expectedChipID = id;
+}
+
+/// @brief Get the Chip ID which begin expects
+/// @return The Chip ID. kSfeSiT5811ChipIDAny: not checked
+uint16_t SfeSiT5811Driver::getExpectedChipID(void)
+{
+    return _expectedChipID;
+}
+
+/// @brief  PRIVATE: Update the driver's copy of the Clip register
+/// @param  theBytes the two register bytes, MSB first
+void SfeSiT5811Driver::clipFromBytes(const uint8_t *theBytes)
+{
     // Extract the register contents - MSB first
     uint16_t register00 = (((uint16_t)theBytes[0]) << 8) | ((uint16_t)theBytes[1]); // OCXO Clip
 
@@ -60,25 +230,17 @@ bool SfeSiT5811Driver::readClipRegister(void)
     clipReg.word = register00;
     _clip = clipReg.clip;
 
-    return true;
+    updateScaling(); // The available pull range has changed
 }
 
-/// @brief Read the three SiT5811 frequency control registers and update the driver's internal copies
-/// @return true if the read is successful
-bool SfeSiT5811Driver::readRegisters(void)
+/// @brief  PRIVATE: Update the driver's copy of the frequency control word
+/// @param  theBytes the six register bytes (0x0C-0x0E), MSB first
+void SfeSiT5811Driver::controlWordFromBytes(const uint8_t *theBytes)
 {
-    uint8_t theBytes[6];
-    size_t readBytes;
     uint16_t register0C;
     uint16_t register0D;
     uint16_t register0E;
 
-    // Read 6 bytes, starting at address kSfeSiT5811RegControlMSW (0x0C)
-    if (_theBus->readRegisterRegion(kSfeSiT5811RegControlMSW, (uint8_t *)&theBytes[0], 6, readBytes) != kSTkErrOk)
-        return false;
-    if (readBytes != 6)
-        return false;
-
     // Extract the three 16-bit registers - MSB first
     register0C = (((uint16_t)theBytes[0]) << 8) | ((uint16_t)theBytes[1]); // Frequency Control MSW
     register0D = (((uint16_t)theBytes[2]) << 8) | ((uint16_t)theBytes[3]); // Frequency Control NSW
@@ -102,8 +264,32 @@ bool SfeSiT5811Driver::readRegisters(void)
         unsignedSigned64.unsigned64 |= 0xFFFFFFC000000000;
 
     _frequencyControl = unsignedSigned64.signed64; // Store the two's complement frequency control word
+    _frequencyControlKnown = true;
+}
 
-    return true;
+/// @brief  PRIVATE: Update the driver's copy of the Power Indicator
+/// @param  theBytes the four register bytes (0x01-0x02), MSB first
+void SfeSiT5811Driver::powerFromBytes(const uint8_t *theBytes)
+{
+    uint16_t register01;
+    uint16_t register02;
+
+    // Extract the two 16-bit registers - MSB first
+    register01 = (((uint16_t)theBytes[0]) << 8) | ((uint16_t)theBytes[1]); // Power Indicator MSW
+    register02 = (((uint16_t)theBytes[2]) << 8) | ((uint16_t)theBytes[3]); // Power Indicator LSW
+
+    // Extract the power bits from register02
+    sfe_SiT5811_reg_power_lsw_t powerLSW;
+    powerLSW.word = register02;
+
+    _powerIndicator = (((uint32_t)register01) << 2) | ((uint32_t)powerLSW.power);
+}
+
+/// @brief  PRIVATE: Check the Chip ID against the expected Chip ID
+/// @return true if it matches, or no Chip ID is expected
+bool SfeSiT5811Driver::chipIDMatches(void)
+{
+    return (_expectedChipID == kSfeSiT5811ChipIDAny) || (_chipID == _expectedChipID);
 }
 
 /// @brief Get the 39-bit frequency control word - from the driver's internal copy
@@ -116,29 +302,231 @@ int64_t SfeSiT5811Driver::getFrequencyControlWord(void)
 /// @brief Set the 39-bit frequency control word - and update the driver's internal copy
 /// @param freq the frequency control word as int64_t (signed, two's complement)
 /// @return true if the write is successful
+/// Note: by default, only the registers which change are written. If the word is unchanged,
+///       nothing is written. Call setFullWrites(true) to always write all three registers.
 bool SfeSiT5811Driver::setFrequencyControlWord(int64_t freq)
 {
-    uint8_t theBytes[6];
+    if (!_async)
+        return writeFrequencyControlWord(freq);
+
+    // Asynchronous mode: store the word. poll() will write it
+    if (_asyncPending)
+        _asyncCoalesced++; // The previous pending word will never be written
+    _asyncPendingWord = freq;
+    _asyncPending = true;
+    return true;
+}
 
-    union // Avoid any ambiguity when converting uint64_t to int64_t
+/// @brief Always write all three frequency control registers (glitch-sensitive applications)
+/// @param fullWrites true: always write 0x0C-0x0E; false: skip no-op writes and write only the registers which change
+void SfeSiT5811Driver::setFullWrites(bool fullWrites)
+{
+    _fullWrites = fullWrites;
+}
+
+/// @brief Get the full writes setting
+/// @return true if setFrequencyControlWord always writes all three registers
+bool SfeSiT5811Driver::getFullWrites(void)
+{
+    return _fullWrites;
+}
+
+/// @brief Get the number of register bytes written by the last setFrequencyControlWord
+/// @return 0 (write skipped or failed), 2, 4 or 6
+uint8_t SfeSiT5811Driver::getLastWriteBytes(void)
+{
+    return _lastWriteBytes;
+}
+
+/// @brief Enable or disable asynchronous mode
+/// @param async true to enable asynchronous mode
+/// @return true if any pending word was written successfully
+bool SfeSiT5811Driver::setAsyncMode(bool async)
+{
+    bool success = true;
+
+    if (async && !_async)
+        _asyncCoalesced = 0;
+
+    if (!async && _async)
     {
-        uint64_t unsigned64;
-        int64_t signed64;
-    } unsignedSigned64;
-    unsignedSigned64.signed64 = freq;
+        // Finish any write in progress, then write any pending word. Stop on the first failure
+        while (isAsyncBusy())
+        {
+            sfe_SiT5811_err_t result = poll();
+            if ((result != kSfeSiT5811ErrOk) && (result != kSfeSiT5811ErrBusy))
+            {
+                success = false;
+                break;
+            }
+        }
+
+        // Never leave a stale word behind for a later poll() to write
+        _asyncPending = false;
+    }
 
-    theBytes[0] = (uint8_t)((unsignedSigned64.unsigned64 >> 31) & 0xFF); // MSW MSB
-    theBytes[1] = (uint8_t)((unsignedSigned64.unsigned64 >> 23) & 0xFF); // MSW LSB
-    theBytes[2] = (uint8_t)((unsignedSigned64.unsigned64 >> 15) & 0xFF); // NSW MSB
-    theBytes[3] = (uint8_t)((unsignedSigned64.unsigned64 >> 7) & 0xFF); // NSW LSB
-    theBytes[4] = (uint8_t)((unsignedSigned64.unsigned64 << 1) & 0xFF); // LSW MSB
-    theBytes[5] = 0; // LSW LSB
+    _async = async;
+    return success;
+}
 
-    if (_theBus->writeRegisterRegion(kSfeSiT5811RegControlMSW, (const uint8_t *)&theBytes[0], 6) != kSTkErrOk)
-        return false; // Return false if the write failed
+/// @brief Get the asynchronous mode setting
+/// @return true if asynchronous mode is enabled
+bool SfeSiT5811Driver::getAsyncMode(void)
+{
+    return _async;
+}
 
-    _frequencyControl = freq; // Only update the driver's copy if the write was successful
-    return true;
+/// @brief Set the function to be called when an asynchronous write completes or fails
+/// @param callback the callback function. nullptr to disable
+/// @param context passed to the callback
+void SfeSiT5811Driver::setAsyncCallback(sfe_SiT5811_async_callback_t callback, void *context)
+{
+    _asyncCallback = callback;
+    _asyncContext = context;
+}
+
+/// @brief Advance the asynchronous write state machine. Call this regularly from loop()
+/// @return kSfeSiT5811ErrOk if idle (nothing pending), kSfeSiT5811ErrBusy if a write is in progress
+///         or pending, or the error if a write failed
+sfe_SiT5811_err_t SfeSiT5811Driver::poll(void)
+{
+    if (!_async)
+        return kSfeSiT5811ErrOk; // Nothing is ever pending in synchronous mode
+
+    sfe_SiT5811_err_t result;
+
+    // Check on the write in progress
+    if (_asyncInFlight)
+    {
+        result = _theBus->pollWrite();
+        if (result == kSfeSiT5811ErrBusy)
+            return kSfeSiT5811ErrBusy;
+
+        _asyncInFlight = false;
+        _instrumentation.record(kSfeSiT5811OpAsyncWrite, _asyncStartMicros, result, _asyncWriteBytes, false);
+        completeAsyncWrite(result);
+        if (result != kSfeSiT5811ErrOk)
+            return result;
+        return _asyncPending ? kSfeSiT5811ErrBusy : kSfeSiT5811ErrOk; // Start the next write on the next poll
+    }
+
+    if (!_asyncPending)
+        return kSfeSiT5811ErrOk;
+
+    // Start writing the pending word
+    _asyncPending = false;
+    _asyncWord = _asyncPendingWord;
+
+    uint8_t first;
+    uint8_t last;
+    controlWordSpan(_asyncWord, _asyncBytes, first, last);
+    _asyncWriteBytes = last - first;
+
+    if (first == last) // Nothing has changed
+    {
+        completeAsyncWrite(kSfeSiT5811ErrOk);
+        return kSfeSiT5811ErrOk;
+    }
+
+    _asyncStartMicros = _instrumentation.now();
+    result = _theBus->startWriteRegisterRegion(kSfeSiT5811RegControlMSW + (first / 2), (const uint8_t *)&_asyncBytes[first], last - first);
+
+    if (result == kSfeSiT5811ErrBusy)
+    {
+        _asyncInFlight = true;
+        return kSfeSiT5811ErrBusy;
+    }
+
+    _instrumentation.record(kSfeSiT5811OpAsyncWrite, _asyncStartMicros, result, _asyncWriteBytes, false);
+    completeAsyncWrite(result);
+    return result;
+}
+
+/// @brief Check if an asynchronous write is pending or in progress
+/// @return true if poll() still has work to do
+bool SfeSiT5811Driver::isAsyncBusy(void)
+{
+    return _asyncPending || _asyncInFlight;
+}
+
+/// @brief Check if an asynchronous write has been started on the bus and has not yet completed
+/// @return true if the bus is occupied by this driver's write
+bool SfeSiT5811Driver::isAsyncWriting(void)
+{
+    return _asyncInFlight;
+}
+
+/// @brief Get the pending control word - or the driver's copy if nothing is pending
+/// @return The 39-bit frequency control word as int64_t (signed, two's complement)
+int64_t SfeSiT5811Driver::getPendingFrequencyControlWord(void)
+{
+    if (_asyncPending)
+        return _asyncPendingWord;
+    if (_asyncInFlight)
+        return _asyncWord;
+    return _frequencyControl;
+}
+
+/// @brief Get the number of pending words which were replaced before they were written
+/// @return The number of coalesced updates since asynchronous mode was enabled
+uint32_t SfeSiT5811Driver::getAsyncCoalesced(void)
+{
+    return _asyncCoalesced;
+}
+
+/// @brief Get the default retry policy: one attempt (no retries), no deadline, no bus recovery
+/// @param policy returns the policy
+void SfeSiT5811Driver::getDefaultRetryPolicy(sfe_SiT5811_retry_t &policy)
+{
+    policy.attempts = 1;
+    policy.deadlineMicros = 0;
+    policy.attemptMicros = 0;
+    policy.recoverAfter = 0;
+}
+
+/// @brief Set the retry policy for the blocking bus transactions. Resets the retry counts
+/// @param policy the policy
+void SfeSiT5811Driver::setRetryPolicy(const sfe_SiT5811_retry_t &policy)
+{
+    _retryPolicy = policy;
+    if (_retryPolicy.attempts == 0)
+        _retryPolicy.attempts = 1; // Always try once
+
+    _retries = 0;
+    _busRecoveries = 0;
+    _deadlineAborts = 0;
+}
+
+/// @brief Get the retry policy
+/// @param policy returns the policy
+void SfeSiT5811Driver::getRetryPolicy(sfe_SiT5811_retry_t &policy)
+{
+    policy = _retryPolicy;
+}
+
+/// @brief Get the number of retries since setRetryPolicy
+uint32_t SfeSiT5811Driver::getRetries(void)
+{
+    return _retries;
+}
+
+/// @brief Get the number of bus recoveries since setRetryPolicy
+uint32_t SfeSiT5811Driver::getBusRecoveries(void)
+{
+    return _busRecoveries;
+}
+
+/// @brief Get the number of transactions abandoned because another attempt might not finish by the deadline
+uint32_t SfeSiT5811Driver::getDeadlineAborts(void)
+{
+    return _deadlineAborts;
+}
+
+/// @brief Set the function which provides the time for the retry deadline
+/// @param clock returns the time in microseconds. nullptr (default): micros() on Arduino, CLOCK_MONOTONIC on a host
+void SfeSiT5811Driver::setRetryClock(uint32_t (*clock)(void))
+{
+    _retryClock = clock;
 }
 
 /// @brief Get the 13-bit clip value - from the driver's internal copy
@@ -152,14 +540,14 @@ uint16_t SfeSiT5811Driver::getPullRangeClip(void)
 /// @return The clip value converted to maximum pull available (double)
 double SfeSiT5811Driver::getMaxPullAvailable(void)
 {
-    // If the DCXO_Clip value is 0, the DCOCXO pull range is ±800 ppm
-    if (_clip == 0)
-        return _maxPullRange;
+    return _maxPullAvailable; // Cached by updateScaling
+}
 
-    double clip = _clip; // Convert _clip to double
-    clip /= pow(2, 13); // Convert to fraction of 2^13
-    clip *= _maxPullRange; // Convert to maximum pull range
-    return clip;
+/// @brief Get the clip value - from the driver's internal copy. Convert to maximum pull available in PPQ
+/// @return The maximum pull available in parts per quadrillion (1e-15)
+int64_t SfeSiT5811Driver::getMaxPullAvailablePPQ(void)
+{
+    return _maxPullAvailablePPQ; // Cached by updateScaling
 }
 
 /// @brief Get the base oscillator frequency - from the driver's internal copy
@@ -174,6 +562,8 @@ double SfeSiT5811Driver::getBaseFrequencyHz(void)
 void SfeSiT5811Driver::setBaseFrequencyHz(double freq)
 {
     _baseFrequencyHz = freq;
+
+    updateScaling(); // The Hz scale factors have changed
 }
 
 /// @brief Get the oscillator frequency based on the base frequency and control word
@@ -182,12 +572,11 @@ double SfeSiT5811Driver::getFrequencyHz(void)
 {
     double freqControl = (double)_frequencyControl; // Convert signed to double
 
+    double freqOffsetHz;
     if (freqControl >= 0.0)
-        freqControl /= pow(2, 38) - 1.; // Scale 0.0 to 1.0
+        freqOffsetHz = freqControl * _hzPerLsbPositive; // Scale 0.0 to 1.0 of the maximum pull range
     else
-        freqControl /= pow(2, 38); // Scale 0.0 to -1.0
-
-    double freqOffsetHz = _baseFrequencyHz * freqControl * _maxPullRange;
+        freqOffsetHz = freqControl * _hzPerLsbNegative; // Scale 0.0 to -1.0 of the maximum pull range
 
     double freqHz = _baseFrequencyHz + freqOffsetHz;
 
@@ -202,54 +591,102 @@ double SfeSiT5811Driver::getFrequencyHz(void)
 /// Note: setFrequencyHz ignores _maxFrequencyChangePPB.
 bool SfeSiT5811Driver::setFrequencyHz(double freq)
 {
-    // Calculate the frequency offset from the base frequency
-    double freqOffsetHz = freq - _baseFrequencyHz;
+    return setFrequencyControlWord(hzToControlWord(freq, true));
+}
 
-    // Calculate the maximum frequency offset in Hz, based on the maximum pull range
-    double maxPullHz = _baseFrequencyHz * _maxPullRange;
+/// @brief Convert a frequency to the control word setFrequencyHz would write - no bus access
+/// @param freq the oscillator frequency in Hz
+/// @return The 39-bit frequency control word, limited to the pull range
+/// Note: the clamps are not counted by the instrumentation. Only setFrequencyHz counts them.
+int64_t SfeSiT5811Driver::getControlWordForHz(double freq)
+{
+    return hzToControlWord(freq, false);
+}
 
-    // Calculate the maximum frequency offset in Hz, based on the available pull range
-    double maxPullClippedHz = _baseFrequencyHz * getMaxPullAvailable();
+/// @brief  PRIVATE: Convert a frequency to a control word, limited to the pull range
+/// @param  freq the oscillator frequency in Hz
+/// @param  countClamps true: count the clamps in the instrumentation
+/// @return The 39-bit frequency control word
+int64_t SfeSiT5811Driver::hzToControlWord(double freq, bool countClamps)
+{
+    // Calculate the frequency offset from the base frequency
+    double freqOffsetHz = freq - _baseFrequencyHz;
 
-    // Limit freqOffsetHz to maxPullClippedHz
+    // Limit freqOffsetHz to the available pull range
+    double freqControl;
     if (freqOffsetHz >= 0.0)
     {
-        if (freqOffsetHz > maxPullClippedHz)
-            freqOffsetHz = maxPullClippedHz;
+        if (freqOffsetHz > _maxPullClippedHz)
+        {
+            freqOffsetHz = _maxPullClippedHz;
+            if (countClamps)
+                _instrumentation.countPullClamp();
+        }
+
+        freqControl = freqOffsetHz * _lsbPerHzPositive;
     }
     else
     {
-        if (freqOffsetHz < (0.0 - maxPullClippedHz))
-            freqOffsetHz = 0.0 - maxPullClippedHz;
+        if (freqOffsetHz < (0.0 - _maxPullClippedHz))
+        {
+            freqOffsetHz = 0.0 - _maxPullClippedHz;
+            if (countClamps)
+                _instrumentation.countPullClamp();
+        }
+
+        freqControl = freqOffsetHz * _lsbPerHzNegative;
     }
 
-    double freqControl = freqOffsetHz / maxPullHz;
+    int64_t freqControlInt = (int64_t)freqControl;
 
-    if (freqControl >= 0.0)
+    // Just in case, ensure freqControlInt is limited to 2^38 (39-bits signed)
+    if (freqControlInt > kSfeSiT5811ControlWordMax)
     {
-        if (freqControl > 1.0)
-            freqControl = 1.0;
-
-        freqControl *= pow(2, 38) - 1;
+        freqControlInt = kSfeSiT5811ControlWordMax;
+        if (countClamps)
+            _instrumentation.countWordClamp();
     }
-    else
-    {
-        if (freqControl < -1.0)
-            freqControl = -1.0;
 
-        freqControl *= pow(2, 38);
+    if (freqControlInt < kSfeSiT5811ControlWordMin)
+    {
+        freqControlInt = kSfeSiT5811ControlWordMin;
+        if (countClamps)
+            _instrumentation.countWordClamp();
     }
 
-    int64_t freqControlInt = (int64_t)freqControl;
+    return freqControlInt;
+}
 
-    // Just in case, ensure freqControlInt is limited to 2^38 (39-bits signed)
-    if (freqControlInt > 274877906943)
-        freqControlInt = 274877906943;
+/// @brief Get the fractional frequency offset defined by the control word - integer math only
+/// @return The frequency offset in parts per quadrillion (1e-15), rounded to nearest
+/// Note: the integer path uses the symmetric 2^38 scale. At positive full scale it differs
+///       from getFrequencyHz by up to 1 LSB.
+int64_t SfeSiT5811Driver::getFrequencyOffsetPPQ(void)
+{
+    return controlWordToPPQ(_frequencyControl);
+}
 
-    if (freqControlInt < -274877906944)
-        freqControlInt = -274877906944;
+/// @brief Set the fractional frequency offset - integer math only
+/// @param ppq the frequency offset in parts per quadrillion (1e-15)
+/// @return true if the write is successful
+/// Note: The offset will be limited by the pull range capabilities of the device.
+///       The control word is rounded to nearest, so every control word round-trips exactly
+///       through getFrequencyOffsetPPQ and setFrequencyOffsetPPQ.
+bool SfeSiT5811Driver::setFrequencyOffsetPPQ(int64_t ppq)
+{
+    // Limit ppq to the available pull range
+    if (ppq > _maxPullAvailablePPQ)
+    {
+        ppq = _maxPullAvailablePPQ;
+        _instrumentation.countPullClamp();
+    }
+    if (ppq < (0 - _maxPullAvailablePPQ))
+    {
+        ppq = 0 - _maxPullAvailablePPQ;
+        _instrumentation.countPullClamp();
+    }
 
-    return setFrequencyControlWord(freqControlInt);
+    return setFrequencyControlWord(ppqToControlWord(ppq));
 }
 
 /// @brief Get the maximum frequency change in PPB
@@ -264,6 +701,8 @@ double SfeSiT5811Driver::getMaxFrequencyChangePPB(void)
 void SfeSiT5811Driver::setMaxFrequencyChangePPB(double ppb)
 {
     _maxFrequencyChangePPB = ppb;
+
+    _discipline.setLimits(_baseFrequencyHz, _maxPullClippedHz, _maxFrequencyChangePPB);
 }
 
 /// @brief Set the frequency according to the GNSS receiver clock bias in milliseconds
@@ -274,52 +713,560 @@ void SfeSiT5811Driver::setMaxFrequencyChangePPB(double ppb)
 /// Note: the frequency change will be limited by: the pull range capabilities of the device;
 ///       and the setMaxFrequencyChangePPB. Call getFrequencyHz to read the frequency set.
 /// The default values for Pk and Ik come from very approximate Ziegler-Nichols tuning:
-/// oscillation starts when Pk is TODO; with a period of TODO seconds.
+/// with one update of delay, oscillation starts when Pk is 2; with a period of 2 seconds.
+/// (Ziegler-Nichols proper gives Pk = 0.9, Ik = 0.54. The defaults are gentler, close to Tyreus-Luyben.)
+/// SfeSiT5811AutoTune measures the gain and period on your own hardware and proposes Pk and Ik.
+/// Note: the integrator is held per driver, in getDiscipline(). It is seeded from getFrequencyHz
+///       on the first call. Call reseedDiscipline after changing the frequency by other means.
 bool SfeSiT5811Driver::setFrequencyByBiasMillis(double bias, double Pk, double Ik)
 {
-    double freq = getFrequencyHz();
+    if (_stability != nullptr)
+        _stability->addBiasMillis(bias);
 
-    static double I;
-    static bool initialized = false;
-    if (!initialized)
+    if ((_holdover != nullptr) && _holdover->isActive())
     {
-        I = freq; // Initialize I with the current frequency for a more reasonable startup
-        initialized = true;
+        // The bias is back. Continue from the frequency holdover predicted, not the stale integrator.
+        // Keep the learned drift
+        _holdover->end();
+        reseedDiscipline();
     }
 
-    double clockInterval_s = 1.0 / freq; // Convert freq to interval in seconds
+    if (!_discipline.isSeeded())
+        _discipline.seed(getFrequencyHz()); // Initialize I with the current frequency for a more reasonable startup
+
+    _discipline.setGains(Pk, Ik);
+
+    uint32_t slewLimited = _discipline.getSlewLimited();
+    uint32_t pullLimited = _discipline.getPullLimited();
+
+    // Steer with the filtered bias. The telemetry logs the raw bias
+    double steeringBias = (_filter != nullptr) ? _filter->filter(bias) : bias;
+
+    _lastWriteStatus = kSfeSiT5811ErrOk;
+    bool result = setFrequencyHz(_discipline.update(steeringBias)); // Set the frequency to proportional plus integral
+
+    if (_holdover != nullptr)
+        _holdover->learn(getPendingFrequencyControlWord(), steeringBias);
+
+    if (_telemetry == nullptr)
+        return result;
+
+    uint8_t flags = 0;
+    if (_discipline.getSlewLimited() != slewLimited)
+        flags |= kSfeSiT5811TelemetryFlagSlewLimited;
+    if (_discipline.getPullLimited() != pullLimited)
+        flags |= kSfeSiT5811TelemetryFlagPullLimited;
+    if ((_filter != nullptr) && _filter->isRejected())
+        flags |= kSfeSiT5811TelemetryFlagRejected;
+
+    sfe_SiT5811_err_t busStatus = kSfeSiT5811ErrOk;
+    if (!result)
+        busStatus = (_lastWriteStatus != kSfeSiT5811ErrOk) ? _lastWriteStatus : kSfeSiT5811ErrFail;
+
+    // In asynchronous mode, log the word which will be written
+    _telemetry->log(bias, getPendingFrequencyControlWord(), flags, busStatus);
+
+    return result;
+}
+
+/// @brief Get the clock discipline controller used by setFrequencyByBiasMillis
+/// @return A reference to this driver's controller
+SfeSiT5811Discipline &SfeSiT5811Driver::getDiscipline(void)
+{
+    return _discipline;
+}
+
+/// @brief Reset the clock discipline controller and seed it from the current frequency
+/// A cold start: the learned drift and the limit counters are cleared too
+void SfeSiT5811Driver::resetDiscipline(void)
+{
+    _discipline.reset();
+    _discipline.seed(getFrequencyHz());
+}
+
+/// @brief Seed the clock discipline controller from the current frequency
+/// Keep the learned drift and the limit counters - e.g. after holdover or tuning
+void SfeSiT5811Driver::reseedDiscipline(void)
+{
+    _discipline.seed(getFrequencyHz());
+}
+
+/// @brief Select the steering law used by setFrequencyByBiasMillis
+/// @param mode kSfeSiT5811SteeringPI (default), kSfeSiT5811SteeringKalman2 or kSfeSiT5811SteeringKalman3
+/// @param kalman the filter for the Kalman modes, e.g. a SfeSiT5811Kalman declared alongside the driver.
+///        Without one, the steering law is PI
+/// Note: the Kalman modes ignore Pk and Ik. Configure the noise on the filter itself
+void SfeSiT5811Driver::setSteeringMode(sfe_SiT5811_steering_t mode, SfeSiT5811Kalman *kalman)
+{
+    _discipline.setSteeringMode(mode, kalman);
+}
+
+/// @brief Get the steering law used by setFrequencyByBiasMillis
+sfe_SiT5811_steering_t SfeSiT5811Driver::getSteeringMode(void)
+{
+    return _discipline.getSteeringMode();
+}
+
+/// @brief Attach a stability estimator. setFrequencyByBiasMillis will add each bias to it
+/// @param stability the estimator, e.g. a SfeSiT5811StabilityN<6>. nullptr to detach
+void SfeSiT5811Driver::setStabilityEstimator(SfeSiT5811Stability *stability)
+{
+    _stability = stability;
+}
+
+/// @brief Get the attached stability estimator - to query ADEV, TDEV and MTIE
+/// @return the estimator, or nullptr if none is attached
+SfeSiT5811Stability *SfeSiT5811Driver::getStabilityEstimator(void)
+{
+    return _stability;
+}
+
+// Round to the nearest integer
+static int64_t roundToInt64(double value)
+{
+    return (int64_t)((value >= 0.0) ? (value + 0.5) : (value - 0.5));
+}
+
+/// @brief Capture the steering state
+/// @param snapshot returns the snapshot
+/// @param timestamp the time now in seconds (any epoch: GNSS, Unix, RTC). Zero if unknown
+void SfeSiT5811Driver::getSnapshot(sfe_SiT5811_snapshot_t &snapshot, uint32_t timestamp)
+{
+    double integratorHz = _discipline.isSeeded() ? _discipline.getIntegratorHz() : getFrequencyHz();
+
+    snapshot.timestamp = timestamp;
+    snapshot.clip = _clip;
+    snapshot.integratorPPQ = roundToInt64(((integratorHz - _baseFrequencyHz) / _baseFrequencyHz) * 1.0e15);
+    snapshot.driftMilliPPQ = roundToInt64((_discipline.getDriftHz() / _baseFrequencyHz) * 1.0e18);
+    snapshot.baseFrequencyMilliHz = (uint64_t)roundToInt64(_baseFrequencyHz * 1000.0);
+}
+
+/// @brief Capture the steering state and write it to non-volatile storage
+/// @param storage the storage, e.g. EEPROM or a file
+/// @param timestamp the time now in seconds (any epoch: GNSS, Unix, RTC). Zero if unknown
+/// @return true if the write is successful
+bool SfeSiT5811Driver::saveSnapshot(SfeSiT5811Storage *storage, uint32_t timestamp)
+{
+    if (storage == nullptr)
+        return false;
+
+    sfe_SiT5811_snapshot_t snapshot;
+    getSnapshot(snapshot, timestamp);
+
+    uint8_t buffer[kSfeSiT5811SnapshotBytes];
+    SfeSiT5811Snapshot::serialize(snapshot, buffer);
+
+    return storage->write(buffer, kSfeSiT5811SnapshotBytes);
+}
+
+/// @brief Restore the steering state: seed the discipline and set the frequency
+/// @param snapshot the snapshot
+/// @param now the time now in seconds, in the same epoch as the snapshot timestamp. Zero if unknown
+/// @return true if the snapshot matches this oscillator (base frequency and clip) and the write is successful
+/// Note: if both now and the snapshot timestamp are known, the integrator is extrapolated by the learned
+///       drift over the time since the snapshot, assuming one update per second.
+bool SfeSiT5811Driver::restoreSnapshot(const sfe_SiT5811_snapshot_t &snapshot, uint32_t now)
+{
+    // The snapshot must be for this oscillator
+    if (snapshot.baseFrequencyMilliHz != (uint64_t)roundToInt64(_baseFrequencyHz * 1000.0))
+        return false;
+    if (snapshot.clip != _clip)
+        return false;
+
+    double offsetPPQ = (double)snapshot.integratorPPQ;
+    double driftPPQ = (double)snapshot.driftMilliPPQ * 1.0e-3;
+    if ((now != 0) && (snapshot.timestamp != 0) && (now > snapshot.timestamp))
+        offsetPPQ += driftPPQ * (double)(now - snapshot.timestamp);
+
+    _discipline.restore(_baseFrequencyHz + (_baseFrequencyHz * offsetPPQ * 1.0e-15), _baseFrequencyHz * driftPPQ * 1.0e-15);
+
+    return setFrequencyHz(_discipline.getOutputHz());
+}
+
+/// @brief Read the steering state from non-volatile storage and restore it
+/// @param storage the storage, e.g. EEPROM or a file
+/// @param now the time now in seconds, in the same epoch as the snapshot timestamp. Zero if unknown
+/// @return true if a valid snapshot for this oscillator was read and restored.
+///         false if there is no snapshot or it is corrupt: the discipline then starts cold
+bool SfeSiT5811Driver::restoreSnapshot(SfeSiT5811Storage *storage, uint32_t now)
+{
+    if (storage == nullptr)
+        return false;
+
+    uint8_t buffer[kSfeSiT5811SnapshotBytes];
+    if (!storage->read(buffer, kSfeSiT5811SnapshotBytes))
+        return false;
+
+    sfe_SiT5811_snapshot_t snapshot;
+    if (!SfeSiT5811Snapshot::deserialize(buffer, kSfeSiT5811SnapshotBytes, snapshot))
+        return false;
+
+    return restoreSnapshot(snapshot, now);
+}
+
+/// @brief Get the bus instrumentation: transaction, byte, failure and short read counts, latency histograms and clamp counts
+/// @return A reference to this driver's instrumentation. All getters return zero if SFE_SIT5811_INSTRUMENTATION is 0
+SfeSiT5811Instrumentation &SfeSiT5811Driver::getInstrumentation(void)
+{
+    return _instrumentation;
+}
+
+/// @brief Attach a telemetry buffer. setFrequencyByBiasMillis will log each step to it
+/// @param telemetry the buffer, e.g. a SfeSiT5811TelemetryN<512>. nullptr to detach
+void SfeSiT5811Driver::setTelemetry(SfeSiT5811Telemetry *telemetry)
+{
+    _telemetry = telemetry;
+}
+
+/// @brief Get the attached telemetry buffer - to drain it
+/// @return the buffer, or nullptr if none is attached
+SfeSiT5811Telemetry *SfeSiT5811Driver::getTelemetry(void)
+{
+    return _telemetry;
+}
+
+/// @brief Attach a holdover engine. setFrequencyByBiasMillis will add each control word to its fit,
+///        and end holdover when the bias returns. Call its update() to steer when the bias stops
+/// @param holdover the holdover engine. nullptr to detach
+void SfeSiT5811Driver::setHoldover(SfeSiT5811Holdover *holdover)
+{
+    if (_holdover != nullptr)
+        _holdover->attach(nullptr);
+
+    _holdover = holdover;
+
+    if (_holdover != nullptr)
+        _holdover->attach(this);
+}
+
+/// @brief Get the attached holdover engine
+/// @return the holdover engine, or nullptr if none is attached
+SfeSiT5811Holdover *SfeSiT5811Driver::getHoldover(void)
+{
+    return _holdover;
+}
+
+/// @brief Attach a bias pre-filter. setFrequencyByBiasMillis will filter each bias before steering with it
+/// @param filter the filter, e.g. a SfeSiT5811FilterN<9>. nullptr to detach
+/// Note: the stability estimator and the telemetry still see the raw bias. A rejected bias is logged
+///       with kSfeSiT5811TelemetryFlagRejected
+void SfeSiT5811Driver::setFilter(SfeSiT5811Filter *filter)
+{
+    _filter = filter;
+}
+
+/// @brief Get the attached bias pre-filter - to read its rejection counts
+/// @return the filter, or nullptr if none is attached
+SfeSiT5811Filter *SfeSiT5811Driver::getFilter(void)
+{
+    return _filter;
+}
+
+// 2^88 / 5^11 - converts PPQ to control word LSBs in Q64 fixed point (2^24 / 5^11 = 0.34 LSB per PPQ)
+const uint64_t kPpqToControlWordQ64 = 0x57F5FF85E592557F;
+
+// Return ((a * b) + 2^63) >> 64: the high half of a 64x64-bit product, rounded.
+// Uses 32-bit limbs so it works on every target (no __int128).
+static uint64_t mulHighRounded(uint64_t a, uint64_t b)
+{
+    uint64_t aLo = a & 0xFFFFFFFF;
+    uint64_t aHi = a >> 32;
+    uint64_t bLo = b & 0xFFFFFFFF;
+    uint64_t bHi = b >> 32;
 
-    // Our setpoint is zero. Bias is the process value. Convert it to error
-    double error = 0.0 - bias;
+    uint64_t loLo = aLo * bLo;
+    uint64_t hiLo = aHi * bLo;
+    uint64_t loHi = aLo * bHi;
+    uint64_t hiHi = aHi * bHi;
 
-    double errorInClocks = error / 1000.0; // Convert error from millis to seconds
-    errorInClocks /= clockInterval_s; // Convert error to clock cycles
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi; // Cannot overflow
+    uint64_t lo = (cross << 32) | (loLo & 0xFFFFFFFF);
+    uint64_t hi = hiHi + (hiLo >> 32) + (cross >> 32);
 
-    // Calculate the maximum frequency change in clock cycles
-    double maxChangeInClocks = freq * _maxFrequencyChangePPB * 1.0e-9;
+    if ((lo & 0x8000000000000000) != 0) // Round
+        hi++;
 
-    // Limit errorInClocks to +/-maxChangeInClocks
-    if (errorInClocks >= 0.0)
+    return hi;
+}
+
+/// @brief  PROTECTED: Convert a frequency offset in PPQ to a control word, rounded to nearest and limited to 39 bits
+/// @param  ppq the frequency offset in parts per quadrillion (1e-15)
+/// @return the 39-bit frequency control word
+int64_t SfeSiT5811Driver::ppqToControlWord(int64_t ppq)
+{
+    uint64_t magnitude = (ppq < 0) ? (uint64_t)(0 - ppq) : (uint64_t)ppq;
+
+    uint64_t word = mulHighRounded(magnitude, kPpqToControlWordQ64);
+
+    if (ppq < 0)
+    {
+        if (word > (uint64_t)(0 - kSfeSiT5811ControlWordMin))
+            word = (uint64_t)(0 - kSfeSiT5811ControlWordMin);
+        return 0 - (int64_t)word;
+    }
+
+    if (word > (uint64_t)kSfeSiT5811ControlWordMax)
+        word = (uint64_t)kSfeSiT5811ControlWordMax;
+    return (int64_t)word;
+}
+
+/// @brief  PROTECTED: Convert a control word to a frequency offset in PPQ, rounded to nearest
+/// @param  freq the 39-bit frequency control word
+/// @return the frequency offset in parts per quadrillion (1e-15)
+int64_t SfeSiT5811Driver::controlWordToPPQ(int64_t freq)
+{
+    uint64_t magnitude = (freq < 0) ? (uint64_t)(0 - freq) : (uint64_t)freq;
+
+    // PPQ = word * 5^11 / 2^24. |word| <= 2^38 so the product fits in 64 bits
+    uint64_t ppq = ((magnitude * 48828125) + 0x800000) >> 24;
+
+    return (freq < 0) ? (0 - (int64_t)ppq) : (int64_t)ppq;
+}
+
+/// @brief  PRIVATE: Convert the control word to the six register bytes (0x0C-0x0E, MSB first)
+/// @param  freq the frequency control word as int64_t (signed, two's complement)
+/// @param  theBytes the six register bytes
+void SfeSiT5811Driver::controlWordToBytes(int64_t freq, uint8_t *theBytes)
+{
+    union // Avoid any ambiguity when converting uint64_t to int64_t
+    {
+        uint64_t unsigned64;
+        int64_t signed64;
+    } unsignedSigned64;
+    unsignedSigned64.signed64 = freq;
+
+    theBytes[0] = (uint8_t)((unsignedSigned64.unsigned64 >> 31) & 0xFF); // MSW MSB
+    theBytes[1] = (uint8_t)((unsignedSigned64.unsigned64 >> 23) & 0xFF); // MSW LSB
+    theBytes[2] = (uint8_t)((unsignedSigned64.unsigned64 >> 15) & 0xFF); // NSW MSB
+    theBytes[3] = (uint8_t)((unsignedSigned64.unsigned64 >> 7) & 0xFF); // NSW LSB
+    theBytes[4] = (uint8_t)((unsignedSigned64.unsigned64 << 1) & 0xFF); // LSW MSB
+    theBytes[5] = 0; // LSW LSB
+}
+
+/// @brief  PRIVATE: Convert the control word to register bytes and find the span of bytes which need to be written
+/// @param  freq the frequency control word as int64_t (signed, two's complement)
+/// @param  theBytes the six register bytes
+/// @param  first returns the first byte to write
+/// @param  last returns one past the last byte to write. first == last if nothing needs to be written
+void SfeSiT5811Driver::controlWordSpan(int64_t freq, uint8_t *theBytes, uint8_t &first, uint8_t &last)
+{
+    controlWordToBytes(freq, theBytes);
+
+    first = 0;
+    last = 6;
+
+    // Only elide if the driver's copy is known to match the device
+    if (_fullWrites || !_frequencyControlKnown)
+        return;
+
+    uint8_t currentBytes[6];
+    controlWordToBytes(_frequencyControl, currentBytes);
+
+    // Skip the unchanged registers at the start and end. Registers are 16-bit, so step by 2
+    while ((first < last) && (theBytes[first] == currentBytes[first]) && (theBytes[first + 1] == currentBytes[first + 1]))
+        first += 2;
+    while ((last > first) && (theBytes[last - 2] == currentBytes[last - 2]) && (theBytes[last - 1] == currentBytes[last - 1]))
+        last -= 2;
+}
+
+/// @brief  PRIVATE: Wait for an asynchronous write which is in progress on the bus to complete
+/// Note: a blocking transaction must not start while the bus is busy with the write, and the read
+///       must not be overtaken by the write's completion. A pending word which has not been started
+///       stays pending: poll() writes it as usual
+void SfeSiT5811Driver::finishAsyncWrite(void)
+{
+    while (_asyncInFlight)
+        poll(); // The bus's pollWrite completes or fails the write, e.g. on its timeout
+}
+
+/// @brief  PRIVATE: Ping the device - with the retry policy
+/// @return true if the device responded
+bool SfeSiT5811Driver::busPing(void)
+{
+    finishAsyncWrite(); // One transaction at a time
+
+    uint32_t callStart = (_retryPolicy.deadlineMicros > 0) ? sfeSiT5811Micros(_retryClock) : 0;
+    uint8_t failures = 0;
+
+    while (true)
     {
-        if (errorInClocks > maxChangeInClocks)
-            errorInClocks = maxChangeInClocks;
+        uint32_t start = _instrumentation.now();
+        sfe_SiT5811_err_t result = _theBus->ping();
+        _instrumentation.record(kSfeSiT5811OpPing, start, result, 0, false);
+        if (result == kSfeSiT5811ErrOk)
+            return true;
+
+        if (!retryAfterFailure(callStart, ++failures))
+            return false;
+    }
+}
+
+/// @brief  PRIVATE: Read a register region - with the retry policy
+/// @param  reg the register address
+/// @param  data returns the bytes
+/// @param  numBytes the number of bytes to read. Fewer is a failure
+/// @return true if all the bytes were read
+bool SfeSiT5811Driver::busRead(uint8_t reg, uint8_t *data, size_t numBytes)
+{
+    finishAsyncWrite(); // One transaction at a time
+
+    uint32_t callStart = (_retryPolicy.deadlineMicros > 0) ? sfeSiT5811Micros(_retryClock) : 0;
+    uint8_t failures = 0;
+
+    while (true)
+    {
+        size_t readBytes = 0;
+        uint32_t start = _instrumentation.now();
+        sfe_SiT5811_err_t result = _theBus->readRegisterRegion(reg, data, numBytes, readBytes);
+        _instrumentation.record(kSfeSiT5811OpRead, start, result, numBytes, (result == kSfeSiT5811ErrOk) && (readBytes != numBytes));
+        if ((result == kSfeSiT5811ErrOk) && (readBytes == numBytes))
+            return true;
+
+        if (!retryAfterFailure(callStart, ++failures))
+            return false;
+    }
+}
+
+/// @brief  PRIVATE: Write a register region - with the retry policy
+/// @param  reg the register address
+/// @param  data the bytes
+/// @param  numBytes the number of bytes to write
+/// @return the bus status of the last attempt
+/// Note: a failed attempt may have written some of the bytes. The retry writes them all again
+sfe_SiT5811_err_t SfeSiT5811Driver::busWrite(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    finishAsyncWrite(); // One transaction at a time
+
+    uint32_t callStart = (_retryPolicy.deadlineMicros > 0) ? sfeSiT5811Micros(_retryClock) : 0;
+    uint8_t failures = 0;
+
+    while (true)
+    {
+        uint32_t start = _instrumentation.now();
+        sfe_SiT5811_err_t result = _theBus->writeRegisterRegion(reg, data, numBytes);
+        _instrumentation.record(kSfeSiT5811OpWrite, start, result, numBytes, false);
+        if (result == kSfeSiT5811ErrOk)
+            return result;
+
+        if (!retryAfterFailure(callStart, ++failures))
+            return result;
+    }
+}
+
+/// @brief  PRIVATE: Decide whether to retry a failed transaction, and recover the bus if the policy says so
+/// @param  callStart the retry clock time when the first attempt started
+/// @param  failures the number of failed attempts so far
+/// @return true to try again
+bool SfeSiT5811Driver::retryAfterFailure(uint32_t callStart, uint8_t failures)
+{
+    if (failures >= _retryPolicy.attempts)
+        return false;
+
+    bool recover = (_retryPolicy.recoverAfter > 0) && ((failures % _retryPolicy.recoverAfter) == 0);
+
+    // Only start what can finish by the deadline: the recovery (if any) and one more attempt
+    if (_retryPolicy.deadlineMicros > 0)
+    {
+        uint32_t needed = recover ? (2 * _retryPolicy.attemptMicros) : _retryPolicy.attemptMicros;
+        uint32_t elapsed = sfeSiT5811Micros(_retryClock) - callStart; // Unsigned: correct across the 32-bit wrap
+        if ((elapsed > _retryPolicy.deadlineMicros) || (needed > (_retryPolicy.deadlineMicros - elapsed)))
+        {
+            _deadlineAborts++;
+            return false;
+        }
+    }
+
+    if (recover && (_theBus->recoverBus() == kSfeSiT5811ErrOk))
+        _busRecoveries++;
+
+    _retries++;
+    return true;
+}
+
+/// @brief  PRIVATE: Write the control word - blocking
+/// @param  freq the frequency control word as int64_t (signed, two's complement)
+/// @return true if the write is successful
+bool SfeSiT5811Driver::writeFrequencyControlWord(int64_t freq)
+{
+    uint8_t theBytes[6];
+    uint8_t first;
+    uint8_t last;
+    controlWordSpan(freq, theBytes, first, last);
+
+    if (first == last) // Nothing has changed
+    {
+        _lastWriteBytes = 0;
+        _frequencyControl = freq;
+        return true;
+    }
+
+    _lastWriteStatus = busWrite(kSfeSiT5811RegControlMSW + (first / 2), &theBytes[first], last - first);
+    if (_lastWriteStatus != kSfeSiT5811ErrOk)
+    {
+        _lastWriteBytes = 0;
+        _frequencyControlKnown = false; // A partial write may have happened
+        return false; // Return false if the write failed
+    }
+
+    _lastWriteBytes = last - first;
+    _frequencyControl = freq; // Only update the driver's copy if the write was successful
+    _frequencyControlKnown = true;
+    return true;
+}
+
+/// @brief  PRIVATE: Update the driver's state when an asynchronous write completes or fails
+/// @param  result the bus result
+void SfeSiT5811Driver::completeAsyncWrite(sfe_SiT5811_err_t result)
+{
+    bool success = (result == kSfeSiT5811ErrOk);
+    _lastWriteStatus = result;
+
+    if (success)
+    {
+        _lastWriteBytes = _asyncWriteBytes;
+        _frequencyControl = _asyncWord; // Only update the driver's copy if the write was successful
+        if (_asyncWriteBytes > 0)
+            _frequencyControlKnown = true;
     }
     else
     {
-        if (errorInClocks < (0.0 - maxChangeInClocks))
-            errorInClocks = 0.0 - maxChangeInClocks;
+        _lastWriteBytes = 0;
+        _frequencyControlKnown = false; // A partial write may have happened
     }
 
-    double P = errorInClocks * Pk;
-    double dI = errorInClocks * Ik;
-    I += dI; // Add the delta to the integral
+    if (_asyncCallback != nullptr)
+        _asyncCallback(success, _asyncWord, _asyncContext);
+}
+
+/// @brief  PRIVATE: Recalculate the cached scale factors. Called when _clip or _baseFrequencyHz change
+void SfeSiT5811Driver::updateScaling(void)
+{
+    // If the DCXO_Clip value is 0, the DCOCXO pull range is ±800 ppm
+    if (_clip == 0)
+    {
+        _maxPullAvailable = _maxPullRange;
+        _maxPullAvailablePPQ = kSfeSiT5811MaxPullPPQ;
+    }
+    else
+    {
+        _maxPullAvailable = ((double)_clip) * (_maxPullRange / 8192.0); // Fraction of 2^13
+        _maxPullAvailablePPQ = ((int64_t)_clip) * kSfeSiT5811ClipLsbPPQ;
+    }
+
+    _maxPullClippedHz = _baseFrequencyHz * _maxPullAvailable;
+
+    double maxPullHz = _baseFrequencyHz * _maxPullRange;
+    _hzPerLsbPositive = maxPullHz / 274877906943.0; // 2^38 - 1
+    _hzPerLsbNegative = maxPullHz / 274877906944.0; // 2^38
+    _lsbPerHzPositive = 274877906943.0 / maxPullHz;
+    _lsbPerHzNegative = 274877906944.0 / maxPullHz;
 
-    return setFrequencyHz(P + I); // Set the frequency to proportional plus integral
+    _discipline.setLimits(_baseFrequencyHz, _maxPullClippedHz, _maxFrequencyChangePPB);
 }
 
 /// @brief  PROTECTED: update the local pointer to the I2C bus.
 /// @param  theBus Pointer to the bus object.
-void SfeSiT5811Driver::setCommunicationBus(sfeTkArdI2C *theBus)
+void SfeSiT5811Driver::setCommunicationBus(SfeSiT5811Bus *theBus)
 {
     _theBus = theBus;
 }
@@ -15,6 +15,8 @@
     Oven-Compensated Crystal Oscillator from SiTime.
     Requires the SparkFun Toolkit:
     https://github.com/sparkfun/SparkFun_Toolkit
+    (SfeSiT5811Driver itself talks through SfeSiT5811Bus and does not need
+    Arduino or the Toolkit. It can be built on a host PC - see extras/host.)
 
     Notes:
     The SiT5811 has three 16-bit registers which define the 39-bit frequency control word.
@@ -34,8 +36,19 @@
 
 #include <stdint.h>
 
+#if defined(ARDUINO)
 #include <Arduino.h>
 #include <SparkFun_Toolkit.h>
+#endif
+
+#include "SparkFun_SiT5811_Bus.h"
+#include "SparkFun_SiT5811_Discipline.h"
+#include "SparkFun_SiT5811_Filter.h"
+#include "SparkFun_SiT5811_Holdover.h"
+#include "SparkFun_SiT5811_Instrumentation.h"
+#include "SparkFun_SiT5811_Snapshot.h"
+#include "SparkFun_SiT5811_Stability.h"
+#include "SparkFun_SiT5811_Telemetry.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // I2C Addressing
@@ -51,10 +64,39 @@ const uint8_t kDefaultSiT5811Addr = 0x50; //
 ///////////////////////////////////////////////////////////////////////////////
 
 const uint8_t kSfeSiT5811RegClip = 0x00; // DCXO Clip 13-bit
+// Note: the Power Indicator and Chip ID addresses (0x01 - 0x03) are inferred, not taken from the
+//       SiT5811 datasheet: confirm them against the datasheet before relying on them
+const uint8_t kSfeSiT5811RegPowerMSW = 0x01; // Power Indicator (PID output) Most Significant Word (MSW)
+const uint8_t kSfeSiT5811RegPowerLSW = 0x02; // Power Indicator (PID output) Least Significant Word (LSW)
+const uint8_t kSfeSiT5811RegChipID = 0x03; // Chip ID 16-bit
 const uint8_t kSfeSiT5811RegControlMSW = 0x0C; // Digital Frequency Control Most Significant Word (MSW)
 const uint8_t kSfeSiT5811RegControlNSW = 0x0D; // Digital Frequency Control Next Significant Word (NSW)
 const uint8_t kSfeSiT5811RegControlLSW = 0x0E; // Digital Frequency Control Least Significant Word (LSW)
 
+///////////////////////////////////////////////////////////////////////////////
+// Frequency Control Word Scaling
+///////////////////////////////////////////////////////////////////////////////
+// The 39-bit control word spans -2^38 to +2^38-1, which is -800ppm to +800ppm.
+// The integer API expresses fractional frequency offsets in parts per quadrillion
+// (PPQ, 1e-15). One LSB is 800e-6 / 2^38 = 2.91 PPQ, so PPQ is fine enough to
+// round-trip every control word exactly.
+// 800ppm = 8e11 PPQ = 2^14 * 5^11. So PPQ = word * 5^11 / 2^24 exactly.
+
+const int64_t kSfeSiT5811ControlWordMax = 274877906943; // 2^38 - 1
+const int64_t kSfeSiT5811ControlWordMin = -274877906944; // -2^38
+const int64_t kSfeSiT5811MaxPullPPQ = 800000000000; // 800ppm in PPQ
+const int64_t kSfeSiT5811ClipLsbPPQ = 97656250; // 800ppm / 2^13 in PPQ (exact)
+
+///////////////////////////////////////////////////////////////////////////////
+// Power Indicator and Chip ID
+///////////////////////////////////////////////////////////////////////////////
+// The Power Indicator is the oven controller's PID output: 0 is heater off, full scale
+// (2^18 - 1) is full power. It is high while the oven warms up and settles to a steady
+// value which depends on the ambient temperature.
+
+const uint32_t kSfeSiT5811PowerIndicatorMax = 262143; // 2^18 - 1
+const uint16_t kSfeSiT5811ChipIDAny = 0x0000; // setExpectedChipID: do not check the Chip ID
+
 ///////////////////////////////////////////////////////////////////////////////
 // OCXO Clip Register Description
 ///////////////////////////////////////////////////////////////////////////////
@@ -87,6 +129,64 @@ typedef union
     uint16_t word;
 } sfe_SiT5811_reg_control_lsw_t;
 
+///////////////////////////////////////////////////////////////////////////////
+// Power Indicator Least Significant Word (LSW) Register Description
+///////////////////////////////////////////////////////////////////////////////
+
+// A union is used here so that individual values from the register can be
+// accessed or the whole register can be accessed.
+// Note: the layout (PID[1:0] in the two most significant bits, after PID[17:2] in the MSW) is
+//       inferred, like the register address: confirm it against the datasheet
+typedef union
+{
+    struct
+    {
+        uint16_t notUsed : 14; // Not used
+        uint16_t power : 2; // PID[1:0]
+    };
+    uint16_t word;
+} sfe_SiT5811_reg_power_lsw_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Startup Modes
+///////////////////////////////////////////////////////////////////////////////
+
+// How begin reads the registers. Transactions: Emulator 5, Minimal 2, Verified 3, Seeded 0
+typedef enum
+{
+    kSfeSiT5811StartupEmulator = 0, // Ping, then read the Clip and the control registers twice each. Works with examples/SiT5811_Emulator
+    kSfeSiT5811StartupMinimal, // Ping, then one combined read of 0x00-0x0E
+    kSfeSiT5811StartupVerified, // Ping, then two combined reads which must agree
+    kSfeSiT5811StartupSeeded // No transactions: use the values from seedRegisters
+} sfe_SiT5811_startup_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// Asynchronous Updates
+///////////////////////////////////////////////////////////////////////////////
+
+// Called when an asynchronous control word write completes or fails
+// success is true if the write was successful. freq is the control word which was written
+typedef void (*sfe_SiT5811_async_callback_t)(bool success, int64_t freq, void *context);
+
+///////////////////////////////////////////////////////////////////////////////
+// Retries
+///////////////////////////////////////////////////////////////////////////////
+
+// How the blocking bus transactions (begin, the reads and the control word writes) recover from bus errors.
+// A failed or short transaction is retried until it succeeds, the attempts run out, or another attempt might
+// not finish by the deadline. An attempt (or a bus recovery and an attempt) is only started if it can finish
+// by the deadline, assuming it takes attemptMicros. So, if attemptMicros is at least the longest a transaction
+// can take (the bus timeout, plus the bytes), no operation takes longer than the deadline.
+// The deadline is measured with micros() on Arduino, or CLOCK_MONOTONIC on a host. See setRetryClock.
+// The asynchronous writes (poll) are not retried.
+typedef struct
+{
+    uint8_t attempts; // Attempts per transaction, including the first. Default: 1 (no retries)
+    uint32_t deadlineMicros; // The longest an operation may take. 0 (default): no deadline
+    uint32_t attemptMicros; // The longest one attempt, or one bus recovery, can take. Default: 0
+    uint8_t recoverAfter; // Call recoverBus after this many consecutive failed attempts. 0 (default): never
+} sfe_SiT5811_retry_t;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SfeSiT5811Driver
@@ -94,13 +194,29 @@ class SfeSiT5811Driver
 public:
     // @brief Constructor. Instantiate the driver object using the specified address (if desired).
     SfeSiT5811Driver()
-        : _baseFrequencyHz{10000000.0}, _maxFrequencyChangePPB{800000.0}
+        : _theBus{nullptr}, _frequencyControl{0}, _clip{0}, _baseFrequencyHz{10000000.0}, _maxFrequencyChangePPB{800000.0},
+          _frequencyControlKnown{false}, _fullWrites{false}, _lastWriteBytes{0}, _lastWriteStatus{kSfeSiT5811ErrOk},
+          _async{false}, _asyncPending{false}, _asyncInFlight{false}, _asyncCoalesced{0}, _asyncCallback{nullptr}, _asyncContext{nullptr}
     {
+        updateScaling();
     }
 
     /// @brief Begin communication with the SiT5811. Read the registers.
-    /// @return true if readRegisters is successful.
-    bool begin(void);
+    /// @param mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
+    /// @return true if the device responded and the registers were read (or seeded)
+    bool begin(sfe_SiT5811_startup_t mode = kSfeSiT5811StartupEmulator);
+
+    /// @brief Begin communication with the SiT5811 using the specified bus. Read the registers.
+    /// @param theBus the bus the SiT5811 is attached to (e.g. a SfeSiT5811RegisterFile)
+    /// @param mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
+    /// @return true if the device responded and the registers were read (or seeded)
+    bool begin(SfeSiT5811Bus *theBus, sfe_SiT5811_startup_t mode = kSfeSiT5811StartupEmulator);
+
+    /// @brief Set the driver's copies of the registers without reading them - for begin(kSfeSiT5811StartupSeeded)
+    /// @param clip the 13-bit Clip register value
+    /// @param freq the 39-bit frequency control word as int64_t (signed, two's complement)
+    /// Note: the first control word write after seeding writes all three registers, in case the seed is stale.
+    void seedRegisters(uint16_t clip, int64_t freq);
 
 
     /// @brief Read the SiT5811 OCXO Clip register and update the driver's internal copy
@@ -111,6 +227,45 @@ public:
     /// @return true if the read is successful
     bool readRegisters(void);
 
+    /// @brief Read the Clip and the three frequency control registers in a single transaction
+    /// @return true if the read is successful
+    /// Note: this reads all fifteen registers (0x00 to 0x0E, 30 bytes). It is one transaction instead of two,
+    ///       and an absent device fails on the address byte, so it doubles as a presence check.
+    ///       The Power Indicator and Chip ID copies are updated too.
+    bool readAllRegisters(void);
+
+    /// @brief Read the two SiT5811 Power Indicator registers and update the driver's internal copy
+    /// @return true if the read is successful
+    bool readPowerIndicator(void);
+
+    /// @brief Read the SiT5811 Chip ID register and update the driver's internal copy
+    /// @return true if the read is successful
+    bool readChipID(void);
+
+
+    /// @brief Get the 18-bit Power Indicator (oven PID output) - from the driver's internal copy
+    /// @return The Power Indicator: 0 (heater off) to kSfeSiT5811PowerIndicatorMax (full power)
+    uint32_t getPowerIndicator(void);
+
+    /// @brief Get the Power Indicator as a fraction of full power - from the driver's internal copy
+    /// @return The oven power: 0.0 to 1.0
+    double getPowerFraction(void);
+
+    /// @brief Get the 16-bit Chip ID - from the driver's internal copy
+    /// @return The Chip ID
+    uint16_t getChipID(void);
+
+    /// @brief Set the Chip ID which begin expects. begin fails if the Chip ID read is different
+    /// @param id the Chip ID. kSfeSiT5811ChipIDAny (default): do not check
+    /// Note: begin(kSfeSiT5811StartupMinimal) and begin(kSfeSiT5811StartupVerified) read the Chip ID with the other
+    ///       registers, at no extra cost. begin(kSfeSiT5811StartupEmulator) reads it separately, only if an ID is set.
+    ///       begin(kSfeSiT5811StartupSeeded) does not check it. (The emulator's Chip ID is zero.)
+    void setExpectedChipID(uint16_t id);
+
+    /// @brief Get the Chip ID which begin expects
+    /// @return The Chip ID. kSfeSiT5811ChipIDAny: not checked
+    uint16_t getExpectedChipID(void);
+
 
     /// @brief Get the 39-bit frequency control word - from the driver's internal copy
     /// @return The 39-bit frequency control word as int64_t (signed, two's complement)
@@ -119,8 +274,94 @@ public:
     /// @brief Set the 39-bit frequency control word - and update the driver's internal copy
     /// @param freq the frequency control word as int64_t (signed, two's complement)
     /// @return true if the write is successful
+    /// Note: by default, only the registers which change are written. If the word is unchanged,
+    ///       nothing is written. Call setFullWrites(true) to always write all three registers.
     bool setFrequencyControlWord(int64_t freq);
 
+    /// @brief Always write all three frequency control registers (glitch-sensitive applications)
+    /// @param fullWrites true: always write 0x0C-0x0E; false: skip no-op writes and write only the registers which change
+    void setFullWrites(bool fullWrites);
+
+    /// @brief Get the full writes setting
+    /// @return true if setFrequencyControlWord always writes all three registers
+    bool getFullWrites(void);
+
+    /// @brief Get the number of register bytes written by the last setFrequencyControlWord
+    /// @return 0 (write skipped or failed), 2, 4 or 6
+    uint8_t getLastWriteBytes(void);
+
+
+    /// @brief Enable or disable asynchronous mode
+    /// In asynchronous mode, setFrequencyControlWord (and setFrequencyHz, setFrequencyOffsetPPQ,
+    /// setFrequencyByBiasMillis) only store the new word as pending and return true immediately.
+    /// poll() writes it. If several words are set before poll() writes them, only the latest is written.
+    /// Disabling asynchronous mode writes any pending word (blocking). If a write fails, any word still
+    /// pending is discarded and false is returned.
+    /// Blocking transactions (begin, readRegisters, readAllRegisters, etc.) first wait for a write which
+    /// poll() has started to complete.
+    /// @param async true to enable asynchronous mode
+    /// @return true if any pending word was written successfully
+    bool setAsyncMode(bool async);
+
+    /// @brief Get the asynchronous mode setting
+    /// @return true if asynchronous mode is enabled
+    bool getAsyncMode(void);
+
+    /// @brief Set the function to be called when an asynchronous write completes or fails
+    /// @param callback the callback function. nullptr to disable
+    /// @param context passed to the callback
+    void setAsyncCallback(sfe_SiT5811_async_callback_t callback, void *context = nullptr);
+
+    /// @brief Advance the asynchronous write state machine. Call this regularly from loop()
+    /// If the bus supports non-blocking writes, poll() never waits for the bus.
+    /// Otherwise (e.g. Arduino Wire), poll() performs the pending write, at a time of the caller's choosing.
+    /// Does nothing if asynchronous mode is disabled.
+    /// @return kSfeSiT5811ErrOk if idle (nothing pending), kSfeSiT5811ErrBusy if a write is in progress
+    ///         or pending, or the error if a write failed
+    sfe_SiT5811_err_t poll(void);
+
+    /// @brief Check if an asynchronous write is pending or in progress
+    /// @return true if poll() still has work to do
+    bool isAsyncBusy(void);
+
+    /// @brief Check if an asynchronous write has been started on the bus and has not yet completed
+    /// @return true if the bus is occupied by this driver's write
+    bool isAsyncWriting(void);
+
+    /// @brief Get the pending control word - or the driver's copy if nothing is pending
+    /// @return The 39-bit frequency control word as int64_t (signed, two's complement)
+    int64_t getPendingFrequencyControlWord(void);
+
+    /// @brief Get the number of pending words which were replaced before they were written
+    /// @return The number of coalesced updates since asynchronous mode was enabled
+    uint32_t getAsyncCoalesced(void);
+
+
+    /// @brief Get the default retry policy: one attempt (no retries), no deadline, no bus recovery
+    /// @param policy returns the policy
+    static void getDefaultRetryPolicy(sfe_SiT5811_retry_t &policy);
+
+    /// @brief Set the retry policy for the blocking bus transactions. Resets the retry counts
+    /// @param policy the policy
+    void setRetryPolicy(const sfe_SiT5811_retry_t &policy);
+
+    /// @brief Get the retry policy
+    /// @param policy returns the policy
+    void getRetryPolicy(sfe_SiT5811_retry_t &policy);
+
+    /// @brief Get the number of retries since setRetryPolicy
+    uint32_t getRetries(void);
+
+    /// @brief Get the number of bus recoveries since setRetryPolicy
+    uint32_t getBusRecoveries(void);
+
+    /// @brief Get the number of transactions abandoned because another attempt might not finish by the deadline
+    uint32_t getDeadlineAborts(void);
+
+    /// @brief Set the function which provides the time for the retry deadline
+    /// @param clock returns the time in microseconds. nullptr (default): micros() on Arduino, CLOCK_MONOTONIC on a host
+    void setRetryClock(uint32_t (*clock)(void));
+
 
     /// @brief Get the 13-bit clip value - from the driver's internal copy
     /// @return The 13-bit clip as uint16_t
@@ -131,6 +372,11 @@ public:
     double getMaxPullAvailable(void);
 
 
+    /// @brief Get the clip value - from the driver's internal copy. Convert to maximum pull available in PPQ
+    /// @return The maximum pull available in parts per quadrillion (1e-15)
+    int64_t getMaxPullAvailablePPQ(void);
+
+
     /// @brief Get the base oscillator frequency - from the driver's internal copy
     /// @return The oscillator base frequency as double
     double getBaseFrequencyHz(void);
@@ -153,6 +399,27 @@ public:
     /// Note: setFrequencyHz ignores _maxFrequencyChangePPB.
     bool setFrequencyHz(double freq);
 
+    /// @brief Convert a frequency to the control word setFrequencyHz would write - no bus access
+    /// @param freq the oscillator frequency in Hz
+    /// @return The 39-bit frequency control word, limited to the pull range
+    /// Note: the clamps are not counted by the instrumentation. Only setFrequencyHz counts them.
+    int64_t getControlWordForHz(double freq);
+
+
+    /// @brief Get the fractional frequency offset defined by the control word - integer math only
+    /// @return The frequency offset in parts per quadrillion (1e-15), rounded to nearest
+    /// Note: the integer path uses the symmetric 2^38 scale. At positive full scale it differs
+    ///       from getFrequencyHz by up to 1 LSB.
+    int64_t getFrequencyOffsetPPQ(void);
+
+    /// @brief Set the fractional frequency offset - integer math only
+    /// @param ppq the frequency offset in parts per quadrillion (1e-15)
+    /// @return true if the write is successful
+    /// Note: The offset will be limited by the pull range capabilities of the device.
+    ///       The control word is rounded to nearest, so every control word round-trips exactly
+    ///       through getFrequencyOffsetPPQ and setFrequencyOffsetPPQ.
+    bool setFrequencyOffsetPPQ(int64_t ppq);
+
 
     /// @brief Get the maximum frequency change in PPB
     /// @return The maximum frequency change in PPB - from the driver's internal store
@@ -171,23 +438,306 @@ public:
     /// Note: the frequency change will be limited by: the pull range capabilities of the device;
     ///       and the setMaxFrequencyChangePPB. Call getFrequencyHz to read the frequency set.
     /// The default values for Pk and Ik come from very approximate Ziegler-Nichols tuning:
-    /// oscillation starts when Pk is TODO; with a period of TODO seconds.
+    /// with one update of delay, oscillation starts when Pk is 2; with a period of 2 seconds.
+    /// (Ziegler-Nichols proper gives Pk = 0.9, Ik = 0.54. The defaults are gentler, close to Tyreus-Luyben.)
+    /// SfeSiT5811AutoTune measures the gain and period on your own hardware and proposes Pk and Ik.
+    /// Note: the integrator is held per driver, in getDiscipline(). It is seeded from getFrequencyHz
+    ///       on the first call. Call reseedDiscipline after changing the frequency by other means.
     bool setFrequencyByBiasMillis(double bias, double Pk = 0.5, double Ik = 0.1);
 
+    /// @brief Get the clock discipline controller used by setFrequencyByBiasMillis
+    /// @return A reference to this driver's controller - to inspect its state
+    SfeSiT5811Discipline &getDiscipline(void);
+
+    /// @brief Reset the clock discipline controller and seed it from the current frequency
+    /// A cold start: the learned drift and the limit counters are cleared too
+    void resetDiscipline(void);
+
+    /// @brief Seed the clock discipline controller from the current frequency
+    /// Keep the learned drift and the limit counters - e.g. after holdover or tuning
+    void reseedDiscipline(void);
+
+    /// @brief Select the steering law used by setFrequencyByBiasMillis
+    /// @param mode kSfeSiT5811SteeringPI (default), kSfeSiT5811SteeringKalman2 or kSfeSiT5811SteeringKalman3
+    /// @param kalman the filter for the Kalman modes, e.g. a SfeSiT5811Kalman declared alongside the driver.
+    ///        Without one, the steering law is PI
+    /// Note: the Kalman modes ignore Pk and Ik. Configure the noise on the filter itself
+    void setSteeringMode(sfe_SiT5811_steering_t mode, SfeSiT5811Kalman *kalman = nullptr);
+
+    /// @brief Get the steering law used by setFrequencyByBiasMillis
+    sfe_SiT5811_steering_t getSteeringMode(void);
+
+    /// @brief Attach a stability estimator. setFrequencyByBiasMillis will add each bias to it
+    /// @param stability the estimator, e.g. a SfeSiT5811StabilityN<6>. nullptr to detach
+    void setStabilityEstimator(SfeSiT5811Stability *stability);
+
+    /// @brief Get the attached stability estimator - to query ADEV, TDEV and MTIE
+    /// @return the estimator, or nullptr if none is attached
+    SfeSiT5811Stability *getStabilityEstimator(void);
+
+    /// @brief Capture the steering state
+    /// @param snapshot returns the snapshot
+    /// @param timestamp the time now in seconds (any epoch: GNSS, Unix, RTC). Zero if unknown
+    void getSnapshot(sfe_SiT5811_snapshot_t &snapshot, uint32_t timestamp = 0);
+
+    /// @brief Capture the steering state and write it to non-volatile storage
+    /// @param storage the storage, e.g. EEPROM or a file
+    /// @param timestamp the time now in seconds (any epoch: GNSS, Unix, RTC). Zero if unknown
+    /// @return true if the write is successful
+    bool saveSnapshot(SfeSiT5811Storage *storage, uint32_t timestamp = 0);
+
+    /// @brief Restore the steering state: seed the discipline and set the frequency
+    /// @param snapshot the snapshot
+    /// @param now the time now in seconds, in the same epoch as the snapshot timestamp. Zero if unknown
+    /// @return true if the snapshot matches this oscillator (base frequency and clip) and the write is successful
+    /// Note: if both now and the snapshot timestamp are known, the integrator is extrapolated by the learned
+    ///       drift over the time since the snapshot, assuming one update per second.
+    bool restoreSnapshot(const sfe_SiT5811_snapshot_t &snapshot, uint32_t now = 0);
+
+    /// @brief Read the steering state from non-volatile storage and restore it
+    /// @param storage the storage, e.g. EEPROM or a file
+    /// @param now the time now in seconds, in the same epoch as the snapshot timestamp. Zero if unknown
+    /// @return true if a valid snapshot for this oscillator was read and restored.
+    ///         false if there is no snapshot or it is corrupt: the discipline then starts cold
+    bool restoreSnapshot(SfeSiT5811Storage *storage, uint32_t now = 0);
+
+    /// @brief Get the bus instrumentation: transaction, byte, failure and short read counts, latency histograms and clamp counts
+    /// @return A reference to this driver's instrumentation. All getters return zero if SFE_SIT5811_INSTRUMENTATION is 0
+    SfeSiT5811Instrumentation &getInstrumentation(void);
+
+    /// @brief Attach a telemetry buffer. setFrequencyByBiasMillis will log each step to it
+    /// @param telemetry the buffer, e.g. a SfeSiT5811TelemetryN<512>. nullptr to detach
+    void setTelemetry(SfeSiT5811Telemetry *telemetry);
+
+    /// @brief Get the attached telemetry buffer - to drain it
+    /// @return the buffer, or nullptr if none is attached
+    SfeSiT5811Telemetry *getTelemetry(void);
+
+    /// @brief Attach a holdover engine. setFrequencyByBiasMillis will add each control word to its fit,
+    ///        and end holdover when the bias returns. Call its update() to steer when the bias stops
+    /// @param holdover the holdover engine. nullptr to detach
+    void setHoldover(SfeSiT5811Holdover *holdover);
+
+    /// @brief Get the attached holdover engine
+    /// @return the holdover engine, or nullptr if none is attached
+    SfeSiT5811Holdover *getHoldover(void);
+
+    /// @brief Attach a bias pre-filter. setFrequencyByBiasMillis will filter each bias before steering with it
+    /// @param filter the filter, e.g. a SfeSiT5811FilterN<9>. nullptr to detach
+    /// Note: the stability estimator and the telemetry still see the raw bias. A rejected bias is logged
+    ///       with kSfeSiT5811TelemetryFlagRejected
+    void setFilter(SfeSiT5811Filter *filter);
+
+    /// @brief Get the attached bias pre-filter - to read its rejection counts
+    /// @return the filter, or nullptr if none is attached
+    SfeSiT5811Filter *getFilter(void);
+
 
 protected:
+    /// @brief Convert a frequency offset in PPQ to a control word, rounded to nearest and limited to 39 bits
+    /// @param ppq the frequency offset in parts per quadrillion (1e-15)
+    /// @return the 39-bit frequency control word
+    static int64_t ppqToControlWord(int64_t ppq);
+
+    /// @brief Convert a control word to a frequency offset in PPQ, rounded to nearest
+    /// @param freq the 39-bit frequency control word
+    /// @return the frequency offset in parts per quadrillion (1e-15)
+    static int64_t controlWordToPPQ(int64_t freq);
+
     /// @brief Sets the communication bus to the specified bus.
     /// @param theBus Bus to set as the communication devie.
-    void setCommunicationBus(sfeTkArdI2C *theBus);
+    void setCommunicationBus(SfeSiT5811Bus *theBus);
 
 private:
-    sfeTkArdI2C *_theBus; // Pointer to bus device.
+    SfeSiT5811Bus *_theBus; // Pointer to bus device.
 
     const double _maxPullRange = 800e-6; // Maximum pull range is +/- 800ppm
     int64_t _frequencyControl; // Local store for the frequency control word. 39-Bit, 2's complement
     uint16_t _clip; // Local store for the 13-bit OCXO Clip register value
+    uint32_t _powerIndicator = 0; // Local store for the 18-bit Power Indicator
+    uint16_t _chipID = 0; // Local store for the 16-bit Chip ID
+    uint16_t _expectedChipID = kSfeSiT5811ChipIDAny; // The Chip ID begin expects
     double _baseFrequencyHz; // The base frequency used by getFrequencyHz and setFrequencyHz
     double _maxFrequencyChangePPB; // The maximum frequency change in PPB for setFrequencyByBiasMillis
+
+    bool _frequencyControlKnown; // true when _frequencyControl is known to match the device
+    bool _fullWrites; // true: setFrequencyControlWord always writes all three registers
+    uint8_t _lastWriteBytes; // Register bytes written by the last setFrequencyControlWord
+    sfe_SiT5811_err_t _lastWriteStatus; // Bus status of the last control word write
+
+    sfe_SiT5811_retry_t _retryPolicy = {1, 0, 0, 0}; // The default: see getDefaultRetryPolicy
+    uint32_t _retries = 0; // Retries since setRetryPolicy
+    uint32_t _busRecoveries = 0; // Bus recoveries since setRetryPolicy
+    uint32_t _deadlineAborts = 0; // Transactions abandoned at the deadline since setRetryPolicy
+    uint32_t (*_retryClock)(void) = nullptr; // The deadline clock. nullptr: sfeSiT5811Micros' default
+
+    /// @brief Update the driver's copy of the Clip register
+    /// @param theBytes the two register bytes, MSB first
+    void clipFromBytes(const uint8_t *theBytes);
+
+    /// @brief Update the driver's copy of the frequency control word
+    /// @param theBytes the six register bytes (0x0C-0x0E), MSB first
+    void controlWordFromBytes(const uint8_t *theBytes);
+
+    /// @brief Update the driver's copy of the Power Indicator
+    /// @param theBytes the four register bytes (0x01-0x02), MSB first
+    void powerFromBytes(const uint8_t *theBytes);
+
+    /// @brief Check the Chip ID against the expected Chip ID
+    /// @return true if it matches, or no Chip ID is expected
+    bool chipIDMatches(void);
+
+    /// @brief Wait for an asynchronous write which is in progress on the bus to complete
+    void finishAsyncWrite(void);
+
+    /// @brief Ping the device - with the retry policy
+    /// @return true if the device responded
+    bool busPing(void);
+
+    /// @brief Read a register region - with the retry policy
+    /// @param reg the register address
+    /// @param data returns the bytes
+    /// @param numBytes the number of bytes to read. Fewer is a failure
+    /// @return true if all the bytes were read
+    bool busRead(uint8_t reg, uint8_t *data, size_t numBytes);
+
+    /// @brief Write a register region - with the retry policy
+    /// @param reg the register address
+    /// @param data the bytes
+    /// @param numBytes the number of bytes to write
+    /// @return the bus status of the last attempt
+    sfe_SiT5811_err_t busWrite(uint8_t reg, const uint8_t *data, size_t numBytes);
+
+    /// @brief Decide whether to retry a failed transaction, and recover the bus if the policy says so
+    /// @param callStart the instrumentation time when the first attempt started
+    /// @param failures the number of failed attempts so far
+    /// @return true to try again
+    bool retryAfterFailure(uint32_t callStart, uint8_t failures);
+
+    /// @brief Convert a frequency to a control word, limited to the pull range
+    /// @param freq the oscillator frequency in Hz
+    /// @param countClamps true: count the clamps in the instrumentation
+    /// @return The 39-bit frequency control word
+    int64_t hzToControlWord(double freq, bool countClamps);
+
+    /// @brief Convert the control word to the six register bytes (0x0C-0x0E, MSB first)
+    /// @param freq the frequency control word as int64_t (signed, two's complement)
+    /// @param theBytes the six register bytes
+    static void controlWordToBytes(int64_t freq, uint8_t *theBytes);
+
+    /// @brief Convert the control word to register bytes and find the span of bytes which need to be written
+    /// @param freq the frequency control word as int64_t (signed, two's complement)
+    /// @param theBytes the six register bytes
+    /// @param first returns the first byte to write
+    /// @param last returns one past the last byte to write. first == last if nothing needs to be written
+    void controlWordSpan(int64_t freq, uint8_t *theBytes, uint8_t &first, uint8_t &last);
+
+    /// @brief Write the control word - blocking
+    /// @param freq the frequency control word as int64_t (signed, two's complement)
+    /// @return true if the write is successful
+    bool writeFrequencyControlWord(int64_t freq);
+
+    /// @brief Update the driver's state when an asynchronous write completes or fails
+    /// @param result the bus result
+    void completeAsyncWrite(sfe_SiT5811_err_t result);
+
+    bool _async; // true: asynchronous mode
+    bool _asyncPending; // true: _asyncPendingWord is waiting to be written
+    bool _asyncInFlight; // true: _asyncWord is being written
+    int64_t _asyncPendingWord; // The latest word set in asynchronous mode
+    int64_t _asyncWord; // The word being written
+    uint8_t _asyncBytes[6]; // The register bytes being written. Must remain valid while the write is in flight
+    uint8_t _asyncWriteBytes; // The number of bytes being written
+    uint32_t _asyncCoalesced; // The number of pending words replaced before they were written
+    sfe_SiT5811_async_callback_t _asyncCallback; // Called on completion or failure
+    void *_asyncContext; // Passed to _asyncCallback
+    uint32_t _asyncStartMicros; // When the asynchronous write started - for the instrumentation
+
+    SfeSiT5811Instrumentation _instrumentation; // Bus and clamp counters
+
+    SfeSiT5811Discipline _discipline; // The PI controller used by setFrequencyByBiasMillis
+    SfeSiT5811Stability *_stability = nullptr; // Optional stability estimator fed by setFrequencyByBiasMillis
+    SfeSiT5811Telemetry *_telemetry = nullptr; // Optional telemetry buffer fed by setFrequencyByBiasMillis
+    SfeSiT5811Holdover *_holdover = nullptr; // Optional holdover engine fed by setFrequencyByBiasMillis
+    SfeSiT5811Filter *_filter = nullptr; // Optional bias pre-filter used by setFrequencyByBiasMillis
+
+    /// @brief Recalculate the cached scale factors. Called when _clip or _baseFrequencyHz change
+    void updateScaling(void);
+
+    // Scale factors - cached by updateScaling so the conversions need no pow or division
+    double _maxPullAvailable; // The available pull range (fraction) - from _clip
+    double _maxPullClippedHz; // The available pull range in Hz
+    double _hzPerLsbPositive; // Hz per LSB for positive control words: base * 800ppm / (2^38 - 1)
+    double _hzPerLsbNegative; // Hz per LSB for negative control words: base * 800ppm / 2^38
+    double _lsbPerHzPositive; // LSB per Hz for positive offsets
+    double _lsbPerHzNegative; // LSB per Hz for negative offsets
+    int64_t _maxPullAvailablePPQ; // The available pull range in PPQ
+};
+
+#if defined(ARDUINO)
+
+// Adapts a SparkFun Toolkit I2C bus to SfeSiT5811Bus.
+// Toolkit error codes are passed through unchanged.
+class SfeSiT5811TkI2CBus : public SfeSiT5811Bus
+{
+public:
+    SfeSiT5811TkI2CBus() : _theI2CBus{nullptr}, _recover{nullptr}
+    {
+    }
+
+    /// @brief Set the Toolkit I2C bus to talk through
+    /// @param theI2CBus pointer to the Toolkit I2C bus
+    void setI2CBus(sfeTkArdI2C *theI2CBus)
+    {
+        _theI2CBus = theI2CBus;
+    }
+
+    sfe_SiT5811_err_t ping(void)
+    {
+        if (_theI2CBus == nullptr)
+            return kSfeSiT5811ErrBusNotInit;
+        return (sfe_SiT5811_err_t)_theI2CBus->ping();
+    }
+
+    sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes)
+    {
+        if (_theI2CBus == nullptr)
+            return kSfeSiT5811ErrBusNotInit;
+        return (sfe_SiT5811_err_t)_theI2CBus->readRegisterRegion(reg, data, numBytes, readBytes);
+    }
+
+    sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+    {
+        if (_theI2CBus == nullptr)
+            return kSfeSiT5811ErrBusNotInit;
+        return (sfe_SiT5811_err_t)_theI2CBus->writeRegisterRegion(reg, data, numBytes);
+    }
+
+    sfe_SiT5811_err_t setAddress(uint8_t address)
+    {
+        if (_theI2CBus == nullptr)
+            return kSfeSiT5811ErrBusNotInit;
+        _theI2CBus->setAddress(address);
+        return kSfeSiT5811ErrOk;
+    }
+
+    /// @brief Set the function which recovers a stuck bus. The Toolkit cannot: it depends on the pins
+    /// @param recover returns true if the bus is free. nullptr: recovery is not supported
+    void setRecovery(bool (*recover)(void))
+    {
+        _recover = recover;
+    }
+
+    sfe_SiT5811_err_t recoverBus(void)
+    {
+        if (_recover == nullptr)
+            return kSfeSiT5811ErrFail;
+        return _recover() ? kSfeSiT5811ErrOk : kSfeSiT5811ErrFail;
+    }
+
+private:
+    sfeTkArdI2C *_theI2CBus;
+    bool (*_recover)(void);
 };
 
 class SfeSiT5811ArdI2C : public SfeSiT5811Driver
@@ -198,47 +748,63 @@ public:
     }
 
     /// @brief  Sets up Arduino I2C driver using the default I2C address then calls the super class begin.
+    /// @param  mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
     /// @return True if successful, false otherwise.
-    bool begin(void)
+    bool begin(sfe_SiT5811_startup_t mode = kSfeSiT5811StartupEmulator)
     {
         if (_theI2CBus.init(kDefaultSiT5811Addr) != kSTkErrOk)
             return false;
 
-        setCommunicationBus(&_theI2CBus);
+        _theTkBus.setI2CBus(&_theI2CBus);
+        setCommunicationBus(&_theTkBus);
 
         _theI2CBus.setStop(false); // Use restarts not stops for I2C reads
 
-        return SfeSiT5811Driver::begin();
+        return SfeSiT5811Driver::begin(mode);
     }
 
     /// @brief  Sets up Arduino I2C driver using the specified I2C address then calls the super class begin.
+    /// @param  mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
     /// @return True if successful, false otherwise.
-    bool begin(const uint8_t &address)
+    bool begin(const uint8_t &address, sfe_SiT5811_startup_t mode = kSfeSiT5811StartupEmulator)
     {
         if (_theI2CBus.init(address) != kSTkErrOk)
             return false;
 
-        setCommunicationBus(&_theI2CBus);
+        _theTkBus.setI2CBus(&_theI2CBus);
+        setCommunicationBus(&_theTkBus);
 
         _theI2CBus.setStop(false); // Use restarts not stops for I2C reads
 
-        return SfeSiT5811Driver::begin();
+        return SfeSiT5811Driver::begin(mode);
     }
 
     /// @brief  Sets up Arduino I2C driver using the specified I2C address then calls the super class begin.
+    /// @param  mode the startup mode (kSfeSiT5811Startup...). Default: kSfeSiT5811StartupEmulator
     /// @return True if successful, false otherwise.
-    bool begin(TwoWire &wirePort, const uint8_t &address)
+    bool begin(TwoWire &wirePort, const uint8_t &address, sfe_SiT5811_startup_t mode = kSfeSiT5811StartupEmulator)
     {
         if (_theI2CBus.init(wirePort, address) != kSTkErrOk)
             return false;
 
-        setCommunicationBus(&_theI2CBus);
+        _theTkBus.setI2CBus(&_theI2CBus);
+        setCommunicationBus(&_theTkBus);
 
         _theI2CBus.setStop(false); // Use restarts not stops for I2C reads
 
-        return SfeSiT5811Driver::begin();
+        return SfeSiT5811Driver::begin(mode);
+    }
+
+    /// @brief  Set the function which recovers a stuck I2C bus - called by the retry policy (see sfe_SiT5811_retry_t)
+    /// @param  recover e.g. clock SCL until SDA is released, send a stop, then restart Wire. Returns true if the bus is free
+    void setBusRecovery(bool (*recover)(void))
+    {
+        _theTkBus.setRecovery(recover);
     }
 
 private:
     sfeTkArdI2C _theI2CBus;
+    SfeSiT5811TkI2CBus _theTkBus;
 };
+
+#endif // defined(ARDUINO)
@@ -0,0 +1,257 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_AutoTune.cpp
+
+    Description:
+    Relay-feedback auto-tuning of the setFrequencyByBiasMillis PI gains.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_AutoTune.h"
+
+const double kSfeSiT5811TunePi = 3.14159265358979;
+
+/// @brief Start tuning. Call update with each bias from now on
+/// @param driver the driver to tune. It must be initialized (begin) with its base frequency set
+/// @return true if tuning started
+bool SfeSiT5811AutoTune::begin(SfeSiT5811Driver *driver)
+{
+    _driver = driver;
+    _state = kSfeSiT5811TuneIdle;
+    _epoch = 0;
+    _measured = 0;
+    _sumRe = 0.0;
+    _sumIm = 0.0;
+    _sumW = 0.0;
+    _plantGain = 0.0;
+    _plantDelay = 0.0;
+    _ultimateGain = 0.0;
+    _ultimatePeriod = 0.0;
+    _Pk = 0.0;
+    _Ik = 0.0;
+
+    if (_driver == nullptr)
+        return false;
+
+    // Each switch steps the frequency by twice the amplitude. Keep that within the slew limit
+    double ppb = _amplitudePPB;
+    double maxPPB = _driver->getMaxFrequencyChangePPB() * 0.5;
+    if ((ppb <= 0.0) || (ppb > maxPPB))
+        ppb = maxPPB;
+
+    _startHz = _driver->getFrequencyHz();
+
+    // Center the relay on the integrator if the loop has run: the output includes the proportional noise
+    SfeSiT5811Discipline &discipline = _driver->getDiscipline();
+    _centerHz = discipline.isSeeded() ? discipline.getIntegratorHz() : _startHz;
+    _stepHz = _driver->getBaseFrequencyHz() * ppb * 1.0e-9;
+    _clocksPerMilli = _driver->getBaseFrequencyHz() * 1.0e-3;
+    _high = false;
+
+    _state = kSfeSiT5811TuneApproach;
+    return true;
+}
+
+/// @brief Set the tuning rule
+/// @param rule kSfeSiT5811TuneZieglerNichols (default) or kSfeSiT5811TuneTyreusLuyben
+void SfeSiT5811AutoTune::setRule(sfe_SiT5811_tune_rule_t rule)
+{
+    _rule = rule;
+    if (_state == kSfeSiT5811TuneDone)
+        propose(); // Re-propose from the same measurements
+}
+
+/// @brief Perform one relay step
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @return the tuner state
+sfe_SiT5811_tune_state_t SfeSiT5811AutoTune::update(double bias)
+{
+    if ((_state == kSfeSiT5811TuneIdle) || isFinished())
+        return _state;
+
+    _epoch++;
+
+    // The same error as the PI loop: positive when the oscillator is behind and needs a higher frequency
+    double error = (0.0 - bias) * _clocksPerMilli;
+    double hysteresis = _hysteresisSeconds * _driver->getBaseFrequencyHz(); // Seconds to clock cycles
+
+    if (_epoch == 1)
+        _high = (error > 0.0); // Head towards zero
+
+    bool rising = false;
+    if (!_high && (error > hysteresis))
+    {
+        _high = true;
+        rising = true;
+    }
+    else if (_high && (error < (0.0 - hysteresis)))
+    {
+        _high = false;
+        _cycleFall = (uint8_t)(_epoch - _cycleStart);
+    }
+
+    if (rising)
+    {
+        if (_state == kSfeSiT5811TuneApproach)
+            _state = kSfeSiT5811TuneSettle; // The first cycle starts now
+        else
+        {
+            // A cycle is complete: from the last low to high switch to this one
+            uint8_t period = (uint8_t)(_epoch - _cycleStart);
+            _centerHz = _cycleSumHz / (double)period; // The relay output averages to the frequency which holds the time error
+
+            if (_state == kSfeSiT5811TuneSettle)
+                _state = kSfeSiT5811TuneMeasure; // Discard the first cycle: it started from an unknown center
+            else if (measureCycle(period))
+            {
+                _measured++;
+                if (_measured >= _cycles)
+                {
+                    propose();
+                    finish((_Pk > 0.0) ? kSfeSiT5811TuneDone : kSfeSiT5811TuneFailed);
+                    return _state;
+                }
+            }
+        }
+
+        _cycleStart = _epoch;
+        _cycleFall = 0;
+        _cycleSumHz = 0.0;
+    }
+
+    if (_state != kSfeSiT5811TuneApproach)
+    {
+        uint32_t index = _epoch - _cycleStart;
+        if (index >= kSfeSiT5811TuneMaxPeriod)
+        {
+            finish(kSfeSiT5811TuneFailed); // The cycle is too long to measure
+            return _state;
+        }
+        _cycleError[index] = error;
+    }
+
+    double output = _high ? (_centerHz + _stepHz) : (_centerHz - _stepHz);
+    _cycleSumHz += output;
+
+    if (!_driver->setFrequencyHz(output))
+    {
+        finish(kSfeSiT5811TuneFailed);
+        return _state;
+    }
+
+    if (_epoch >= _maxEpochs)
+        finish(kSfeSiT5811TuneFailed);
+
+    return _state;
+}
+
+/// @brief PRIVATE: Measure the plant gain and delay from the completed cycle
+/// The first harmonics of the error and of the relay output, over the cycle, give the plant response
+/// G at the cycle frequency w. A sampled integrator with delay L has G = K / (2.sin(w/2)) at an
+/// angle of pi/2 - w.L (the error falls as the frequency rises, hence +pi/2 not -pi/2).
+/// @param period the cycle length in updates
+/// @return false if the response could not be measured
+bool SfeSiT5811AutoTune::measureCycle(uint8_t period)
+{
+    if ((period < 2) || (_cycleFall == 0) || (_cycleFall >= period))
+        return false;
+
+    // The switches were triggered by the error crossing the hysteresis, often helped by the GNSS noise.
+    // That noise is correlated with the relay and would bias the response: interpolate over it
+    _cycleError[0] = 0.5 * (_cycleError[period - 1] + _cycleError[1]);
+    _cycleError[_cycleFall] = 0.5 * (_cycleError[_cycleFall - 1] + _cycleError[(_cycleFall + 1) % period]);
+
+    // The phasor rotates once per cycle. The constant center does not contribute to the harmonic
+    double w = 2.0 * kSfeSiT5811TunePi / (double)period;
+    double stepCos = cos(w);
+    double stepSin = sin(w);
+    double phasorCos = 1.0;
+    double phasorSin = 0.0;
+    double eRe = 0.0, eIm = 0.0, uRe = 0.0, uIm = 0.0;
+    for (uint8_t k = 0; k < period; k++)
+    {
+        double u = (k < _cycleFall) ? _stepHz : (0.0 - _stepHz);
+        eRe += _cycleError[k] * phasorCos; // Sum of x.exp(-j.w.k)
+        eIm -= _cycleError[k] * phasorSin;
+        uRe += u * phasorCos;
+        uIm -= u * phasorSin;
+
+        double c = (phasorCos * stepCos) - (phasorSin * stepSin);
+        phasorSin = (phasorSin * stepCos) + (phasorCos * stepSin);
+        phasorCos = c;
+    }
+
+    double uMag2 = (uRe * uRe) + (uIm * uIm);
+    if (uMag2 <= 0.0)
+        return false;
+
+    // G = E / U
+    double gRe = ((eRe * uRe) + (eIm * uIm)) / uMag2;
+    double gIm = ((eIm * uRe) - (eRe * uIm)) / uMag2;
+
+    // Remove the integrator: K.exp(-j.w.L) = G.2.sin(w/2).exp(-j.pi/2). Sum it as a complex number, so the
+    // GNSS noise, which has a random phase in each cycle, averages out instead of inflating K
+    double scale = 2.0 * sin(w * 0.5);
+    _sumRe += gIm * scale;
+    _sumIm -= gRe * scale;
+    _sumW += w;
+    return true;
+}
+
+/// @brief PRIVATE: Calculate Ku and Tu from the measurements, and propose the gains with the rule
+/// The loop phase reaches -180 degrees where the delay adds 90 degrees to the integrator's 90:
+/// w = pi / (2.L), or the Nyquist frequency if that is lower. Ku is the inverse of the plant gain there.
+void SfeSiT5811AutoTune::propose(void)
+{
+    if (_measured == 0)
+        return;
+
+    double re = _sumRe / (double)_measured;
+    double im = _sumIm / (double)_measured;
+    _plantGain = sqrt((re * re) + (im * im));
+    _plantDelay = (0.0 - atan2(im, re)) / (_sumW / (double)_measured);
+    if ((_plantGain <= 0.0) || (_plantDelay <= 0.0))
+        return; // Noise swamped the measurement
+
+    double w = kSfeSiT5811TunePi / (2.0 * _plantDelay);
+    if (w > kSfeSiT5811TunePi)
+        w = kSfeSiT5811TunePi; // One update per second
+
+    _ultimatePeriod = 2.0 * kSfeSiT5811TunePi / w;
+    _ultimateGain = 2.0 * sin(w * 0.5) / _plantGain;
+
+    double Ti;
+    if (_rule == kSfeSiT5811TuneTyreusLuyben)
+    {
+        _Pk = _ultimateGain / 3.2;
+        Ti = 2.2 * _ultimatePeriod;
+    }
+    else
+    {
+        _Pk = 0.45 * _ultimateGain;
+        Ti = _ultimatePeriod / 1.2;
+    }
+
+    _Ik = _Pk / Ti; // Times the one second epoch
+}
+
+/// @brief PRIVATE: Finish: set the center frequency and reseed the discipline. Keep its learned drift
+/// @param state kSfeSiT5811TuneDone or kSfeSiT5811TuneFailed
+void SfeSiT5811AutoTune::finish(sfe_SiT5811_tune_state_t state)
+{
+    _state = state;
+
+    // The PI loop starts from the estimated center, or from where it was if tuning failed
+    _driver->setFrequencyHz((state == kSfeSiT5811TuneDone) ? _centerHz : _startHz);
+    _driver->reseedDiscipline();
+}
@@ -0,0 +1,200 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_AutoTune.h
+
+    Description:
+    Relay-feedback auto-tuning of the setFrequencyByBiasMillis PI gains (Pk and Ik).
+
+    Instead of the PI loop, the tuner steers the OCXO with a relay: the frequency is set to
+    center + amplitude when the time error (the bias) says the oscillator is behind, and to
+    center - amplitude when it is ahead. The amplitude is half the driver's maximum
+    frequency change (setMaxFrequencyChangePPB) unless set smaller, so each switch respects
+    the slew limit. Tune once the loop is locked: the relay cannot follow an offset larger
+    than the amplitude. The relay has hysteresis (default 10ns) so GNSS noise does not make
+    it chatter.
+
+    The time error then oscillates around zero. For each cycle, the first harmonic of the
+    error is divided by the first harmonic of the relay output. That is the plant's response
+    at the cycle frequency, averaged over the whole cycle so the GNSS noise largely cancels.
+    (The classic describing function, Ku = 4d / (pi.a), uses the error peaks instead: with
+    GNSS noise and hysteresis it under-reads Ku many times over.) The plant is an integrator
+    - one Hz for one second is one clock cycle of error - with a delay: the receiver
+    reporting and the register write. So each cycle gives K.exp(-j.w.L), with the plant gain
+    K (ideally 1) and the delay L. These are averaged as complex numbers, so the noise
+    cancels instead of inflating K. From the average:
+        w = pi / (2.L), where the delay adds 90 degrees to the integrator's 90 (at most pi)
+        Ultimate period Tu = 2.pi / w (4.L)
+        Ultimate gain Ku = 2.sin(w/2) / K, in the units of Pk: Hz per clock cycle of error
+        (approx. pi / (2.K.L) when L is long: the 2.sin(w/2) is the sampled integrator)
+    and the PI gains are proposed with the selected rule:
+        Ziegler-Nichols: Pk = 0.45 Ku, Ti = Tu / 1.2
+        Tyreus-Luyben: Pk = Ku / 3.2, Ti = 2.2 Tu (less overshoot, less noise, slower)
+        Ik = Pk * epoch / Ti, with the one second epoch of setFrequencyByBiasMillis
+    The center frequency is re-estimated every cycle: the relay output averages to the
+    frequency which holds the time error steady. When tuning completes, the OCXO is set to
+    that frequency and the discipline is reset, so the PI loop starts from it.
+
+    Each cycle's error is buffered (kSfeSiT5811TuneMaxPeriod samples). A longer cycle fails
+    the tuning: increase the amplitude or reduce the hysteresis.
+
+    Usage:
+        SfeSiT5811AutoTune myTuner;
+        myTuner.begin(&myOCXO);
+        while (!myTuner.isFinished())
+            myTuner.update(bias); // Once per bias, instead of setFrequencyByBiasMillis
+        myOCXO.setFrequencyByBiasMillis(bias, myTuner.getPk(), myTuner.getIk());
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811.h"
+
+const uint8_t kSfeSiT5811TuneMaxPeriod = 64; // The longest relay cycle (updates) which can be measured
+
+// The tuning rule used to propose Pk and Ik
+typedef enum
+{
+    kSfeSiT5811TuneZieglerNichols = 0,
+    kSfeSiT5811TuneTyreusLuyben
+} sfe_SiT5811_tune_rule_t;
+
+// The tuner state
+typedef enum
+{
+    kSfeSiT5811TuneIdle = 0, // begin has not been called
+    kSfeSiT5811TuneApproach, // Waiting for the time error to cross zero for the first time
+    kSfeSiT5811TuneSettle, // Discarding the first cycle
+    kSfeSiT5811TuneMeasure, // Measuring the cycles
+    kSfeSiT5811TuneDone, // getPk and getIk are valid
+    kSfeSiT5811TuneFailed // Timed out, a cycle was too long, or a write failed. The OCXO is back at the starting frequency
+} sfe_SiT5811_tune_state_t;
+
+class SfeSiT5811AutoTune
+{
+public:
+    SfeSiT5811AutoTune()
+        : _driver{nullptr}, _rule{kSfeSiT5811TuneZieglerNichols}, _amplitudePPB{0.0}, _hysteresisSeconds{10.0e-9},
+          _cycles{8}, _maxEpochs{3600}, _state{kSfeSiT5811TuneIdle}
+    {
+    }
+
+    /// @brief Start tuning. Call update with each bias from now on
+    /// @param driver the driver to tune. It must be initialized (begin) with its base frequency set
+    /// @return true if tuning started
+    bool begin(SfeSiT5811Driver *driver);
+
+    /// @brief Set the relay amplitude
+    /// @param ppb the frequency step either side of the center. 0 (default) or more than half the
+    ///        driver's maximum frequency change: half the maximum frequency change
+    void setAmplitudePPB(double ppb) { _amplitudePPB = ppb; }
+
+    /// @brief Set the relay hysteresis
+    /// @param seconds the time error dead band. Default: 10e-9. Use approx. twice the GNSS noise
+    void setHysteresis(double seconds) { _hysteresisSeconds = seconds; }
+
+    /// @brief Set the number of cycles to measure, after the first
+    /// @param cycles Default: 8
+    void setCycles(uint8_t cycles) { _cycles = (cycles == 0) ? 1 : cycles; }
+
+    /// @brief Set the tuning rule
+    /// @param rule kSfeSiT5811TuneZieglerNichols (default) or kSfeSiT5811TuneTyreusLuyben
+    void setRule(sfe_SiT5811_tune_rule_t rule);
+
+    /// @brief Set the time limit
+    /// @param epochs give up after this many updates. Default: 3600
+    void setMaxEpochs(uint32_t epochs) { _maxEpochs = epochs; }
+
+    /// @brief Perform one relay step
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @return the tuner state
+    sfe_SiT5811_tune_state_t update(double bias);
+
+    /// @brief Get the tuner state
+    sfe_SiT5811_tune_state_t getState(void) { return _state; }
+
+    /// @brief Check if tuning has finished: done or failed
+    bool isFinished(void) { return (_state == kSfeSiT5811TuneDone) || (_state == kSfeSiT5811TuneFailed); }
+
+    /// @brief Get the number of updates since begin
+    uint32_t getEpochs(void) { return _epoch; }
+
+    /// @brief Get the measured plant gain K: clock cycles of error per Hz per second. Ideally 1
+    double getPlantGain(void) { return _plantGain; }
+
+    /// @brief Get the measured plant delay L in seconds
+    double getPlantDelay(void) { return _plantDelay; }
+
+    /// @brief Get the ultimate gain Ku, in Hz per clock cycle (the units of Pk)
+    double getUltimateGain(void) { return _ultimateGain; }
+
+    /// @brief Get the ultimate period Tu, in seconds
+    double getUltimatePeriod(void) { return _ultimatePeriod; }
+
+    /// @brief Get the proposed Proportional term. Zero until done
+    double getPk(void) { return _Pk; }
+
+    /// @brief Get the proposed Integral term. Zero until done
+    double getIk(void) { return _Ik; }
+
+    /// @brief Get the estimated center frequency: the frequency which holds the time error steady, in Hz
+    double getCenterFrequencyHz(void) { return _centerHz; }
+
+private:
+    /// @brief Measure the plant gain and delay from the completed cycle
+    /// @param period the cycle length in updates
+    /// @return false if the response could not be measured
+    bool measureCycle(uint8_t period);
+
+    /// @brief Calculate Ku and Tu from the measurements, and propose the gains with the rule
+    void propose(void);
+
+    /// @brief Finish: set the center frequency and reseed the discipline. Keep its learned drift
+    /// @param state kSfeSiT5811TuneDone or kSfeSiT5811TuneFailed
+    void finish(sfe_SiT5811_tune_state_t state);
+
+    SfeSiT5811Driver *_driver;
+    sfe_SiT5811_tune_rule_t _rule;
+    double _amplitudePPB;
+    double _hysteresisSeconds;
+    uint8_t _cycles;
+    uint32_t _maxEpochs;
+
+    sfe_SiT5811_tune_state_t _state;
+    double _startHz; // The frequency when begin was called
+    double _centerHz; // The relay center
+    double _stepHz; // The relay amplitude
+    double _clocksPerMilli; // Bias (ms) to clock cycles
+    bool _high; // true: the relay output is center + amplitude
+    uint32_t _epoch;
+
+    // The current cycle: from one low to high switch to the next
+    uint32_t _cycleStart;
+    uint8_t _cycleFall; // The update in the cycle where the relay switched low
+    double _cycleSumHz; // The sum of the relay output
+    double _cycleError[kSfeSiT5811TuneMaxPeriod]; // Clock cycles
+
+    // The measured cycles
+    uint8_t _measured;
+    double _sumRe; // The sum of K.exp(-j.w.L)
+    double _sumIm;
+    double _sumW; // The sum of the cycle frequencies (radians per update)
+
+    double _plantGain;
+    double _plantDelay;
+
+    double _ultimateGain;
+    double _ultimatePeriod;
+    double _Pk;
+    double _Ik;
+};
@@ -0,0 +1,226 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Bank.cpp
+
+    Description:
+    A bank of SiT5811s sharing one bus, with a single-pass address scan and batched updates.
+
+*/
+
+#include "SparkFun_SiT5811_Bank.h"
+
+/// @brief Set the shared bus and this device's address
+/// @param sharedBus the bus shared by all the devices. It must support setAddress
+/// @param address the (7-bit) device address
+void SfeSiT5811AddressedBus::attach(SfeSiT5811Bus *sharedBus, uint8_t address)
+{
+    _sharedBus = sharedBus;
+    _address = address;
+}
+
+sfe_SiT5811_err_t SfeSiT5811AddressedBus::ping(void)
+{
+    sfe_SiT5811_err_t result = select();
+    if (result != kSfeSiT5811ErrOk)
+        return result;
+    return _sharedBus->ping();
+}
+
+sfe_SiT5811_err_t SfeSiT5811AddressedBus::readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes)
+{
+    readBytes = 0;
+    sfe_SiT5811_err_t result = select();
+    if (result != kSfeSiT5811ErrOk)
+        return result;
+    return _sharedBus->readRegisterRegion(reg, data, numBytes, readBytes);
+}
+
+sfe_SiT5811_err_t SfeSiT5811AddressedBus::writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    sfe_SiT5811_err_t result = select();
+    if (result != kSfeSiT5811ErrOk)
+        return result;
+    return _sharedBus->writeRegisterRegion(reg, data, numBytes);
+}
+
+sfe_SiT5811_err_t SfeSiT5811AddressedBus::startWriteRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    sfe_SiT5811_err_t result = select();
+    if (result != kSfeSiT5811ErrOk)
+        return result;
+    return _sharedBus->startWriteRegisterRegion(reg, data, numBytes);
+}
+
+sfe_SiT5811_err_t SfeSiT5811AddressedBus::pollWrite(void)
+{
+    if (_sharedBus == nullptr)
+        return kSfeSiT5811ErrBusNotInit;
+    return _sharedBus->pollWrite(); // The write in progress already has its address
+}
+
+/// @brief PRIVATE: Select this device's address on the shared bus
+sfe_SiT5811_err_t SfeSiT5811AddressedBus::select(void)
+{
+    if (_sharedBus == nullptr)
+        return kSfeSiT5811ErrBusNotInit;
+    return _sharedBus->setAddress(_address);
+}
+
+/// @brief Attach the device to the shared bus and read its registers in a single transaction
+/// @param sharedBus the bus shared by all the devices. It must support setAddress
+/// @param address the (7-bit) device address
+/// @return true if the device responded
+bool SfeSiT5811BankDevice::begin(SfeSiT5811Bus *sharedBus, uint8_t address)
+{
+    _addressedBus.attach(sharedBus, address);
+    setCommunicationBus(&_addressedBus);
+
+    return readAllRegisters();
+}
+
+/// @brief Scan the address range and initialize every device found - one transaction per address
+/// @param sharedBus the bus shared by all the devices. It must support setAddress
+/// @param firstAddress the first address to scan. Default: 0x50
+/// @param lastAddress the last address to scan. Default: 0x5F
+/// @return the number of devices found (limited to the bank capacity)
+uint8_t SfeSiT5811Bank::begin(SfeSiT5811Bus *sharedBus, uint8_t firstAddress, uint8_t lastAddress)
+{
+    _count = 0;
+    _next = 0;
+    _writing = 0;
+    _lastUpdateWrites = 0;
+    _failures = 0;
+
+    if (sharedBus == nullptr)
+        return 0;
+
+    for (uint16_t address = firstAddress; (address <= lastAddress) && (_count < _capacity); address++)
+    {
+        SfeSiT5811BankDevice *device = &_devices[_count];
+
+        // The combined read is the presence check. If it fails, the device is reused for the next address
+        if (device->begin(sharedBus, (uint8_t)address))
+        {
+            device->setAsyncMode(true); // The setters stage the word. update() writes it
+            _count++;
+        }
+    }
+
+    _writing = _count; // No write in progress
+
+    return _count;
+}
+
+/// @brief Get a device, in address order
+/// @param index 0 to getCount() - 1
+/// @return the device, or nullptr if index is out of range
+SfeSiT5811Driver *SfeSiT5811Bank::getDevice(uint8_t index)
+{
+    if (index >= _count)
+        return nullptr;
+
+    return &_devices[index];
+}
+
+/// @brief Get a device by its address
+/// @param address the (7-bit) device address
+/// @return the device, or nullptr if no device was found at that address
+SfeSiT5811Driver *SfeSiT5811Bank::getDeviceByAddress(uint8_t address)
+{
+    for (uint8_t i = 0; i < _count; i++)
+        if (_devices[i].getAddress() == address)
+            return &_devices[i];
+
+    return nullptr;
+}
+
+/// @brief Get a device's address
+/// @param index 0 to getCount() - 1
+/// @return the address, or zero if index is out of range
+uint8_t SfeSiT5811Bank::getAddress(uint8_t index)
+{
+    if (index >= _count)
+        return 0;
+
+    return _devices[index].getAddress();
+}
+
+/// @brief Write the staged control words across the bank - round-robin, one transaction at a time
+/// @return kSfeSiT5811ErrOk if every staged word has been written, kSfeSiT5811ErrBusy if a write is
+///         in progress or words were deferred to the next update, or the error if a write failed
+sfe_SiT5811_err_t SfeSiT5811Bank::update(void)
+{
+    sfe_SiT5811_err_t status = kSfeSiT5811ErrOk;
+    sfe_SiT5811_err_t result;
+
+    _lastUpdateWrites = 0;
+
+    // Finish the write in progress first. The shared bus carries one transaction at a time
+    if (_writing < _count)
+    {
+        SfeSiT5811BankDevice *device = &_devices[_writing];
+        result = device->poll();
+        if (device->isAsyncWriting())
+            return kSfeSiT5811ErrBusy;
+
+        _writing = _count;
+        if ((result != kSfeSiT5811ErrOk) && (result != kSfeSiT5811ErrBusy))
+        {
+            _failures++;
+            status = result;
+        }
+    }
+
+    // Service each device once, starting where the last update stopped
+    for (uint8_t serviced = 0; serviced < _count; serviced++)
+    {
+        if ((_maxWritesPerUpdate != 0) && (_lastUpdateWrites >= _maxWritesPerUpdate))
+            break; // Defer the rest. Their latest words are written first next time
+
+        uint8_t index = _next;
+        _next = (_next + 1 == _count) ? 0 : _next + 1;
+
+        SfeSiT5811BankDevice *device = &_devices[index];
+        if (!device->isAsyncBusy())
+            continue; // Nothing staged
+
+        result = device->poll();
+        _lastUpdateWrites++;
+
+        if (device->isAsyncWriting()) // A non-blocking write is in progress. The bus is occupied
+        {
+            _writing = index;
+            return kSfeSiT5811ErrBusy;
+        }
+
+        if ((result != kSfeSiT5811ErrOk) && (result != kSfeSiT5811ErrBusy))
+        {
+            _failures++;
+            status = result;
+        }
+    }
+
+    if (status != kSfeSiT5811ErrOk)
+        return status;
+
+    return isBusy() ? kSfeSiT5811ErrBusy : kSfeSiT5811ErrOk;
+}
+
+/// @brief Check if any device has a staged word or a write in progress
+/// @return true if update() still has work to do
+bool SfeSiT5811Bank::isBusy(void)
+{
+    for (uint8_t i = 0; i < _count; i++)
+        if (_devices[i].isAsyncBusy())
+            return true;
+
+    return false;
+}
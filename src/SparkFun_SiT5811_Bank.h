@@ -0,0 +1,225 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Bank.h
+
+    Description:
+    A bank of SiT5811s sharing one bus, e.g. a primary, a hot spare and per-channel references.
+
+    begin scans the address range (default 0x50 to 0x5F) once. Each address gets a single
+    combined read of registers 0x00 to 0x0E (readAllRegisters): an absent device fails on the
+    address byte, a present device is initialized by the same transaction. So the whole scan
+    is one transaction per address, instead of five per device for SfeSiT5811Driver::begin.
+
+    The discovered devices are put into asynchronous mode: the setters (setFrequencyHz,
+    setFrequencyByBiasMillis, etc.) only stage the new control word. update() then writes the
+    staged words across the bank in one batch, round-robin. setMaxWritesPerUpdate bounds the
+    number of devices written per update, so the bus time per cycle stays bounded as devices
+    are added. A device which is not written in this update keeps only its latest word
+    (coalescing) and is written first next time.
+
+    Usage:
+        SfeSiT5811BankN<4> myBank; // Up to 4 devices
+        myBank.begin(&mySharedBus); // Scan 0x50 to 0x5F
+        myBank.getDevice(0)->setFrequencyByBiasMillis(bias); // Stage
+        myBank.update(); // Write
+
+    The shared bus must support setAddress (e.g. SfeSiT5811TkI2CBus). On Arduino,
+    SfeSiT5811ArdI2CBankN provides the Toolkit I2C bus.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Address Range
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t kSfeSiT5811FirstAddr = 0x50; // The lowest SiT5811 address
+const uint8_t kSfeSiT5811LastAddr = 0x5F; // The highest SiT5811 address
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Routes one device's transactions over a shared bus, selecting the device's address first
+class SfeSiT5811AddressedBus : public SfeSiT5811Bus
+{
+public:
+    SfeSiT5811AddressedBus() : _sharedBus{nullptr}, _address{0}
+    {
+    }
+
+    /// @brief Set the shared bus and this device's address
+    /// @param sharedBus the bus shared by all the devices. It must support setAddress
+    /// @param address the (7-bit) device address
+    void attach(SfeSiT5811Bus *sharedBus, uint8_t address);
+
+    /// @brief Get this device's address
+    uint8_t getAddress(void) { return _address; }
+
+    sfe_SiT5811_err_t ping(void);
+    sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes);
+    sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes);
+    sfe_SiT5811_err_t startWriteRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes);
+    sfe_SiT5811_err_t pollWrite(void);
+
+private:
+    /// @brief Select this device's address on the shared bus
+    sfe_SiT5811_err_t select(void);
+
+    SfeSiT5811Bus *_sharedBus;
+    uint8_t _address;
+};
+
+// One SiT5811 in a SfeSiT5811Bank
+class SfeSiT5811BankDevice : public SfeSiT5811Driver
+{
+public:
+    SfeSiT5811BankDevice()
+    {
+    }
+
+    /// @brief Attach the device to the shared bus and read its registers in a single transaction
+    /// @param sharedBus the bus shared by all the devices. It must support setAddress
+    /// @param address the (7-bit) device address
+    /// @return true if the device responded
+    bool begin(SfeSiT5811Bus *sharedBus, uint8_t address);
+
+    /// @brief Get the device's address
+    uint8_t getAddress(void) { return _addressedBus.getAddress(); }
+
+private:
+    SfeSiT5811AddressedBus _addressedBus;
+};
+
+class SfeSiT5811Bank
+{
+public:
+    /// @brief Scan the address range and initialize every device found - one transaction per address
+    /// @param sharedBus the bus shared by all the devices. It must support setAddress
+    /// @param firstAddress the first address to scan. Default: 0x50
+    /// @param lastAddress the last address to scan. Default: 0x5F
+    /// @return the number of devices found (limited to the bank capacity)
+    uint8_t begin(SfeSiT5811Bus *sharedBus, uint8_t firstAddress = kSfeSiT5811FirstAddr,
+                  uint8_t lastAddress = kSfeSiT5811LastAddr);
+
+    /// @brief Get the number of devices found by begin
+    uint8_t getCount(void) { return _count; }
+
+    /// @brief Get the maximum number of devices
+    uint8_t getCapacity(void) { return _capacity; }
+
+    /// @brief Get a device, in address order
+    /// @param index 0 to getCount() - 1
+    /// @return the device, or nullptr if index is out of range
+    SfeSiT5811Driver *getDevice(uint8_t index);
+
+    /// @brief Get a device by its address
+    /// @param address the (7-bit) device address
+    /// @return the device, or nullptr if no device was found at that address
+    SfeSiT5811Driver *getDeviceByAddress(uint8_t address);
+
+    /// @brief Get a device's address
+    /// @param index 0 to getCount() - 1
+    /// @return the address, or zero if index is out of range
+    uint8_t getAddress(uint8_t index);
+
+    /// @brief Limit the number of devices written by each update
+    /// @param writes the maximum writes per update. 0 (default): no limit
+    void setMaxWritesPerUpdate(uint8_t writes) { _maxWritesPerUpdate = writes; }
+
+    /// @brief Get the maximum number of devices written by each update
+    uint8_t getMaxWritesPerUpdate(void) { return _maxWritesPerUpdate; }
+
+    /// @brief Write the staged control words across the bank - round-robin, one transaction at a time
+    /// @return kSfeSiT5811ErrOk if every staged word has been written, kSfeSiT5811ErrBusy if a write is
+    ///         in progress or words were deferred to the next update, or the error if a write failed
+    sfe_SiT5811_err_t update(void);
+
+    /// @brief Check if any device has a staged word or a write in progress
+    /// @return true if update() still has work to do
+    bool isBusy(void);
+
+    /// @brief Get the number of devices written by the last update
+    uint8_t getLastUpdateWrites(void) { return _lastUpdateWrites; }
+
+    /// @brief Get the number of failed writes since begin
+    uint32_t getFailures(void) { return _failures; }
+
+protected:
+    /// @brief Constructor. The devices are provided by SfeSiT5811BankN
+    SfeSiT5811Bank(SfeSiT5811BankDevice *devices, uint8_t capacity)
+        : _devices{devices}, _capacity{capacity}, _count{0}, _next{0}, _writing{0}, _maxWritesPerUpdate{0},
+          _lastUpdateWrites{0}, _failures{0}
+    {
+    }
+
+private:
+    SfeSiT5811BankDevice *_devices;
+    uint8_t _capacity; // The number of devices available
+    uint8_t _count; // The number of devices found
+    uint8_t _next; // The next device to service - round-robin
+    uint8_t _writing; // The device whose write is in progress. _count if none
+    uint8_t _maxWritesPerUpdate; // 0: no limit
+    uint8_t _lastUpdateWrites;
+    uint32_t _failures;
+};
+
+/// @brief The bank, with its devices. Devices is the maximum number of SiT5811s
+template <uint8_t Devices> class SfeSiT5811BankN : public SfeSiT5811Bank
+{
+public:
+    static_assert((Devices >= 1) && (Devices <= 16), "Devices must be 1 to 16");
+
+    SfeSiT5811BankN() : SfeSiT5811Bank(_store, Devices)
+    {
+    }
+
+private:
+    SfeSiT5811BankDevice _store[Devices];
+};
+
+#if defined(ARDUINO)
+
+/// @brief A bank of SiT5811s on an Arduino I2C port
+template <uint8_t Devices> class SfeSiT5811ArdI2CBankN : public SfeSiT5811BankN<Devices>
+{
+public:
+    SfeSiT5811ArdI2CBankN()
+    {
+    }
+
+    /// @brief Scan the address range on the specified I2C port and initialize every device found
+    /// @param wirePort the I2C port. Default: Wire
+    /// @param firstAddress the first address to scan. Default: 0x50
+    /// @param lastAddress the last address to scan. Default: 0x5F
+    /// @return the number of devices found
+    uint8_t begin(TwoWire &wirePort = Wire, uint8_t firstAddress = kSfeSiT5811FirstAddr,
+                  uint8_t lastAddress = kSfeSiT5811LastAddr)
+    {
+        if (_theI2CBus.init(wirePort, firstAddress) != kSTkErrOk)
+            return 0;
+
+        _theTkBus.setI2CBus(&_theI2CBus);
+
+        _theI2CBus.setStop(false); // Use restarts not stops for I2C reads
+
+        return SfeSiT5811Bank::begin(&_theTkBus, firstAddress, lastAddress);
+    }
+
+private:
+    sfeTkArdI2C _theI2CBus;
+    SfeSiT5811TkI2CBus _theTkBus;
+};
+
+#endif // defined(ARDUINO)
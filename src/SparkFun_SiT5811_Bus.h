@@ -0,0 +1,105 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Bus.h
+
+    Description:
+    The bus interface used by SfeSiT5811Driver.
+    The driver only needs three operations: ping, read a register region and
+    write a register region. The others (non-blocking writes, addressing and bus
+    recovery) are optional. Keeping the interface this small means the driver
+    can talk through the SparkFun Toolkit on Arduino, or through an in-memory
+    register file (SfeSiT5811RegisterFile) on a host PC.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Bus Status Codes
+///////////////////////////////////////////////////////////////////////////////
+// These follow the SparkFun Toolkit convention: zero is success, negative is
+// an error. Toolkit error codes are passed through unchanged.
+
+typedef int32_t sfe_SiT5811_err_t;
+
+const sfe_SiT5811_err_t kSfeSiT5811ErrOk = 0; // Success
+const sfe_SiT5811_err_t kSfeSiT5811ErrFail = -1; // General failure
+const sfe_SiT5811_err_t kSfeSiT5811ErrBusNotInit = -2; // Bus has not been initialized
+const sfe_SiT5811_err_t kSfeSiT5811ErrBusy = 1; // Warning: a non-blocking transaction is still in progress
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Bus
+{
+public:
+    virtual ~SfeSiT5811Bus()
+    {
+    }
+
+    /// @brief Check that the device is present on the bus
+    /// @return kSfeSiT5811ErrOk if the device responds
+    virtual sfe_SiT5811_err_t ping(void) = 0;
+
+    /// @brief Read a block of bytes, starting at register address reg
+    /// @param reg the (8-bit) register address
+    /// @param data pointer to the buffer which will hold the bytes
+    /// @param numBytes the number of bytes to read
+    /// @param readBytes returns the number of bytes actually read
+    /// @return kSfeSiT5811ErrOk if the read is successful
+    virtual sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes) = 0;
+
+    /// @brief Write a block of bytes, starting at register address reg
+    /// @param reg the (8-bit) register address
+    /// @param data pointer to the bytes to be written
+    /// @param numBytes the number of bytes to write
+    /// @return kSfeSiT5811ErrOk if the write is successful
+    virtual sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes) = 0;
+
+    /// @brief Start a write without waiting for it to complete
+    /// The data must remain valid until pollWrite returns something other than kSfeSiT5811ErrBusy.
+    /// The default implementation is a blocking writeRegisterRegion, which is all Arduino Wire can do.
+    /// @param reg the (8-bit) register address
+    /// @param data pointer to the bytes to be written
+    /// @param numBytes the number of bytes to write
+    /// @return kSfeSiT5811ErrOk if the write has completed, kSfeSiT5811ErrBusy if it is in progress, or an error
+    virtual sfe_SiT5811_err_t startWriteRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+    {
+        return writeRegisterRegion(reg, data, numBytes);
+    }
+
+    /// @brief Check on a write started by startWriteRegisterRegion
+    /// @return kSfeSiT5811ErrOk if the write has completed, kSfeSiT5811ErrBusy if it is in progress, or an error
+    virtual sfe_SiT5811_err_t pollWrite(void)
+    {
+        return kSfeSiT5811ErrOk;
+    }
+
+    /// @brief Change the device address used by the following transactions - for buses shared by several devices
+    /// The default implementation does not support addressing.
+    /// @param address the (7-bit) device address
+    /// @return kSfeSiT5811ErrOk if the address was changed
+    virtual sfe_SiT5811_err_t setAddress(uint8_t address)
+    {
+        (void)address;
+        return kSfeSiT5811ErrFail;
+    }
+
+    /// @brief Recover a stuck bus - e.g. clock SCL until the device releases SDA, then send a stop
+    /// The default implementation does not support recovery.
+    /// @return kSfeSiT5811ErrOk if the bus was recovered
+    virtual sfe_SiT5811_err_t recoverBus(void)
+    {
+        return kSfeSiT5811ErrFail;
+    }
+};
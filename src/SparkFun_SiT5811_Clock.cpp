@@ -0,0 +1,62 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Clock.cpp
+
+    Description:
+    The time source shared by the library.
+
+*/
+
+#include "SparkFun_SiT5811_Clock.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+/// @brief Get the time in milliseconds
+/// @param clock the override clock. nullptr (default): millis() on Arduino, CLOCK_MONOTONIC on a host, else 0
+/// @return the time in milliseconds. It wraps at 32 bits: subtract times as uint32_t
+uint32_t sfeSiT5811Millis(uint32_t (*clock)(void))
+{
+    if (clock != nullptr)
+        return clock();
+
+#if defined(ARDUINO)
+    return millis();
+#elif defined(__unix__) || defined(__APPLE__)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000));
+#else
+    return 0; // No clock. Call setClock
+#endif
+}
+
+/// @brief Get the time in microseconds
+/// @param clock the override clock. nullptr (default): micros() on Arduino, CLOCK_MONOTONIC on a host, else 0
+/// @return the time in microseconds. It wraps at 32 bits (71 minutes): subtract times as uint32_t
+uint32_t sfeSiT5811Micros(uint32_t (*clock)(void))
+{
+    if (clock != nullptr)
+        return clock();
+
+#if defined(ARDUINO)
+    return micros();
+#elif defined(__unix__) || defined(__APPLE__)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000));
+#else
+    return 0; // No clock. Call setClock
+#endif
+}
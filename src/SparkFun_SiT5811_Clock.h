@@ -0,0 +1,35 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Clock.h
+
+    Description:
+    The time source shared by the library: millis() and micros() on Arduino, or
+    CLOCK_MONOTONIC on a POSIX host. Elsewhere there is no clock and the time is zero.
+
+    Each class which keeps time has a setClock: the clock passed to it overrides the
+    default, e.g. to simulate time on a host, or to use a hardware timer. Pass that
+    clock to sfeSiT5811Millis or sfeSiT5811Micros.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+/// @brief Get the time in milliseconds
+/// @param clock the override clock. nullptr (default): millis() on Arduino, CLOCK_MONOTONIC on a host, else 0
+/// @return the time in milliseconds. It wraps at 32 bits: subtract times as uint32_t
+uint32_t sfeSiT5811Millis(uint32_t (*clock)(void) = nullptr);
+
+/// @brief Get the time in microseconds
+/// @param clock the override clock. nullptr (default): micros() on Arduino, CLOCK_MONOTONIC on a host, else 0
+/// @return the time in microseconds. It wraps at 32 bits (71 minutes): subtract times as uint32_t
+uint32_t sfeSiT5811Micros(uint32_t (*clock)(void) = nullptr);
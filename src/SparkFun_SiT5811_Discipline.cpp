@@ -0,0 +1,296 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Discipline.cpp
+
+    Description:
+    The clock discipline controller used by SfeSiT5811Driver::setFrequencyByBiasMillis: PI or Kalman.
+
+*/
+
+#include "SparkFun_SiT5811_Discipline.h"
+
+// The weight of each new block in the learned drift. A time constant of approx. 8 blocks
+const double kSfeSiT5811DriftWeight = 1.0 / 8.0;
+
+/// @brief Forget all state. The next update will seed the integrator from the frequency passed to seed
+void SfeSiT5811Discipline::reset(void)
+{
+    _seeded = false;
+    _I = _baseFrequencyHz;
+    _output = _baseFrequencyHz;
+    _errorClocks = 0.0;
+    if (_kalman != nullptr)
+        _kalman->reset();
+    _driftHz = 0.0;
+    restartDrift();
+    _slewLimited = 0;
+    _pullLimited = 0;
+}
+
+/// @brief Seed the integrator (and the slew limiter) with the current oscillator frequency
+/// Keep the learned drift and the limit counters. Call reset first for a cold start
+/// @param freq the current oscillator frequency in Hz
+void SfeSiT5811Discipline::seed(double freq)
+{
+    _I = freq; // Initialize I with the current frequency for a more reasonable startup
+    _output = freq;
+    _seeded = true;
+    if (_kalman != nullptr)
+        _kalman->reset(); // The filter initializes from the seeded output on the next update
+    restartDrift(); // The integrator jumps here. Do not learn a drift across the jump
+}
+
+/// @brief Restore the integrator and the learned drift - e.g. from a warm-start snapshot
+/// @param integratorHz the integrator (oscillator frequency) in Hz. It is limited to the pull range
+/// @param driftHz the learned drift in Hz per update
+void SfeSiT5811Discipline::restore(double integratorHz, double driftHz)
+{
+    if (integratorHz > _maxFrequencyHz)
+        integratorHz = _maxFrequencyHz;
+    else if (integratorHz < _minFrequencyHz)
+        integratorHz = _minFrequencyHz;
+
+    _I = integratorHz;
+    _output = integratorHz;
+    _driftHz = driftHz;
+    _seeded = true;
+    if (_kalman != nullptr)
+        _kalman->reset();
+    restartDrift();
+}
+
+/// @brief Check if the controller has been seeded
+/// @return true if seed has been called since the last reset
+bool SfeSiT5811Discipline::isSeeded(void)
+{
+    return _seeded;
+}
+
+/// @brief Set the limits. Called by the driver when the base frequency, clip or maximum change change
+/// @param baseFrequencyHz the oscillator base frequency in Hz
+/// @param maxPullHz the available pull range in Hz. The integrator is clamped to baseFrequencyHz +/- maxPullHz (anti-windup)
+/// @param maxChangePPB the maximum frequency change per update in PPB. Limits the error and the output slew
+void SfeSiT5811Discipline::setLimits(double baseFrequencyHz, double maxPullHz, double maxChangePPB)
+{
+    _baseFrequencyHz = baseFrequencyHz;
+    _maxPullHz = maxPullHz;
+    _maxChangePPB = maxChangePPB;
+
+    updateScaling();
+}
+
+/// @brief Set the Proportional and Integral terms
+/// @param Pk the Proportional term
+/// @param Ik the Integral term
+void SfeSiT5811Discipline::setGains(double Pk, double Ik)
+{
+    _Pk = Pk;
+    _Ik = Ik;
+}
+
+/// @brief Select the steering law. The Kalman filter starts again from the current output
+/// @param mode kSfeSiT5811SteeringPI (default), kSfeSiT5811SteeringKalman2 or kSfeSiT5811SteeringKalman3
+/// @param kalman the filter for the Kalman modes. Without one, the steering law is PI
+void SfeSiT5811Discipline::setSteeringMode(sfe_SiT5811_steering_t mode, SfeSiT5811Kalman *kalman)
+{
+    _kalman = kalman;
+    _mode = (_kalman != nullptr) ? mode : kSfeSiT5811SteeringPI;
+    if (_kalman == nullptr)
+        return;
+
+    _kalman->reset();
+    if (_mode == kSfeSiT5811SteeringKalman2)
+        _kalman->setStates(2);
+    else if (_mode == kSfeSiT5811SteeringKalman3)
+        _kalman->setStates(3);
+}
+
+/// @brief Perform one update step
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @return the oscillator frequency to set, in Hz
+/// Note: call seed before the first update.
+double SfeSiT5811Discipline::update(double bias)
+{
+    bool slewLimited = false;
+    bool pullLimited = false;
+
+    double output;
+    if (_mode == kSfeSiT5811SteeringPI)
+        output = updatePI(bias, slewLimited, pullLimited);
+    else
+        output = updateKalman(bias, pullLimited);
+
+    // Slew limit: the output cannot change by more than _maxChangeHz per update
+    if (output > (_output + _maxChangeHz))
+    {
+        output = _output + _maxChangeHz;
+        slewLimited = true;
+    }
+    else if (output < (_output - _maxChangeHz))
+    {
+        output = _output - _maxChangeHz;
+        slewLimited = true;
+    }
+
+    // Keep the output within the pull range too, so the slew limiter tracks what the device can do
+    if (output > _maxFrequencyHz)
+    {
+        output = _maxFrequencyHz;
+        pullLimited = true;
+    }
+    else if (output < _minFrequencyHz)
+    {
+        output = _minFrequencyHz;
+        pullLimited = true;
+    }
+
+    if (slewLimited)
+        _slewLimited++;
+    if (pullLimited)
+        _pullLimited++;
+
+    learnDrift(pullLimited);
+
+    _output = output;
+    return output;
+}
+
+/// @brief PRIVATE: The PI law: update the integrator and return the unlimited output
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @param slewLimited set true if the error was slew limited
+/// @param pullLimited set true if the integrator was pull limited
+/// @return the output frequency in Hz, before the output limits
+double SfeSiT5811Discipline::updatePI(double bias, bool &slewLimited, bool &pullLimited)
+{
+    // Our setpoint is zero. Bias is the process value. Convert it to error in clock cycles
+    double errorInClocks = (0.0 - bias) * _clocksPerMilli;
+
+    // Limit errorInClocks to +/-_maxChangeHz
+    if (errorInClocks > _maxChangeHz)
+    {
+        errorInClocks = _maxChangeHz;
+        slewLimited = true;
+    }
+    else if (errorInClocks < (0.0 - _maxChangeHz))
+    {
+        errorInClocks = 0.0 - _maxChangeHz;
+        slewLimited = true;
+    }
+
+    _errorClocks = errorInClocks;
+
+    double P = errorInClocks * _Pk;
+    double dI = errorInClocks * _Ik;
+    _I += dI; // Add the delta to the integral
+
+    // Anti-windup: the integrator cannot usefully go beyond the pull range
+    if (_I > _maxFrequencyHz)
+    {
+        _I = _maxFrequencyHz;
+        pullLimited = true;
+    }
+    else if (_I < _minFrequencyHz)
+    {
+        _I = _minFrequencyHz;
+        pullLimited = true;
+    }
+
+    return P + _I; // Proportional plus integral
+}
+
+/// @brief PRIVATE: The Kalman law: update the filter and return the unlimited output
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @param pullLimited set true if the integrator was pull limited
+/// @return the output frequency in Hz, before the output limits
+double SfeSiT5811Discipline::updateKalman(double bias, bool &pullLimited)
+{
+    _errorClocks = (0.0 - bias) * _clocksPerMilli; // For getErrorClocks. The filter uses the raw bias
+
+    // The steering applied since the last update is the last (limited) output
+    double steeringPPB = _kalman->update(bias, (_output - _baseFrequencyHz) * _ppbPerHz);
+
+    // The integrator is the frequency which cancels the estimated free-running offset
+    _I = _baseFrequencyHz - (_kalman->getFrequencyPPB() * _hzPerPPB);
+    if (_I > _maxFrequencyHz)
+    {
+        _I = _maxFrequencyHz;
+        pullLimited = true;
+    }
+    else if (_I < _minFrequencyHz)
+    {
+        _I = _minFrequencyHz;
+        pullLimited = true;
+    }
+
+    return _baseFrequencyHz + (steeringPPB * _hzPerPPB);
+}
+
+/// @brief PRIVATE: Learn the drift from the integrator
+/// The integrator changes by a few parts in 1e10 per update with GNSS noise, much more than the aging.
+/// So compare the integrator means of consecutive blocks, and average those slowly.
+/// GNSS noise slew limits many updates even when locked, so only pull limiting invalidates a block.
+/// The first block after seed or restore is acquiring lock and is only used as the reference.
+/// @param pullLimited true if this update was pull limited
+void SfeSiT5811Discipline::learnDrift(bool pullLimited)
+{
+    if (pullLimited)
+        _blockValid = false;
+
+    _blockSum += _I;
+    _blockCount++;
+    if (_blockCount < kSfeSiT5811DriftBlock)
+        return;
+
+    double mean = _blockSum * (1.0 / (double)kSfeSiT5811DriftBlock);
+
+    if (!_blockValid)
+        _blocks = 0;
+    else if (_blocks < 3)
+        _blocks++;
+
+    if (_blocks == 3) // This block and the previous are both valid, and neither is the first
+    {
+        double slope = (mean - _lastBlockMean) * (1.0 / (double)kSfeSiT5811DriftBlock);
+        _driftHz += (slope - _driftHz) * kSfeSiT5811DriftWeight;
+    }
+
+    _lastBlockMean = mean;
+    _blockSum = 0.0;
+    _blockCount = 0;
+    _blockValid = true;
+}
+
+/// @brief PRIVATE: Start a new drift learning block. Keep the learned drift
+void SfeSiT5811Discipline::restartDrift(void)
+{
+    _blockSum = 0.0;
+    _lastBlockMean = 0.0;
+    _blockCount = 0;
+    _blockValid = true;
+    _blocks = 0;
+}
+
+/// @brief PRIVATE: Recalculate the cached scale factors. Called when the limits change
+void SfeSiT5811Discipline::updateScaling(void)
+{
+    // Bias is in milliseconds. One millisecond is base / 1000 clock cycles.
+    // (The error in clock cycles over one second is also the frequency correction in Hz)
+    _clocksPerMilli = _baseFrequencyHz * 1.0e-3;
+
+    // Calculate the maximum frequency change in clock cycles
+    _maxChangeHz = _baseFrequencyHz * _maxChangePPB * 1.0e-9;
+
+    _hzPerPPB = _baseFrequencyHz * 1.0e-9;
+    _ppbPerHz = 1.0e9 / _baseFrequencyHz;
+
+    _minFrequencyHz = _baseFrequencyHz - _maxPullHz;
+    _maxFrequencyHz = _baseFrequencyHz + _maxPullHz;
+}
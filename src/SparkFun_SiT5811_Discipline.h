@@ -0,0 +1,178 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Discipline.h
+
+    Description:
+    The clock discipline controller used by SfeSiT5811Driver::setFrequencyByBiasMillis.
+    Each driver owns one, so two OCXOs have independent integrators.
+    The controller works in Hz: the output is the frequency to be set.
+    The steering law is PI (the default) or a two- or three-state Kalman filter
+    (SfeSiT5811Kalman). Both share the slew and pull range limits. The Kalman filter is
+    attached by pointer, so it only takes memory when it is used.
+    All scale factors are calculated when the limits change, so the PI update
+    needs no divisions.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811_Kalman.h"
+
+// The steering law used by update
+typedef enum
+{
+    kSfeSiT5811SteeringPI = 0, // Proportional plus integral (default)
+    kSfeSiT5811SteeringKalman2, // Kalman filter: phase and frequency
+    kSfeSiT5811SteeringKalman3 // Kalman filter: phase, frequency and drift
+} sfe_SiT5811_steering_t;
+
+const uint16_t kSfeSiT5811DriftBlock = 1024; // The number of updates in each drift learning block
+
+class SfeSiT5811Discipline
+{
+public:
+    SfeSiT5811Discipline()
+        : _baseFrequencyHz{10000000.0}, _maxPullHz{8000.0}, _maxChangePPB{800000.0}, _Pk{0.5}, _Ik{0.1},
+          _mode{kSfeSiT5811SteeringPI}, _kalman{nullptr}
+    {
+        updateScaling();
+        reset();
+    }
+
+    /// @brief Forget all state. The next update will seed the integrator from the frequency passed to seed
+    void reset(void);
+
+    /// @brief Seed the integrator (and the slew limiter) with the current oscillator frequency
+    /// Keep the learned drift and the limit counters. Call reset first for a cold start
+    /// @param freq the current oscillator frequency in Hz
+    void seed(double freq);
+
+    /// @brief Restore the integrator and the learned drift - e.g. from a warm-start snapshot
+    /// @param integratorHz the integrator (oscillator frequency) in Hz. It is limited to the pull range
+    /// @param driftHz the learned drift in Hz per update
+    void restore(double integratorHz, double driftHz);
+
+    /// @brief Check if the controller has been seeded
+    /// @return true if seed has been called since the last reset
+    bool isSeeded(void);
+
+    /// @brief Set the limits. Called by the driver when the base frequency, clip or maximum change change
+    /// @param baseFrequencyHz the oscillator base frequency in Hz
+    /// @param maxPullHz the available pull range in Hz. The integrator is clamped to baseFrequencyHz +/- maxPullHz (anti-windup)
+    /// @param maxChangePPB the maximum frequency change per update in PPB. Limits the error and the output slew
+    void setLimits(double baseFrequencyHz, double maxPullHz, double maxChangePPB);
+
+    /// @brief Set the Proportional and Integral terms
+    /// @param Pk the Proportional term
+    /// @param Ik the Integral term
+    void setGains(double Pk, double Ik);
+
+    /// @brief Select the steering law. The Kalman filter starts again from the current output
+    /// @param mode kSfeSiT5811SteeringPI (default), kSfeSiT5811SteeringKalman2 or kSfeSiT5811SteeringKalman3
+    /// @param kalman the filter for the Kalman modes. Without one, the steering law is PI
+    void setSteeringMode(sfe_SiT5811_steering_t mode, SfeSiT5811Kalman *kalman = nullptr);
+
+    /// @brief Get the steering law
+    sfe_SiT5811_steering_t getSteeringMode(void) { return _mode; }
+
+    /// @brief Get the attached Kalman filter - to inspect its state
+    /// @return the filter, or nullptr if none is attached
+    SfeSiT5811Kalman *getKalman(void) { return _kalman; }
+
+    /// @brief Perform one update step
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @return the oscillator frequency to set, in Hz
+    /// Note: call seed before the first update.
+    double update(double bias);
+
+    /// @brief Get the integrator - in Hz
+    /// In Kalman mode this is the frequency which cancels the estimated free-running offset
+    double getIntegratorHz(void) { return _I; }
+
+    /// @brief Get the learned drift: the integrator change per update, in Hz
+    /// The integrator is averaged over blocks of kSfeSiT5811DriftBlock updates. The drift is a slow
+    /// average of the change between blocks. Blocks which include pull limited updates are not used, nor is the first block after seed or restore.
+    double getDriftHz(void) { return _driftHz; }
+
+    /// @brief Get the last output - in Hz
+    double getOutputHz(void) { return _output; }
+
+    /// @brief Get the last (limited) error - in clock cycles
+    double getErrorClocks(void) { return _errorClocks; }
+
+    /// @brief Get the Proportional term
+    double getPk(void) { return _Pk; }
+
+    /// @brief Get the Integral term
+    double getIk(void) { return _Ik; }
+
+    /// @brief Get the number of updates where the error or output were limited by maxChangePPB
+    uint32_t getSlewLimited(void) { return _slewLimited; }
+
+    /// @brief Get the number of updates where the integrator or output were limited by the pull range (anti-windup)
+    uint32_t getPullLimited(void) { return _pullLimited; }
+
+private:
+    /// @brief Recalculate the cached scale factors. Called when the limits change
+    void updateScaling(void);
+
+    /// @brief The PI law: update the integrator and return the unlimited output
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @param slewLimited set true if the error was slew limited
+    /// @param pullLimited set true if the integrator was pull limited
+    /// @return the output frequency in Hz, before the output limits
+    double updatePI(double bias, bool &slewLimited, bool &pullLimited);
+
+    /// @brief The Kalman law: update the filter and return the unlimited output
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @param pullLimited set true if the integrator was pull limited
+    /// @return the output frequency in Hz, before the output limits
+    double updateKalman(double bias, bool &pullLimited);
+
+    /// @brief Learn the drift from the integrator
+    /// @param pullLimited true if this update was pull limited
+    void learnDrift(bool pullLimited);
+
+    /// @brief Start a new drift learning block. Keep the learned drift
+    void restartDrift(void);
+
+    double _baseFrequencyHz; // The oscillator base frequency
+    double _maxPullHz; // The available pull range in Hz
+    double _maxChangePPB; // The maximum frequency change per update in PPB
+    double _Pk; // The Proportional term
+    double _Ik; // The Integral term
+    sfe_SiT5811_steering_t _mode; // The steering law
+    SfeSiT5811Kalman *_kalman; // The filter for the Kalman modes. nullptr if none is attached
+
+    // Scale factors - cached by updateScaling
+    double _clocksPerMilli; // Bias (ms) to clock cycles: base frequency / 1000
+    double _maxChangeHz; // The maximum frequency change per update in Hz
+    double _hzPerPPB; // base frequency * 1e-9
+    double _ppbPerHz; // 1e9 / base frequency
+    double _minFrequencyHz; // The lowest frequency available
+    double _maxFrequencyHz; // The highest frequency available
+
+    // State
+    bool _seeded; // true if seed has been called
+    double _I; // The integrator (Hz)
+    double _output; // The last output (Hz)
+    double _errorClocks; // The last (limited) error in clock cycles
+    double _driftHz; // The learned drift: average integrator change per update (Hz)
+    double _blockSum; // The sum of the integrator over the current block
+    double _lastBlockMean; // The mean of the integrator over the previous block
+    uint16_t _blockCount; // The number of updates in the current block
+    bool _blockValid; // false if the current block includes a limited update
+    uint8_t _blocks; // The number of consecutive valid blocks (saturates at 3)
+    uint32_t _slewLimited; // Updates limited by maxChangePPB
+    uint32_t _pullLimited; // Updates limited by the pull range
+};
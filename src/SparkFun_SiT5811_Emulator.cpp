@@ -0,0 +1,324 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Emulator.cpp
+
+    Description:
+    A model of the SiT5811 on a faulty I2C bus: registers, fault injection and bus timing.
+
+*/
+
+#include "SparkFun_SiT5811_Emulator.h"
+
+/// @brief Clear all registers, faults and counters. Restore the default timing
+void SfeSiT5811Emulator::reset(void)
+{
+    SfeSiT5811RegisterFile::reset();
+    _registerAddress = 0;
+
+    _byteMicros = 23;
+    _stretchMicros = 2000;
+    _timeoutMicros = 10000;
+
+    for (uint8_t f = 0; f < kSfeSiT5811NumFaults; f++)
+        _threshold[f] = 0;
+    setSeed(1);
+    _burstFault = kSfeSiT5811FaultNone;
+    _burstCount = 0;
+    _stuck = false;
+
+    resetCounters();
+}
+
+/// @brief Clear the transaction, byte and fault counters
+void SfeSiT5811Emulator::resetCounters(void)
+{
+    SfeSiT5811RegisterFile::resetCounters();
+    for (uint8_t f = 0; f < kSfeSiT5811NumFaults; f++)
+        _faults[f] = 0;
+    _recoveries = 0;
+}
+
+/// @brief Set the probability of a fault on each transaction
+/// @param fault the fault
+/// @param probability 0.0 (never, default) to 1.0. The total for all faults should not exceed 1.0
+void SfeSiT5811Emulator::setFaultProbability(sfe_SiT5811_fault_t fault, double probability)
+{
+    if ((fault == kSfeSiT5811FaultNone) || (fault >= kSfeSiT5811NumFaults))
+        return;
+
+    if (probability <= 0.0)
+        _threshold[fault] = 0;
+    else if (probability >= 1.0)
+        _threshold[fault] = 0xFFFFFFFF;
+    else
+        _threshold[fault] = (uint32_t)(probability * 4294967295.0);
+}
+
+/// @brief Inject a fault into the following transactions, before any random faults
+/// @param fault the fault
+/// @param count the number of transactions. Default: 1
+void SfeSiT5811Emulator::injectFault(sfe_SiT5811_fault_t fault, uint8_t count)
+{
+    if (fault >= kSfeSiT5811NumFaults)
+        return;
+
+    _burstFault = fault;
+    _burstCount = count;
+}
+
+/// @brief Seed the fault generator
+/// @param seed any value except zero
+void SfeSiT5811Emulator::setSeed(uint32_t seed)
+{
+    _random = (seed == 0) ? 1 : seed; // xorshift32 sticks at zero
+}
+
+/// @brief Get the number of transactions with a fault since the last resetCounters
+/// @param fault the fault
+/// @return the count. For kSfeSiT5811FaultStuck: every transaction which failed because the bus was stuck
+uint32_t SfeSiT5811Emulator::getFaults(sfe_SiT5811_fault_t fault)
+{
+    if (fault >= kSfeSiT5811NumFaults)
+        return 0;
+    return _faults[fault];
+}
+
+/// @brief  PRIVATE: Choose the fault for the next transaction and count the fault
+/// @return the fault
+sfe_SiT5811_fault_t SfeSiT5811Emulator::nextFault(void)
+{
+    sfe_SiT5811_fault_t fault = kSfeSiT5811FaultNone;
+
+    if (_stuck)
+        fault = kSfeSiT5811FaultStuck;
+    else if (_burstCount > 0)
+    {
+        _burstCount--;
+        fault = _burstFault;
+    }
+    else
+    {
+        // One random number picks at most one fault: the thresholds are stacked
+        uint32_t r = nextRandom();
+        for (uint8_t f = 1; f < kSfeSiT5811NumFaults; f++)
+        {
+            if (r < _threshold[f])
+            {
+                fault = (sfe_SiT5811_fault_t)f;
+                break;
+            }
+            r -= _threshold[f];
+        }
+    }
+
+    if (fault == kSfeSiT5811FaultStuck)
+        _stuck = true;
+
+    _faults[fault]++;
+    return fault;
+}
+
+/// @brief  PRIVATE: Get the next random number (xorshift32)
+uint32_t SfeSiT5811Emulator::nextRandom(void)
+{
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
+
+/// @brief  PRIVATE: Get a random clock stretch, up to the stretch time
+uint32_t SfeSiT5811Emulator::stretch(void)
+{
+    if (_stretchMicros == 0)
+        return 0;
+    return nextRandom() % (_stretchMicros + 1);
+}
+
+/// @brief  PRIVATE: Pass the time a transaction takes to the delay function
+/// @param  micros the time in microseconds
+void SfeSiT5811Emulator::wait(uint32_t micros)
+{
+    if ((_delay != nullptr) && (micros > 0))
+        _delay(micros);
+}
+
+/// @brief  PRIVATE: Fail a transaction: count it (the address byte) and pass the time it took
+/// @param  micros the time in microseconds
+/// @return kSfeSiT5811ErrFail
+sfe_SiT5811_err_t SfeSiT5811Emulator::fail(uint32_t micros)
+{
+    countTransaction(1);
+    wait(micros);
+    return kSfeSiT5811ErrFail;
+}
+
+/// @brief Check that the device is present on the bus
+/// @return kSfeSiT5811ErrOk if the address is acknowledged
+sfe_SiT5811_err_t SfeSiT5811Emulator::ping(void)
+{
+    uint32_t extra = 0;
+
+    switch (nextFault())
+    {
+    case kSfeSiT5811FaultStuck:
+        return fail(_timeoutMicros);
+    case kSfeSiT5811FaultNack:
+        return fail(_byteMicros);
+    case kSfeSiT5811FaultStretch:
+        extra = stretch();
+        if (extra >= _timeoutMicros)
+            return fail(_timeoutMicros);
+        break;
+    default:
+        break;
+    }
+
+    wait(extra + _byteMicros); // Address only
+    return SfeSiT5811RegisterFile::ping();
+}
+
+/// @brief Read a block of bytes, starting at register address reg
+/// @param reg the (8-bit) register address
+/// @param data pointer to the buffer which will hold the bytes
+/// @param numBytes the number of bytes to read
+/// @param readBytes returns the number of bytes actually read
+/// @return kSfeSiT5811ErrOk, or kSfeSiT5811ErrFail if the transaction failed. A Short read returns kSfeSiT5811ErrOk
+sfe_SiT5811_err_t SfeSiT5811Emulator::readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes)
+{
+    readBytes = 0;
+    uint32_t extra = 0;
+
+    switch (nextFault())
+    {
+    case kSfeSiT5811FaultStuck:
+        return fail(_timeoutMicros);
+    case kSfeSiT5811FaultNack:
+        return fail(_byteMicros);
+    case kSfeSiT5811FaultStretch:
+        extra = stretch();
+        if (extra >= _timeoutMicros)
+            return fail(_timeoutMicros);
+        break;
+    case kSfeSiT5811FaultShort:
+        numBytes /= 2;
+        break;
+    default:
+        break;
+    }
+
+    sfe_SiT5811_err_t result = SfeSiT5811RegisterFile::readRegisterRegion(reg, data, numBytes, readBytes);
+    wait(extra + ((3 + readBytes) * _byteMicros)); // Address + register address + repeated-start address + data
+    return result;
+}
+
+/// @brief Write a block of bytes, starting at register address reg
+/// @param reg the (8-bit) register address
+/// @param data pointer to the bytes to be written
+/// @param numBytes the number of bytes to write
+/// @return kSfeSiT5811ErrOk, or kSfeSiT5811ErrFail if the transaction failed. A Short write fails after storing half the bytes
+sfe_SiT5811_err_t SfeSiT5811Emulator::writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    uint32_t extra = 0;
+
+    switch (nextFault())
+    {
+    case kSfeSiT5811FaultStuck:
+        return fail(_timeoutMicros);
+    case kSfeSiT5811FaultNack:
+        return fail(_byteMicros);
+    case kSfeSiT5811FaultStretch:
+        extra = stretch();
+        if (extra >= _timeoutMicros)
+            return fail(_timeoutMicros);
+        break;
+    case kSfeSiT5811FaultShort:
+        SfeSiT5811RegisterFile::writeRegisterRegion(reg, data, numBytes / 2);
+        wait((3 + (numBytes / 2)) * _byteMicros); // The byte after the half is not acknowledged
+        return kSfeSiT5811ErrFail;
+    default:
+        break;
+    }
+
+    sfe_SiT5811_err_t result = SfeSiT5811RegisterFile::writeRegisterRegion(reg, data, numBytes);
+    wait(extra + ((2 + numBytes) * _byteMicros)); // Address + register address + data
+    return result;
+}
+
+/// @brief Recover the bus: clock SCL until the device releases SDA, then send a stop
+/// @return kSfeSiT5811ErrOk
+sfe_SiT5811_err_t SfeSiT5811Emulator::recoverBus(void)
+{
+    _recoveries++;
+    _stuck = false;
+    wait(_byteMicros + (_byteMicros / 9)); // Nine clocks and a stop
+    return kSfeSiT5811ErrOk;
+}
+
+/// @brief The Wire target side: the controller wrote to the device
+/// @param data the bytes: the register address, then the data to write
+/// @param numBytes the number of bytes
+void SfeSiT5811Emulator::receive(const uint8_t *data, size_t numBytes)
+{
+    if (numBytes == 0)
+        return;
+
+    switch (nextFault())
+    {
+    case kSfeSiT5811FaultStuck:
+    case kSfeSiT5811FaultNack:
+        countTransaction(1);
+        return; // Ignore the write
+    case kSfeSiT5811FaultStretch:
+        wait(stretch());
+        break;
+    case kSfeSiT5811FaultShort:
+        numBytes = 1 + ((numBytes - 1) / 2);
+        break;
+    default:
+        break;
+    }
+
+    _registerAddress = data[0];
+    storeBytes(_registerAddress, &data[1], numBytes - 1);
+    countTransaction(1 + numBytes); // Address + register address + data
+}
+
+/// @brief The Wire target side: the controller is reading from the device
+/// @param data returns the bytes to send, from the last register address written
+/// @param maxBytes the size of data
+/// @return the number of bytes to send
+size_t SfeSiT5811Emulator::request(uint8_t *data, size_t maxBytes)
+{
+    bool half = false;
+
+    switch (nextFault())
+    {
+    case kSfeSiT5811FaultStuck:
+    case kSfeSiT5811FaultNack:
+        countTransaction(1);
+        return 0; // Send nothing
+    case kSfeSiT5811FaultStretch:
+        wait(stretch());
+        break;
+    case kSfeSiT5811FaultShort:
+        half = true;
+        break;
+    default:
+        break;
+    }
+
+    size_t count = loadBytes(_registerAddress, data, maxBytes);
+    if (half)
+        count /= 2;
+    countTransaction(1 + count); // Address + data
+    return count;
+}
@@ -0,0 +1,164 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Emulator.h
+
+    Description:
+    A model of the SiT5811 on a faulty I2C bus, for testing the driver's error handling.
+
+    It is a SfeSiT5811RegisterFile (registers 0x00 to 0x0E, 16-bit, MSB first; reads run to
+    the end of the file; writes beyond it are discarded; transactions and bytes are counted)
+    which can inject bus faults into the transactions:
+        Nack:    the address is not acknowledged. Nothing is read or written
+        Short:   a read returns half the bytes; a write stores half the bytes, then the
+                 rest is not acknowledged
+        Stretch: the device holds SCL low (clock stretching) for a random time up to the
+                 stretch time (default 2ms). Longer than the bus timeout: the transaction fails
+        Stuck:   SDA is held low. Every transaction times out until recoverBus is called
+    Faults are injected at random (setFaultProbability, from a seeded generator, so every
+    run is the same) or as a burst on the following transactions (injectFault).
+
+    The model is used in two ways:
+        On a host, it is the bus: pass it to SfeSiT5811Driver::begin. Each transaction takes
+        the time it would on the wire (bytes, stretching, timeouts) and calls the delay
+        function with it, so a simulated clock can be advanced (setDelay)
+        In examples/SiT5811_Emulator, it is the register file behind the Wire target
+        callbacks: call receive from onReceive and request from onRequest. Nack and Stuck
+        are emulated by ignoring the write or sending nothing: a Wire target cannot refuse
+        the address. Stretch delays the callback, which stretches the clock on cores which
+        hold SCL during it.
+
+*/
+
+#pragma once
+
+#include "SparkFun_SiT5811_RegisterFile.h"
+
+const uint8_t kSfeSiT5811EmulatorNumRegs = kSfeSiT5811RegisterFileNumRegs; // Registers 0x00 to 0x0E
+
+typedef enum
+{
+    kSfeSiT5811FaultNone = 0, // The transaction succeeds
+    kSfeSiT5811FaultNack, // The address is not acknowledged
+    kSfeSiT5811FaultShort, // Half the bytes are transferred
+    kSfeSiT5811FaultStretch, // The device stretches the clock
+    kSfeSiT5811FaultStuck, // SDA is held low until recoverBus
+    kSfeSiT5811NumFaults
+} sfe_SiT5811_fault_t;
+
+class SfeSiT5811Emulator : public SfeSiT5811RegisterFile
+{
+public:
+    /// @brief Constructor. All registers are zero, no faults
+    SfeSiT5811Emulator() : _delay{nullptr}
+    {
+        reset();
+    }
+
+    /// @brief Clear all registers, faults and counters. Restore the default timing
+    void reset(void);
+
+    /// @brief Clear the transaction, byte and fault counters
+    void resetCounters(void);
+
+    /// @brief Set the probability of a fault on each transaction
+    /// @param fault the fault
+    /// @param probability 0.0 (never, default) to 1.0. The total for all faults should not exceed 1.0
+    void setFaultProbability(sfe_SiT5811_fault_t fault, double probability);
+
+    /// @brief Inject a fault into the following transactions, before any random faults
+    /// @param fault the fault
+    /// @param count the number of transactions. Default: 1
+    void injectFault(sfe_SiT5811_fault_t fault, uint8_t count = 1);
+
+    /// @brief Seed the fault generator
+    /// @param seed any value except zero
+    void setSeed(uint32_t seed);
+
+    /// @brief Set the time per byte on the wire
+    /// @param micros microseconds per byte (9 bit times). Default: 23 (400kHz)
+    void setByteMicros(uint32_t micros) { _byteMicros = micros; }
+
+    /// @brief Set the longest clock stretch
+    /// @param micros the stretch is random, up to this. Default: 2000
+    void setStretchMicros(uint32_t micros) { _stretchMicros = micros; }
+
+    /// @brief Set the bus timeout: how long the controller waits for a stretched or stuck bus
+    /// @param micros the timeout. Default: 10000
+    void setTimeoutMicros(uint32_t micros) { _timeoutMicros = micros; }
+
+    /// @brief Set the function which is called with the time each transaction takes
+    /// @param delay called with the time in microseconds. nullptr (default): the time is not modelled
+    /// Note: on a host, advance a simulated clock. In a Wire target, use delayMicroseconds to stretch
+    void setDelay(void (*delay)(uint32_t micros)) { _delay = delay; }
+
+    /// @brief Check if the bus is stuck
+    bool isStuck(void) { return _stuck; }
+
+    /// @brief Get the number of transactions with a fault since the last resetCounters
+    /// @param fault the fault
+    /// @return the count. For kSfeSiT5811FaultStuck: every transaction which failed because the bus was stuck
+    uint32_t getFaults(sfe_SiT5811_fault_t fault);
+
+    /// @brief Get the number of calls to recoverBus since the last resetCounters
+    uint32_t getRecoveries(void) { return _recoveries; }
+
+    /// @brief The Wire target side: the controller wrote to the device
+    /// @param data the bytes: the register address, then the data to write
+    /// @param numBytes the number of bytes
+    void receive(const uint8_t *data, size_t numBytes);
+
+    /// @brief The Wire target side: the controller is reading from the device
+    /// @param data returns the bytes to send, from the last register address written
+    /// @param maxBytes the size of data
+    /// @return the number of bytes to send
+    size_t request(uint8_t *data, size_t maxBytes);
+
+    sfe_SiT5811_err_t ping(void);
+    sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes);
+    sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes);
+    sfe_SiT5811_err_t recoverBus(void);
+
+private:
+    /// @brief Choose the fault for the next transaction and count the fault
+    /// @return the fault
+    sfe_SiT5811_fault_t nextFault(void);
+
+    /// @brief Get the next random number (xorshift32)
+    uint32_t nextRandom(void);
+
+    /// @brief Get a random clock stretch, up to the stretch time
+    uint32_t stretch(void);
+
+    /// @brief Pass the time a transaction takes to the delay function
+    /// @param micros the time in microseconds
+    void wait(uint32_t micros);
+
+    /// @brief Fail a transaction: count it (the address byte) and pass the time it took
+    /// @param micros the time in microseconds
+    /// @return kSfeSiT5811ErrFail
+    sfe_SiT5811_err_t fail(uint32_t micros);
+
+    uint8_t _registerAddress; // The last register address written - for request
+
+    void (*_delay)(uint32_t micros);
+    uint32_t _byteMicros;
+    uint32_t _stretchMicros;
+    uint32_t _timeoutMicros;
+
+    uint32_t _threshold[kSfeSiT5811NumFaults]; // Probability scaled to 2^32. _threshold[0] is unused
+    uint32_t _random;
+    sfe_SiT5811_fault_t _burstFault;
+    uint8_t _burstCount;
+    bool _stuck;
+
+    uint32_t _faults[kSfeSiT5811NumFaults];
+    uint32_t _recoveries;
+};
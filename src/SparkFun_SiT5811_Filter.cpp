@@ -0,0 +1,303 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Filter.cpp
+
+    Description:
+    A streaming pre-filter for the GNSS RX clock bias: rate gate, Hampel, median and EWMA.
+
+    The sliding median keeps the window in one array of ring indexes, centered on the median:
+    heap[0] is the median, heap[-1] is the top of a max-heap of the smaller values (children
+    of -i are -2i and -2i-1) and heap[1] is the top of a min-heap of the larger values
+    (children of i are 2i and 2i+1). position[] maps each ring entry to its heap index, so
+    the oldest value can be replaced in place and sifted up or down: O(log N). The initial
+    positions (0, -1, 1, -2, 2 ...) fill the heaps alternately while the window fills.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_Filter.h"
+
+const double kSfeSiT5811FilterMADScale = 1.4826; // MAD to standard deviation, for Gaussian noise
+
+/// @brief Forget all samples and zero the counters
+void SfeSiT5811Filter::reset(void)
+{
+    clear(_median);
+    clear(_deviation);
+    _havePassed = false;
+    _lastPassed = 0.0;
+    _consecutive = 0;
+    _haveAverage = false;
+    _average = 0.0;
+    _rejected = false;
+    _samples = 0;
+    _rateRejected = 0;
+    _hampelRejected = 0;
+}
+
+/// @brief Select the stages
+/// @param stages kSfeSiT5811Filter... ORed together. Default: Hampel
+/// Note: this resets the filter
+void SfeSiT5811Filter::setStages(uint8_t stages)
+{
+    _stages = stages;
+    reset();
+}
+
+/// @brief Configure the rate gate
+/// @param seconds the largest change in the bias from one update to the next. Default: 10e-6
+///        Set it above the largest real rate, the pull range per update (getMaxPullAvailable:
+///        1ppm is 1us per second) plus a few times the GNSS noise, so real steering is never rejected
+/// @param maxConsecutive pass a change larger than the limit once it has been seen this many times
+///        in a row. Default: 3
+void SfeSiT5811Filter::setRateGate(double seconds, uint8_t maxConsecutive)
+{
+    _rateLimitMillis = fabs(seconds) * 1.0e3;
+    _maxConsecutive = maxConsecutive;
+}
+
+/// @brief Configure the Hampel stage
+/// @param threshold reject a bias more than this many scales from the median. Default: 4
+/// @param minScaleSeconds the smallest scale, so a very quiet window does not reject everything. Default: 1e-9
+void SfeSiT5811Filter::setHampel(double threshold, double minScaleSeconds)
+{
+    _threshold = fabs(threshold);
+    _minScaleMillis = fabs(minScaleSeconds) * 1.0e3;
+}
+
+/// @brief Configure the EWMA stage
+/// @param alpha the weight of each new bias: 0 to 1. Default: 0.5
+void SfeSiT5811Filter::setEWMA(double alpha)
+{
+    if (alpha > 1.0)
+        alpha = 1.0;
+    if (alpha <= 0.0)
+        return; // The average would never move
+    _alpha = alpha;
+}
+
+/// @brief Filter one bias
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @return the filtered bias in milliseconds
+double SfeSiT5811Filter::filter(double bias)
+{
+    double x = bias;
+    _samples++;
+    _rejected = false;
+
+    if ((_stages & kSfeSiT5811FilterRateGate) != 0)
+    {
+        if (_havePassed && (fabs(x - _lastPassed) > _rateLimitMillis) && (_consecutive < _maxConsecutive))
+        {
+            _consecutive++;
+            _rateRejected++;
+            _rejected = true;
+            x = _lastPassed; // Hold the last good bias
+        }
+        else
+        {
+            _consecutive = 0;
+            _havePassed = true;
+            _lastPassed = x;
+        }
+    }
+
+    if ((_stages & (kSfeSiT5811FilterHampel | kSfeSiT5811FilterMedian)) != 0)
+    {
+        // The median of the previous biases predicts this one. Three are needed for a useful median
+        bool predicted = (_median.count >= 3);
+        double prior = medianOf(_median);
+
+        insert(_median, x);
+        double m = medianOf(_median);
+
+        if (((_stages & kSfeSiT5811FilterHampel) != 0) && predicted)
+        {
+            double deviation = fabs(x - prior);
+            insert(_deviation, deviation);
+
+            double scale = kSfeSiT5811FilterMADScale * medianOf(_deviation);
+            if (scale < _minScaleMillis)
+                scale = _minScaleMillis;
+
+            if ((_deviation.count >= 3) && !_rejected && (deviation > (_threshold * scale)))
+            {
+                _hampelRejected++;
+                _rejected = true;
+                x = prior;
+            }
+        }
+
+        if ((_stages & kSfeSiT5811FilterMedian) != 0)
+            x = m;
+    }
+
+    if ((_stages & kSfeSiT5811FilterEWMA) != 0)
+    {
+        if (_haveAverage)
+            _average += _alpha * (x - _average);
+        else
+            _average = x;
+        _haveAverage = true;
+        x = _average;
+    }
+
+    return x;
+}
+
+/// @brief Get the median of the window in milliseconds
+double SfeSiT5811Filter::getMedian(void)
+{
+    return medianOf(_median);
+}
+
+/// @brief Get the Hampel scale (1.4826 x the median absolute deviation) in seconds
+double SfeSiT5811Filter::getScale(void)
+{
+    double scale = kSfeSiT5811FilterMADScale * medianOf(_deviation);
+    if (scale < _minScaleMillis)
+        scale = _minScaleMillis;
+    return scale * 1.0e-3;
+}
+
+/// @brief PRIVATE: Empty a window
+/// @param window the window
+void SfeSiT5811Filter::clear(sfe_SiT5811_median_t &window)
+{
+    window.next = 0;
+    window.count = 0;
+
+    // The fill pattern: ring entry 0 at the median, then alternately below and above
+    for (uint8_t i = 0; i < window.size; i++)
+    {
+        int16_t p = (int16_t)((i + 1) / 2);
+        if ((i & 1) != 0)
+            p = -p;
+        window.position[i] = p;
+        window.heap[p] = i;
+        window.values[i] = 0.0;
+    }
+}
+
+/// @brief PRIVATE: Add a sample to a window, replacing the oldest once it is full
+/// @param window the window
+/// @param value the sample
+void SfeSiT5811Filter::insert(sfe_SiT5811_median_t &window, double value)
+{
+    bool filling = (window.count < window.size);
+    uint8_t entry = window.next;
+    int16_t p = window.position[entry];
+    double old = window.values[entry];
+
+    window.values[entry] = value;
+    window.next = (uint8_t)((entry + 1 == window.size) ? 0 : entry + 1);
+    if (filling)
+        window.count++;
+
+    int16_t minCount = (int16_t)((window.count - 1) / 2); // Entries in the min-heap
+    int16_t maxCount = (int16_t)(window.count / 2); // Entries in the max-heap
+
+    if (p > 0) // In the min-heap
+    {
+        if (!filling && (old < value))
+            minSortDown(window, p * 2); // It can only move down, away from the median
+        else if (minSortUp(window, p))
+            maxSortDown(window, -1); // It became the median: check it against the max-heap
+    }
+    else if (p < 0) // In the max-heap
+    {
+        if (!filling && (value < old))
+            maxSortDown(window, p * 2);
+        else if (maxSortUp(window, p))
+            minSortDown(window, 1);
+    }
+    else // The median itself
+    {
+        if (maxCount > 0)
+            maxSortDown(window, -1);
+        if (minCount > 0)
+            minSortDown(window, 1);
+    }
+}
+
+/// @brief PRIVATE: Get the median of a window
+/// @param window the window
+/// @return the median. The mean of the middle two if the count is even. Zero if empty
+double SfeSiT5811Filter::medianOf(sfe_SiT5811_median_t &window)
+{
+    if (window.count == 0)
+        return 0.0;
+
+    double m = window.values[window.heap[0]];
+    if ((window.count & 1) == 0)
+        m = 0.5 * (m + window.values[window.heap[-1]]);
+    return m;
+}
+
+/// @brief PRIVATE: Swap two heap entries if the first is less than the second
+/// @return true if they were swapped
+bool SfeSiT5811Filter::exchangeIfLess(sfe_SiT5811_median_t &window, int16_t i, int16_t j)
+{
+    if (!(window.values[window.heap[i]] < window.values[window.heap[j]]))
+        return false;
+
+    int16_t t = window.heap[i];
+    window.heap[i] = window.heap[j];
+    window.heap[j] = t;
+    window.position[window.heap[i]] = i;
+    window.position[window.heap[j]] = j;
+    return true;
+}
+
+/// @brief PRIVATE: Restore the min-heap below a child position
+/// Starting from child i, swap the smaller child with its parent until the parent is smaller
+void SfeSiT5811Filter::minSortDown(sfe_SiT5811_median_t &window, int16_t i)
+{
+    int16_t minCount = (int16_t)((window.count - 1) / 2);
+    for (; i <= minCount; i *= 2)
+    {
+        if ((i > 1) && (i < minCount) && (window.values[window.heap[i + 1]] < window.values[window.heap[i]]))
+            i++; // The smaller sibling
+        if (!exchangeIfLess(window, i, i / 2))
+            break;
+    }
+}
+
+/// @brief PRIVATE: Restore the max-heap below a child position
+/// Starting from child i, swap the larger child with its parent until the parent is larger
+void SfeSiT5811Filter::maxSortDown(sfe_SiT5811_median_t &window, int16_t i)
+{
+    int16_t maxCount = (int16_t)(window.count / 2);
+    for (; i >= (0 - maxCount); i *= 2)
+    {
+        if ((i < -1) && (i > (0 - maxCount)) && (window.values[window.heap[i]] < window.values[window.heap[i - 1]]))
+            i--; // The larger sibling
+        if (!exchangeIfLess(window, i / 2, i))
+            break;
+    }
+}
+
+/// @brief PRIVATE: Move a min-heap entry up. Returns true if it reached the median
+bool SfeSiT5811Filter::minSortUp(sfe_SiT5811_median_t &window, int16_t i)
+{
+    while ((i > 0) && exchangeIfLess(window, i, i / 2))
+        i /= 2;
+    return (i == 0);
+}
+
+/// @brief PRIVATE: Move a max-heap entry up. Returns true if it reached the median
+bool SfeSiT5811Filter::maxSortUp(sfe_SiT5811_median_t &window, int16_t i)
+{
+    while ((i < 0) && exchangeIfLess(window, i / 2, i))
+        i /= 2;
+    return (i == 0);
+}
@@ -0,0 +1,231 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Filter.h
+
+    Description:
+    A streaming pre-filter for the GNSS RX clock bias, in front of setFrequencyByBiasMillis.
+    A single bad bias would otherwise saturate the step at the maximum frequency change and
+    kick the integrator.
+
+    The stages run in this order. Each can be enabled on its own (setStages):
+        Rate gate - rejects a bias which changed by more than the limit since the last one
+            it passed: a gross error, faster than the OCXO can move. A real step (e.g. a
+            receiver clock reset) is passed after the limit has been exceeded for
+            maxConsecutive updates in a row. The limit must be above the pull range per
+            update: a gate which rejects real steering hides it from the loop. O(1)
+        Hampel - rejects a bias further than threshold x scale from the median of the
+            previous N biases. The scale is 1.4826 x the median of the last ScaleWindow
+            absolute deviations from that median (a running MAD), with a floor. Comparing
+            with the previous window, not one which already holds the new bias, keeps the
+            false rejections close to the Gaussian rate. With N = 9 and Gaussian noise,
+            approx. 0.07% are rejected at the default threshold of 4 (0.7% at 3). O(log N)
+        Median - outputs the median of the window. O(log N)
+        EWMA - an exponentially weighted moving average: y += alpha * (x - y). O(1)
+    A rejected bias is replaced, so the discipline still steps once per bias: by the last
+    bias passed (rate gate) or by the median of the previous N (Hampel). getRejected counts them.
+
+    The rate gate and Hampel stages add no delay to good samples. Hampel is enabled by default.
+    The median and EWMA stages smooth the bias, but delay it: the median by (N - 1) / 2
+    updates and the EWMA by approx. (1 - alpha) / alpha. The PI loop is tuned for one update
+    of delay, so reduce Pk and Ik (or re-tune with SfeSiT5811AutoTune) if you enable them.
+
+    The window medians use a pair of indexed heaps (a max-heap below the median and a
+    min-heap above), so each sample is O(log N) with no sorting and no heap allocation.
+    Memory is approx. 8 x (N + ScaleWindow) bytes (12 x with a 64-bit double).
+
+    Usage:
+        SfeSiT5811FilterN<9> myFilter; // 9 sample window, 32 deviation scale window
+        myOCXO.setFilter(&myFilter); // setFrequencyByBiasMillis now filters each bias
+        ...
+        myFilter.getRejected(); // The number of biases rejected
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Stages
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t kSfeSiT5811FilterRateGate = 0x01; // Reject a bias which changed too quickly
+const uint8_t kSfeSiT5811FilterHampel = 0x02; // Reject a bias too far from the window median
+const uint8_t kSfeSiT5811FilterMedian = 0x04; // Output the window median
+const uint8_t kSfeSiT5811FilterEWMA = 0x08; // Output an exponentially weighted moving average
+
+const uint8_t kSfeSiT5811FilterDefaultStages = kSfeSiT5811FilterHampel;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A sliding window median: the window values, and the two heaps which order them
+typedef struct
+{
+    double *values; // The window ring: the last N samples
+    int16_t *position; // The heap position of each ring entry
+    int16_t *heap; // Ring indexes. heap[0] is the median; heap[-1], [-2] ... the max-heap below it; heap[1], [2] ... the min-heap above
+    uint8_t size; // The window length
+    uint8_t next; // The ring entry which the next sample replaces
+    uint8_t count; // The number of samples in the window
+} sfe_SiT5811_median_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Filter
+{
+public:
+    /// @brief Forget all samples and zero the counters
+    void reset(void);
+
+    /// @brief Select the stages
+    /// @param stages kSfeSiT5811Filter... ORed together. Default: Hampel
+    /// Note: this resets the filter
+    void setStages(uint8_t stages);
+
+    /// @brief Get the enabled stages
+    uint8_t getStages(void) { return _stages; }
+
+    /// @brief Configure the rate gate
+    /// @param seconds the largest change in the bias from one update to the next. Default: 10e-6
+    ///        Set it above the largest real rate, the pull range per update (getMaxPullAvailable:
+    ///        1ppm is 1us per second) plus a few times the GNSS noise, so real steering is never rejected
+    /// @param maxConsecutive pass a change larger than the limit once it has been seen this many times
+    ///        in a row. Default: 3
+    void setRateGate(double seconds, uint8_t maxConsecutive = 3);
+
+    /// @brief Configure the Hampel stage
+    /// @param threshold reject a bias more than this many scales from the median. Default: 4
+    /// @param minScaleSeconds the smallest scale, so a very quiet window does not reject everything. Default: 1e-9
+    void setHampel(double threshold, double minScaleSeconds = 1.0e-9);
+
+    /// @brief Configure the EWMA stage
+    /// @param alpha the weight of each new bias: 0 to 1. Default: 0.5
+    void setEWMA(double alpha);
+
+    /// @brief Filter one bias
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @return the filtered bias in milliseconds
+    double filter(double bias);
+
+    /// @brief Check if the last bias was rejected (and replaced)
+    bool isRejected(void) { return _rejected; }
+
+    /// @brief Get the window size N
+    uint8_t getWindow(void) { return _median.size; }
+
+    /// @brief Get the number of deviations in the Hampel scale window
+    uint8_t getScaleWindow(void) { return _deviation.size; }
+
+    /// @brief Get the number of biases filtered since reset
+    uint32_t getSamples(void) { return _samples; }
+
+    /// @brief Get the number of biases rejected since reset: by the rate gate and the Hampel stage
+    uint32_t getRejected(void) { return _rateRejected + _hampelRejected; }
+
+    /// @brief Get the number of biases rejected by the rate gate since reset
+    uint32_t getRateRejected(void) { return _rateRejected; }
+
+    /// @brief Get the number of biases rejected by the Hampel stage since reset
+    uint32_t getHampelRejected(void) { return _hampelRejected; }
+
+    /// @brief Get the median of the window in milliseconds
+    double getMedian(void);
+
+    /// @brief Get the Hampel scale (1.4826 x the median absolute deviation) in seconds
+    double getScale(void);
+
+protected:
+    /// @brief Constructor. The storage is provided by SfeSiT5811FilterN
+    SfeSiT5811Filter(uint8_t window, uint8_t scaleWindow, double *values, int16_t *positions, int16_t *heaps)
+        : _stages{kSfeSiT5811FilterDefaultStages}, _rateLimitMillis{1.0e-2}, _maxConsecutive{3}, _threshold{4.0},
+          _minScaleMillis{1.0e-6}, _alpha{0.5}
+    {
+        _median.size = window;
+        _median.values = values;
+        _median.position = positions;
+        _median.heap = heaps + (window / 2);
+        _deviation.size = scaleWindow;
+        _deviation.values = values + window;
+        _deviation.position = positions + window;
+        _deviation.heap = heaps + window + (scaleWindow / 2);
+    }
+
+private:
+    /// @brief Empty a window
+    /// @param window the window
+    void clear(sfe_SiT5811_median_t &window);
+
+    /// @brief Add a sample to a window, replacing the oldest once it is full
+    /// @param window the window
+    /// @param value the sample
+    void insert(sfe_SiT5811_median_t &window, double value);
+
+    /// @brief Get the median of a window
+    /// @param window the window
+    /// @return the median. The mean of the middle two if the count is even. Zero if empty
+    double medianOf(sfe_SiT5811_median_t &window);
+
+    /// @brief Swap two heap entries if the first is less than the second
+    /// @return true if they were swapped
+    bool exchangeIfLess(sfe_SiT5811_median_t &window, int16_t i, int16_t j);
+
+    /// @brief Restore the min-heap below a child position
+    void minSortDown(sfe_SiT5811_median_t &window, int16_t i);
+
+    /// @brief Restore the max-heap below a child position
+    void maxSortDown(sfe_SiT5811_median_t &window, int16_t i);
+
+    /// @brief Move a min-heap entry up. Returns true if it reached the median
+    bool minSortUp(sfe_SiT5811_median_t &window, int16_t i);
+
+    /// @brief Move a max-heap entry up. Returns true if it reached the median
+    bool maxSortUp(sfe_SiT5811_median_t &window, int16_t i);
+
+    uint8_t _stages;
+    double _rateLimitMillis;
+    uint8_t _maxConsecutive;
+    double _threshold;
+    double _minScaleMillis;
+    double _alpha;
+
+    sfe_SiT5811_median_t _median; // The window of biases (after the rate gate)
+    sfe_SiT5811_median_t _deviation; // The window of absolute deviations from the previous median
+
+    bool _havePassed; // true when _lastPassed is valid
+    double _lastPassed; // The last bias passed by the rate gate
+    uint8_t _consecutive; // Consecutive biases over the rate limit
+    bool _haveAverage; // true when _average is valid
+    double _average; // The EWMA
+    bool _rejected; // The last bias was rejected
+    uint32_t _samples;
+    uint32_t _rateRejected;
+    uint32_t _hampelRejected;
+};
+
+/// @brief The pre-filter, with its storage. Window sets N, the number of biases in the median window.
+///        ScaleWindow sets the number of absolute deviations in the Hampel scale window
+template <uint8_t Window, uint8_t ScaleWindow = 32> class SfeSiT5811FilterN : public SfeSiT5811Filter
+{
+public:
+    static_assert(Window >= 3, "Window must be at least 3");
+    static_assert(ScaleWindow >= 3, "ScaleWindow must be at least 3");
+
+    /// @brief Constructor
+    SfeSiT5811FilterN() : SfeSiT5811Filter(Window, ScaleWindow, _valueStore, _positionStore, _heapStore)
+    {
+        reset();
+    }
+
+private:
+    double _valueStore[Window + ScaleWindow]; // The bias window, then the deviation window
+    int16_t _positionStore[Window + ScaleWindow];
+    int16_t _heapStore[Window + ScaleWindow];
+};
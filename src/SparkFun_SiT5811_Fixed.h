@@ -0,0 +1,127 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Fixed.h
+
+    Description:
+    A compile-time specialized SiT5811 driver for products where the base
+    frequency and the pull range (DCXO Clip) are fixed per part number.
+    The Hz <-> control word scaling collapses to compile-time constants:
+    setFrequencyHz is one subtract, one multiply and an integer clamp;
+    getFrequencyHz is one multiply and one add.
+
+    Usage:
+        // 10MHz, 3.125ppm pull range limit (option "V", DCXO Clip = 32)
+        SfeSiT5811Fixed<SfeSiT5811ArdI2C, 10000000, 32> myOCXO;
+
+    The runtime SfeSiT5811Driver is unchanged. The Base class provides begin()
+    and everything else. Call clipMatches() after begin() to check that the
+    part fitted is the part the template was specialized for.
+
+*/
+
+#pragma once
+
+#include "SparkFun_SiT5811.h"
+
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip> class SfeSiT5811Fixed : public Base
+{
+public:
+    static_assert(BaseFrequencyHz > 0, "BaseFrequencyHz must be non-zero");
+    static_assert(Clip < 8192, "Clip is a 13-bit value");
+
+    // The available pull range in control word LSBs. Clip is a fraction of 2^13, the word spans 2^38: 2^25 LSB per Clip LSB
+    static constexpr int64_t kMaxPullLsb = (Clip == 0) ? kSfeSiT5811ControlWordMax : (((int64_t)Clip) << 25);
+    static_assert((kMaxPullLsb > 0) && (kMaxPullLsb <= kSfeSiT5811ControlWordMax), "Pull range must fit in the 39-bit word");
+
+    // The maximum pull range (800ppm) in Hz
+    static constexpr double kMaxPullHz = ((double)BaseFrequencyHz) * 800e-6;
+
+    // Hz <-> LSB scale factors. As per SfeSiT5811Driver: positive words scale by 2^38 - 1, negative by 2^38
+    static constexpr double kLsbPerHzPositive = 274877906943.0 / kMaxPullHz;
+    static constexpr double kLsbPerHzNegative = 274877906944.0 / kMaxPullHz;
+    static constexpr double kHzPerLsbPositive = kMaxPullHz / 274877906943.0;
+    static constexpr double kHzPerLsbNegative = kMaxPullHz / 274877906944.0;
+
+    SfeSiT5811Fixed()
+    {
+        Base::setBaseFrequencyHz((double)BaseFrequencyHz); // Keep the runtime methods consistent
+    }
+
+    /// @brief Check that the clip read by begin matches the template Clip
+    /// @return true if the part matches the specialization
+    bool clipMatches(void)
+    {
+        return Base::getPullRangeClip() == Clip;
+    }
+
+    /// @brief Get the oscillator frequency based on the base frequency and control word
+    /// @return The oscillator frequency as double
+    double getFrequencyHz(void)
+    {
+        int64_t freqControl = Base::getFrequencyControlWord();
+
+        if (freqControl >= 0)
+            return ((double)BaseFrequencyHz) + (((double)freqControl) * kHzPerLsbPositive);
+        return ((double)BaseFrequencyHz) + (((double)freqControl) * kHzPerLsbNegative);
+    }
+
+    /// @brief Set the oscillator frequency based on the base frequency and pull range
+    /// @param freq the oscillator frequency in Hz
+    /// @return true if the write is successful
+    /// Note: The frequency change will be limited by the (compile-time) pull range.
+    ///       The limit is applied to the control word, so it can differ from
+    ///       SfeSiT5811Driver::setFrequencyHz by 1 LSB at the edge of the range.
+    ///       Each limited frequency is counted in getInstrumentation().getPullClamps()
+    bool setFrequencyHz(double freq)
+    {
+        double freqOffsetHz = freq - ((double)BaseFrequencyHz);
+
+        int64_t freqControl;
+        if (freqOffsetHz >= 0.0)
+        {
+            double lsb = freqOffsetHz * kLsbPerHzPositive;
+            if (lsb > (double)kMaxPullLsb)
+            {
+                freqControl = kMaxPullLsb;
+                Base::getInstrumentation().countPullClamp();
+            }
+            else
+                freqControl = (int64_t)lsb;
+        }
+        else
+        {
+            double lsb = freqOffsetHz * kLsbPerHzNegative;
+            if (lsb < (double)(0 - kMaxPullLsb))
+            {
+                freqControl = 0 - kMaxPullLsb;
+                Base::getInstrumentation().countPullClamp();
+            }
+            else
+                freqControl = (int64_t)lsb;
+        }
+
+        return Base::setFrequencyControlWord(freqControl);
+    }
+};
+
+// C++11 requires out-of-class definitions for odr-used static constexpr members
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip>
+constexpr int64_t SfeSiT5811Fixed<Base, BaseFrequencyHz, Clip>::kMaxPullLsb;
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip>
+constexpr double SfeSiT5811Fixed<Base, BaseFrequencyHz, Clip>::kMaxPullHz;
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip>
+constexpr double SfeSiT5811Fixed<Base, BaseFrequencyHz, Clip>::kLsbPerHzPositive;
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip>
+constexpr double SfeSiT5811Fixed<Base, BaseFrequencyHz, Clip>::kLsbPerHzNegative;
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip>
+constexpr double SfeSiT5811Fixed<Base, BaseFrequencyHz, Clip>::kHzPerLsbPositive;
+template <class Base, uint32_t BaseFrequencyHz, uint16_t Clip>
+constexpr double SfeSiT5811Fixed<Base, BaseFrequencyHz, Clip>::kHzPerLsbNegative;
@@ -0,0 +1,164 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Holdover.cpp
+
+    Description:
+    Holdover for SfeSiT5811Driver: an incremental least-squares drift model of the control word.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Clock.h"
+#include "SparkFun_SiT5811_Holdover.h"
+
+// The fractional frequency of one control word LSB: 800ppm / 2^38
+const double kSfeSiT5811HoldoverFractionPerLsb = 800.0e-6 / 274877906944.0;
+
+/// @brief Forget the fit and end holdover. Does not change the settings
+void SfeSiT5811Holdover::reset(void)
+{
+    _fit.reset();
+    _referenceWord = 0;
+    _lastWord = 0;
+    _lastBias = 0.0;
+    _lastLearnMillis = 0;
+    _lastWriteMillis = 0;
+    _words = 0;
+    _holdovers = 0;
+    _active = false;
+}
+
+/// @brief Set the driver which holdover steers. Called by SfeSiT5811Driver::setHoldover
+/// @param driver the driver. nullptr to detach
+void SfeSiT5811Holdover::attach(SfeSiT5811Driver *driver)
+{
+    _driver = driver;
+}
+
+/// @brief Set the time constant of the fit
+/// @param seconds older words are weighted by exp(-age / seconds). Default: 3600
+void SfeSiT5811Holdover::setTimeConstant(double seconds)
+{
+    if (seconds < 10.0)
+        seconds = 10.0; // Shorter than this and the fit is mostly steering noise
+    _fit.setTimeConstant(seconds);
+}
+
+/// @brief Get the time
+/// @return the time in milliseconds
+uint32_t SfeSiT5811Holdover::now(void)
+{
+    return sfeSiT5811Millis(_clock); // No clock: holdover never starts. Call setClock
+}
+
+/// @brief Add a control word to the fit. Called by SfeSiT5811Driver::setFrequencyByBiasMillis
+/// @param word the control word written (or staged)
+/// @param bias the GNSS RX clock bias in milliseconds
+void SfeSiT5811Holdover::learn(int64_t word, double bias)
+{
+    uint32_t millisNow = now();
+
+    if (_words == 0)
+        _referenceWord = word;
+
+    double dt = (double)(millisNow - _lastLearnMillis) * 0.001; // Unsigned: correct across the 32-bit wrap
+    _fit.add((double)(word - _referenceWord), dt);
+
+    _lastWord = word;
+    _lastBias = bias;
+    _lastLearnMillis = millisNow;
+    _words++;
+}
+
+/// @brief Enter holdover if the bias has stopped, and write the predicted word when it is due
+/// @return false if a write failed
+bool SfeSiT5811Holdover::update(void)
+{
+    if ((_driver == nullptr) || (_words == 0))
+        return true; // Nothing to hold
+
+    uint32_t millisNow = now();
+    uint32_t sinceBias = millisNow - _lastLearnMillis;
+
+    if (!_active)
+    {
+        if (sinceBias < _timeoutMillis)
+            return true; // The bias is still arriving
+        _active = true;
+        _holdovers++;
+    }
+    else if ((millisNow - _lastWriteMillis) < _updateIntervalMillis)
+        return true;
+
+    _lastWriteMillis = millisNow;
+
+    return _driver->setFrequencyControlWord(getPrediction((double)sinceBias * 0.001));
+}
+
+/// @brief Check if the fit has enough words to predict: at least kSfeSiT5811HoldoverMinWords
+bool SfeSiT5811Holdover::isReady(void)
+{
+    double a, b;
+    return (_words >= kSfeSiT5811HoldoverMinWords) && _fit.solve(a, b);
+}
+
+/// @brief Get the time since the last bias, in seconds
+double SfeSiT5811Holdover::getSecondsSinceBias(void)
+{
+    if (_words == 0)
+        return 0.0;
+
+    return (double)(now() - _lastLearnMillis) * 0.001;
+}
+
+/// @brief Get the predicted control word
+/// @param seconds the time since the last bias
+/// @return the word. The last word if the fit is not ready
+int64_t SfeSiT5811Holdover::getPrediction(double seconds)
+{
+    double a, b;
+    if ((_words < kSfeSiT5811HoldoverMinWords) || !_fit.solve(a, b))
+        return _lastWord;
+
+    double y = a + (b * seconds);
+    return _referenceWord + (int64_t)((y >= 0.0) ? (y + 0.5) : (y - 0.5));
+}
+
+/// @brief Get the fitted drift
+/// @return the fractional frequency change per second
+double SfeSiT5811Holdover::getDriftPerSecond(void)
+{
+    double a, b;
+    if (!_fit.solve(a, b))
+        return 0.0;
+
+    return b * kSfeSiT5811HoldoverFractionPerLsb;
+}
+
+/// @brief Get the estimated time error bound
+/// @param seconds the time since the last bias
+/// @return the bound in seconds: the last bias plus twice the standard error of the fit, integrated
+double SfeSiT5811Holdover::getTimeErrorBound(double seconds)
+{
+    double bound = fabs(_lastBias) * 0.001;
+
+    double a, b;
+    double sigmaA, sigmaB;
+    if ((_words < kSfeSiT5811HoldoverMinWords) || !_fit.solve(a, b) || !_fit.getStandardErrors(a, b, sigmaA, sigmaB))
+        return bound;
+    sigmaA *= kSfeSiT5811HoldoverFractionPerLsb;
+    sigmaB *= kSfeSiT5811HoldoverFractionPerLsb;
+
+    // The time error is the integral of the frequency error: a.t + b.t^2 / 2
+    return bound + (2.0 * ((sigmaA * seconds) + (sigmaB * seconds * seconds * 0.5)));
+}
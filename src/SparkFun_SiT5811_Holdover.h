@@ -0,0 +1,160 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Holdover.h
+
+    Description:
+    Holdover for SfeSiT5811Driver: keeps steering the OCXO when the GNSS bias stops arriving.
+
+    While locked, each control word written by setFrequencyByBiasMillis is added to an
+    exponentially-weighted least-squares fit of word = a + b * t (SfeSiT5811TrendFit). The fit is held as six
+    running sums, with t measured back from the latest word, so each update is O(1) with
+    fixed memory and the sums never grow with the run time. The time constant (default one
+    hour) sets how far back the fit looks: long enough to average the steering noise, short
+    enough to follow the temperature.
+
+    If no bias arrives for the timeout (default 3s), update() enters holdover and writes
+    the predicted word a + b * t with setFrequencyControlWord, every update interval
+    (default 1s). The next setFrequencyByBiasMillis ends holdover and re-seeds the
+    discipline from the predicted frequency.
+
+    getTimeErrorBound estimates the time error: the last bias, plus twice the standard
+    error of the fitted frequency and drift, integrated over the time in holdover. It
+    covers the fit uncertainty only; a temperature step during holdover is not predicted.
+
+    Usage:
+        SfeSiT5811Holdover myHoldover;
+        myOCXO.setHoldover(&myHoldover);
+        ...
+        if (newBias) myOCXO.setFrequencyByBiasMillis(bias);
+        myHoldover.update(); // Call often: it does nothing until the bias stops
+
+    The time is millis() on Arduino, or CLOCK_MONOTONIC on a POSIX host. Call setClock to
+    use a different millisecond clock.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811_TrendFit.h"
+
+const uint32_t kSfeSiT5811HoldoverMinWords = 60; // Hold the last word until the fit has this many words
+
+class SfeSiT5811Driver;
+
+class SfeSiT5811Holdover
+{
+public:
+    SfeSiT5811Holdover()
+        : _driver{nullptr}, _clock{nullptr}, _timeoutMillis{3000}, _updateIntervalMillis{1000}, _fit{3600.0}
+    {
+        reset();
+    }
+
+    /// @brief Forget the fit and end holdover. Does not change the settings
+    void reset(void);
+
+    /// @brief Set the driver which holdover steers. Called by SfeSiT5811Driver::setHoldover
+    /// @param driver the driver. nullptr to detach
+    void attach(SfeSiT5811Driver *driver);
+
+    /// @brief Set the time constant of the fit
+    /// @param seconds older words are weighted by exp(-age / seconds). Default: 3600
+    void setTimeConstant(double seconds);
+
+    /// @brief Get the time constant of the fit in seconds
+    double getTimeConstant(void) { return _fit.getTimeConstant(); }
+
+    /// @brief Set how long without a bias before holdover starts
+    /// @param millis the timeout in milliseconds. Default: 3000
+    void setTimeout(uint32_t millis) { _timeoutMillis = millis; }
+
+    /// @brief Get how long without a bias before holdover starts, in milliseconds
+    uint32_t getTimeout(void) { return _timeoutMillis; }
+
+    /// @brief Set how often the predicted word is written during holdover
+    /// @param millis the interval in milliseconds. Default: 1000
+    void setUpdateInterval(uint32_t millis) { _updateIntervalMillis = millis; }
+
+    /// @brief Get how often the predicted word is written during holdover, in milliseconds
+    uint32_t getUpdateInterval(void) { return _updateIntervalMillis; }
+
+    /// @brief Set the function which provides the time
+    /// @param clock returns the time in milliseconds. nullptr to restore the default
+    void setClock(uint32_t (*clock)(void)) { _clock = clock; }
+
+    /// @brief Get the time
+    /// @return the time in milliseconds
+    uint32_t now(void);
+
+    /// @brief Add a control word to the fit. Called by SfeSiT5811Driver::setFrequencyByBiasMillis
+    /// @param word the control word written (or staged)
+    /// @param bias the GNSS RX clock bias in milliseconds
+    void learn(int64_t word, double bias);
+
+    /// @brief Enter holdover if the bias has stopped, and write the predicted word when it is due
+    /// @return false if a write failed
+    bool update(void);
+
+    /// @brief End holdover. Called by SfeSiT5811Driver::setFrequencyByBiasMillis when the bias returns
+    void end(void) { _active = false; }
+
+    /// @brief Check if holdover is active
+    bool isActive(void) { return _active; }
+
+    /// @brief Check if the fit has enough words to predict: at least kSfeSiT5811HoldoverMinWords
+    bool isReady(void);
+
+    /// @brief Get the number of words added to the fit since reset
+    uint32_t getWords(void) { return _words; }
+
+    /// @brief Get the number of holdover periods since reset
+    uint32_t getHoldovers(void) { return _holdovers; }
+
+    /// @brief Get the time since the last bias, in seconds
+    double getSecondsSinceBias(void);
+
+    /// @brief Get the predicted control word
+    /// @param seconds the time since the last bias
+    /// @return the word. The last word if the fit is not ready
+    int64_t getPrediction(double seconds);
+
+    /// @brief Get the fitted drift
+    /// @return the fractional frequency change per second
+    double getDriftPerSecond(void);
+
+    /// @brief Get the estimated time error bound
+    /// @param seconds the time since the last bias
+    /// @return the bound in seconds: the last bias plus twice the standard error of the fit, integrated
+    double getTimeErrorBound(double seconds);
+
+    /// @brief Get the estimated time error bound now
+    /// @return the bound in seconds
+    double getTimeErrorBound(void) { return getTimeErrorBound(getSecondsSinceBias()); }
+
+private:
+    SfeSiT5811Driver *_driver;
+    uint32_t (*_clock)(void);
+    uint32_t _timeoutMillis;
+    uint32_t _updateIntervalMillis;
+
+    SfeSiT5811TrendFit _fit; // y is the word relative to _referenceWord, in LSB
+    int64_t _referenceWord; // The first word. Keeps y small
+    int64_t _lastWord;
+    double _lastBias; // Milliseconds
+
+    uint32_t _lastLearnMillis;
+    uint32_t _lastWriteMillis;
+    uint32_t _words;
+    uint32_t _holdovers;
+    bool _active;
+};
@@ -0,0 +1,119 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Instrumentation.cpp
+
+    Description:
+    Hot-path counters and latency histograms for SfeSiT5811Driver.
+
+*/
+
+#include "SparkFun_SiT5811_Instrumentation.h"
+
+#if SFE_SIT5811_INSTRUMENTATION
+
+#include "SparkFun_SiT5811_Clock.h"
+
+/// @brief Zero all the counters and histograms
+void SfeSiT5811Instrumentation::reset(void)
+{
+    for (uint8_t op = 0; op < kSfeSiT5811OpCount; op++)
+    {
+        sfe_SiT5811_op_stats_t *stats = &_stats[op];
+        stats->transactions = 0;
+        stats->bytes = 0;
+        stats->failures = 0;
+        stats->shortReads = 0;
+        stats->maxMicros = 0;
+        for (uint8_t b = 0; b < kSfeSiT5811LatencyBuckets; b++)
+            stats->histogram[b] = 0;
+    }
+    _pullClamps = 0;
+    _wordClamps = 0;
+}
+
+/// @brief Set the function which provides the latency timestamps
+/// @param clock returns the time in microseconds. nullptr to restore the default
+void SfeSiT5811Instrumentation::setClock(uint32_t (*clock)(void))
+{
+    _clock = clock;
+}
+
+/// @brief Get a timestamp, to pass to record
+/// @return the time in microseconds
+uint32_t SfeSiT5811Instrumentation::now(void)
+{
+    return sfeSiT5811Micros(_clock); // No clock: every latency is counted in bucket 0. Call setClock
+}
+
+/// @brief Record one bus operation
+/// @param op the operation
+/// @param start the timestamp from now() when the operation started
+/// @param result the bus status
+/// @param bytes the number of data bytes requested or sent
+/// @param shortRead true if fewer bytes were read than requested
+void SfeSiT5811Instrumentation::record(sfe_SiT5811_op_t op, uint32_t start, sfe_SiT5811_err_t result, size_t bytes, bool shortRead)
+{
+    if (op >= kSfeSiT5811OpCount)
+        return;
+
+    uint32_t micros = now() - start; // Unsigned: correct across the 32-bit wrap
+
+    sfe_SiT5811_op_stats_t *stats = &_stats[op];
+    stats->transactions++;
+    stats->bytes += (uint32_t)bytes;
+    if (result != kSfeSiT5811ErrOk)
+        stats->failures++;
+    if (shortRead)
+        stats->shortReads++;
+    if (micros > stats->maxMicros)
+        stats->maxMicros = micros;
+    stats->histogram[getBucket(micros)]++;
+}
+
+/// @brief Get one latency histogram bucket for an operation
+/// @param op the operation
+/// @param bucket 0 to kSfeSiT5811LatencyBuckets - 1
+/// @return the number of transactions whose latency fell in the bucket
+uint32_t SfeSiT5811Instrumentation::getHistogram(sfe_SiT5811_op_t op, uint8_t bucket)
+{
+    if ((op >= kSfeSiT5811OpCount) || (bucket >= kSfeSiT5811LatencyBuckets))
+        return 0;
+
+    return _stats[op].histogram[bucket];
+}
+
+/// @brief Get the histogram bucket for a latency
+/// @param micros the latency in microseconds
+/// @return the bucket: 0 to kSfeSiT5811LatencyBuckets - 1
+uint8_t SfeSiT5811Instrumentation::getBucket(uint32_t micros)
+{
+    uint8_t bucket = 0;
+    while ((micros != 0) && (bucket < (kSfeSiT5811LatencyBuckets - 1)))
+    {
+        micros >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/// @brief Get the lowest latency counted by a bucket
+/// @param bucket 0 to kSfeSiT5811LatencyBuckets - 1
+/// @return the latency in microseconds
+uint32_t SfeSiT5811Instrumentation::getBucketMicros(uint8_t bucket)
+{
+    if (bucket == 0)
+        return 0;
+    if (bucket >= kSfeSiT5811LatencyBuckets)
+        bucket = kSfeSiT5811LatencyBuckets - 1;
+    return 1UL << (bucket - 1);
+}
+
+#endif // SFE_SIT5811_INSTRUMENTATION
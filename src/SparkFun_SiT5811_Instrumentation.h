@@ -0,0 +1,180 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Instrumentation.h
+
+    Description:
+    Hot-path counters and latency histograms for SfeSiT5811Driver. For each bus
+    operation (ping, read, write, asynchronous write) this counts the transactions,
+    bytes, failures and short reads, and keeps a log2-bucketed latency histogram
+    in microseconds. It also counts the steering clamps: frequencies limited to the
+    pull range by setFrequencyHz / setFrequencyOffsetPPQ, and control words limited
+    to 39 bits. (The bias limiter's slew and pull clamps are counted by
+    SfeSiT5811Discipline: getSlewLimited and getPullLimited.)
+
+    Latency is measured with micros() on Arduino, or CLOCK_MONOTONIC on a POSIX host.
+    Call setClock to use a different microsecond clock.
+
+    Instrumentation is compile-time removable: define SFE_SIT5811_INSTRUMENTATION as 0
+    (e.g. -DSFE_SIT5811_INSTRUMENTATION=0) and every call becomes an empty inline
+    function and every getter returns zero. It defaults to 0 on AVR (approx. 340 bytes
+    of RAM) and 1 everywhere else.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SparkFun_SiT5811_Bus.h"
+
+#ifndef SFE_SIT5811_INSTRUMENTATION
+#if defined(__AVR__)
+#define SFE_SIT5811_INSTRUMENTATION 0
+#else
+#define SFE_SIT5811_INSTRUMENTATION 1
+#endif
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Instrumented Operations
+///////////////////////////////////////////////////////////////////////////////
+
+typedef enum
+{
+    kSfeSiT5811OpPing = 0, // SfeSiT5811Bus::ping
+    kSfeSiT5811OpRead, // SfeSiT5811Bus::readRegisterRegion
+    kSfeSiT5811OpWrite, // SfeSiT5811Bus::writeRegisterRegion
+    kSfeSiT5811OpAsyncWrite, // startWriteRegisterRegion to completion. The latency includes the time between polls
+    kSfeSiT5811OpCount
+} sfe_SiT5811_op_t;
+
+// Bucket 0 counts latencies of 0us. Bucket k counts 2^(k-1) to 2^k - 1 us.
+// The last bucket counts everything from 2^(kSfeSiT5811LatencyBuckets-2) us (16.4ms) up.
+const uint8_t kSfeSiT5811LatencyBuckets = 16;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if SFE_SIT5811_INSTRUMENTATION
+
+// The counters for one operation
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t bytes; // Data bytes requested (reads) or sent (writes)
+    uint32_t failures; // The bus returned an error
+    uint32_t shortReads; // The bus returned fewer bytes than requested
+    uint32_t maxMicros; // The longest latency
+    uint32_t histogram[kSfeSiT5811LatencyBuckets];
+} sfe_SiT5811_op_stats_t;
+
+class SfeSiT5811Instrumentation
+{
+public:
+    SfeSiT5811Instrumentation() : _clock{nullptr}
+    {
+        reset();
+    }
+
+    /// @brief Zero all the counters and histograms
+    void reset(void);
+
+    /// @brief Set the function which provides the latency timestamps
+    /// @param clock returns the time in microseconds. nullptr to restore the default
+    void setClock(uint32_t (*clock)(void));
+
+    /// @brief Get a timestamp, to pass to record
+    /// @return the time in microseconds
+    uint32_t now(void);
+
+    /// @brief Record one bus operation
+    /// @param op the operation
+    /// @param start the timestamp from now() when the operation started
+    /// @param result the bus status
+    /// @param bytes the number of data bytes requested or sent
+    /// @param shortRead true if fewer bytes were read than requested
+    void record(sfe_SiT5811_op_t op, uint32_t start, sfe_SiT5811_err_t result, size_t bytes, bool shortRead);
+
+    /// @brief Count a frequency limited to the pull range
+    void countPullClamp(void) { _pullClamps++; }
+
+    /// @brief Count a control word limited to 39 bits
+    void countWordClamp(void) { _wordClamps++; }
+
+    /// @brief Get the number of transactions for an operation
+    uint32_t getTransactions(sfe_SiT5811_op_t op) { return (op < kSfeSiT5811OpCount) ? _stats[op].transactions : 0; }
+
+    /// @brief Get the number of data bytes for an operation
+    uint32_t getBytes(sfe_SiT5811_op_t op) { return (op < kSfeSiT5811OpCount) ? _stats[op].bytes : 0; }
+
+    /// @brief Get the number of failures for an operation
+    uint32_t getFailures(sfe_SiT5811_op_t op) { return (op < kSfeSiT5811OpCount) ? _stats[op].failures : 0; }
+
+    /// @brief Get the number of short reads for an operation
+    uint32_t getShortReads(sfe_SiT5811_op_t op) { return (op < kSfeSiT5811OpCount) ? _stats[op].shortReads : 0; }
+
+    /// @brief Get the longest latency for an operation in microseconds
+    uint32_t getMaxMicros(sfe_SiT5811_op_t op) { return (op < kSfeSiT5811OpCount) ? _stats[op].maxMicros : 0; }
+
+    /// @brief Get one latency histogram bucket for an operation
+    /// @param op the operation
+    /// @param bucket 0 to kSfeSiT5811LatencyBuckets - 1
+    /// @return the number of transactions whose latency fell in the bucket
+    uint32_t getHistogram(sfe_SiT5811_op_t op, uint8_t bucket);
+
+    /// @brief Get the number of frequencies limited to the pull range by setFrequencyHz / setFrequencyOffsetPPQ
+    uint32_t getPullClamps(void) { return _pullClamps; }
+
+    /// @brief Get the number of control words limited to 39 bits
+    uint32_t getWordClamps(void) { return _wordClamps; }
+
+    /// @brief Get the histogram bucket for a latency
+    /// @param micros the latency in microseconds
+    /// @return the bucket: 0 to kSfeSiT5811LatencyBuckets - 1
+    static uint8_t getBucket(uint32_t micros);
+
+    /// @brief Get the lowest latency counted by a bucket
+    /// @param bucket 0 to kSfeSiT5811LatencyBuckets - 1
+    /// @return the latency in microseconds
+    static uint32_t getBucketMicros(uint8_t bucket);
+
+private:
+    uint32_t (*_clock)(void); // Latency timestamp source
+    sfe_SiT5811_op_stats_t _stats[kSfeSiT5811OpCount];
+    uint32_t _pullClamps;
+    uint32_t _wordClamps;
+};
+
+#else // SFE_SIT5811_INSTRUMENTATION
+
+// Instrumentation removed: every call compiles to nothing
+class SfeSiT5811Instrumentation
+{
+public:
+    void reset(void) {}
+    void setClock(uint32_t (*clock)(void)) { (void)clock; }
+    uint32_t now(void) { return 0; }
+    void record(sfe_SiT5811_op_t, uint32_t, sfe_SiT5811_err_t, size_t, bool) {}
+    void countPullClamp(void) {}
+    void countWordClamp(void) {}
+    uint32_t getTransactions(sfe_SiT5811_op_t) { return 0; }
+    uint32_t getBytes(sfe_SiT5811_op_t) { return 0; }
+    uint32_t getFailures(sfe_SiT5811_op_t) { return 0; }
+    uint32_t getShortReads(sfe_SiT5811_op_t) { return 0; }
+    uint32_t getMaxMicros(sfe_SiT5811_op_t) { return 0; }
+    uint32_t getHistogram(sfe_SiT5811_op_t, uint8_t) { return 0; }
+    uint32_t getPullClamps(void) { return 0; }
+    uint32_t getWordClamps(void) { return 0; }
+    static uint8_t getBucket(uint32_t) { return 0; }
+    static uint32_t getBucketMicros(uint8_t) { return 0; }
+};
+
+#endif // SFE_SIT5811_INSTRUMENTATION
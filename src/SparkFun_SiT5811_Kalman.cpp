@@ -0,0 +1,198 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Kalman.cpp
+
+    Description:
+    A Kalman filter steering law for SfeSiT5811Discipline: phase, frequency and drift.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_Kalman.h"
+
+// The initial 1-sigma uncertainties. The first bias sets the phase
+const double kSfeSiT5811KalmanInitialFrequencyPPB = 100.0;
+const double kSfeSiT5811KalmanInitialDriftPPBPerSecond = 1.0e-3;
+
+/// @brief Forget the state. The next update initializes the filter
+void SfeSiT5811Kalman::reset(void)
+{
+    _initialized = false;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        _x[i] = 0.0;
+        for (uint8_t j = 0; j < 3; j++)
+            _P[i][j] = 0.0;
+    }
+    _innovationNs = 0.0;
+    updateProcessNoise();
+}
+
+/// @brief Set the number of states
+/// @param states 2: phase and frequency. 3 (default): phase, frequency and drift
+void SfeSiT5811Kalman::setStates(uint8_t states)
+{
+    _states = (states == 2) ? 2 : 3;
+    if (_states == 2)
+    {
+        // Drop the drift: zero its state and its row and column of P
+        _x[2] = 0.0;
+        for (uint8_t i = 0; i < 3; i++)
+            _P[i][2] = _P[2][i] = 0.0;
+    }
+    updateProcessNoise();
+}
+
+/// @brief Set the time between updates
+/// @param seconds the epoch. Default: 1
+void SfeSiT5811Kalman::setEpoch(double seconds)
+{
+    if (seconds > 0.0)
+        _epochSeconds = seconds;
+    updateProcessNoise();
+}
+
+/// @brief Set the GNSS RX clock bias noise
+/// @param seconds the 1-sigma noise. Default: 5e-9
+void SfeSiT5811Kalman::setMeasurementNoise(double seconds)
+{
+    _measurementNs = fabs(seconds) * 1.0e9;
+    updateProcessNoise();
+}
+
+/// @brief Set the oscillator process noise, 1-sigma per one-second epoch
+/// @param whiteFMPPB the white frequency noise in PPB. Default: 0.01
+/// @param randomWalkFMPPB the frequency random walk in PPB. Default: 0.001
+/// @param driftPPBPerSecond the drift random walk in PPB per second. Default: 1e-6. Ignored in two-state mode
+void SfeSiT5811Kalman::setProcessNoise(double whiteFMPPB, double randomWalkFMPPB, double driftPPBPerSecond)
+{
+    _whiteFMPPB = fabs(whiteFMPPB);
+    _randomWalkFMPPB = fabs(randomWalkFMPPB);
+    _driftPPBPerSecond = fabs(driftPPBPerSecond);
+    updateProcessNoise();
+}
+
+/// @brief Set how quickly the phase (time error) is steered out
+/// @param seconds the phase time constant. Default: 20
+void SfeSiT5811Kalman::setPhaseTimeConstant(double seconds)
+{
+    if (seconds < _epochSeconds)
+        seconds = _epochSeconds; // Faster than this overshoots
+    _phaseTimeConstantSeconds = seconds;
+}
+
+/// @brief Perform one update step
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @param appliedPPB the steering applied since the last update: the output frequency offset from base, in PPB
+/// @return the steering to apply now, in PPB
+double SfeSiT5811Kalman::update(double bias, double appliedPPB)
+{
+    double z = bias * 1.0e6; // ms to ns
+    double t = _epochSeconds;
+
+    if (!_initialized)
+    {
+        // Assume the current steering cancels the offset until the filter learns otherwise
+        _x[0] = z;
+        _x[1] = 0.0 - appliedPPB;
+        _x[2] = 0.0;
+        _P[0][0] = _R;
+        _P[1][1] = kSfeSiT5811KalmanInitialFrequencyPPB * kSfeSiT5811KalmanInitialFrequencyPPB;
+        _P[2][2] = (_states == 3) ? kSfeSiT5811KalmanInitialDriftPPBPerSecond * kSfeSiT5811KalmanInitialDriftPPBPerSecond : 0.0;
+        _initialized = true;
+        _innovationNs = 0.0;
+    }
+    else
+    {
+        // Predict. The phase advances by the free-running frequency plus the steering (1 PPB for 1s = 1ns)
+        double halfT2 = 0.5 * t * t;
+        _x[0] += (t * (_x[1] + appliedPPB)) + (halfT2 * _x[2]);
+        _x[1] += t * _x[2];
+
+        // P = F.P.F' + Q, with F = [1 t t^2/2; 0 1 t; 0 0 1]
+        double A[3][3]; // F.P
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            A[0][j] = _P[0][j] + (t * _P[1][j]) + (halfT2 * _P[2][j]);
+            A[1][j] = _P[1][j] + (t * _P[2][j]);
+            A[2][j] = _P[2][j];
+        }
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            _P[i][0] = A[i][0] + (t * A[i][1]) + (halfT2 * A[i][2]) + _Q[i][0];
+            _P[i][1] = A[i][1] + (t * A[i][2]) + _Q[i][1];
+            _P[i][2] = A[i][2] + _Q[i][2];
+        }
+
+        // Update with the measured phase. H = [1 0 0], so S is a scalar
+        _innovationNs = z - _x[0];
+        double S = _P[0][0] + _R;
+        double K[3];
+        for (uint8_t i = 0; i < 3; i++)
+            K[i] = _P[i][0] / S;
+        for (uint8_t i = 0; i < 3; i++)
+            _x[i] += K[i] * _innovationNs;
+
+        double P0[3] = {_P[0][0], _P[0][1], _P[0][2]}; // P = P - K.H.P
+        for (uint8_t i = 0; i < 3; i++)
+            for (uint8_t j = 0; j < 3; j++)
+                _P[i][j] -= K[i] * P0[j];
+
+        // Keep P symmetric
+        for (uint8_t i = 0; i < 3; i++)
+            for (uint8_t j = i + 1; j < 3; j++)
+                _P[i][j] = _P[j][i] = 0.5 * (_P[i][j] + _P[j][i]);
+    }
+
+    if (_states == 2)
+        _x[2] = 0.0; // Q and the initial P keep the drift row and column at zero
+
+    // Cancel the free-running frequency over the next epoch, and steer the phase out
+    return 0.0 - (_x[1] + (0.5 * t * _x[2])) - (_x[0] / _phaseTimeConstantSeconds);
+}
+
+/// @brief Get the 1-sigma uncertainty of the estimated phase in ns
+double SfeSiT5811Kalman::getPhaseSigmaNs(void)
+{
+    return (_P[0][0] > 0.0) ? sqrt(_P[0][0]) : 0.0;
+}
+
+/// @brief Get the 1-sigma uncertainty of the estimated frequency in PPB
+double SfeSiT5811Kalman::getFrequencySigmaPPB(void)
+{
+    return (_P[1][1] > 0.0) ? sqrt(_P[1][1]) : 0.0;
+}
+
+/// @brief PRIVATE: Recalculate the process noise covariance. Called when the epoch or the noise change
+/// The standard clock model: white FM grows the phase variance by q1.t, random walk FM integrates into
+/// phase and frequency, and the drift random walk integrates into all three.
+void SfeSiT5811Kalman::updateProcessNoise(void)
+{
+    double t = _epochSeconds;
+    double t2 = t * t;
+    double t3 = t2 * t;
+    double q1 = _whiteFMPPB * _whiteFMPPB; // ns^2 per s
+    double q2 = _randomWalkFMPPB * _randomWalkFMPPB; // PPB^2 per s
+    double q3 = (_states == 3) ? _driftPPBPerSecond * _driftPPBPerSecond : 0.0; // (PPB/s)^2 per s
+
+    _Q[0][0] = (q1 * t) + (q2 * t3 / 3.0) + (q3 * t3 * t2 / 20.0);
+    _Q[0][1] = (q2 * t2 / 2.0) + (q3 * t2 * t2 / 8.0);
+    _Q[0][2] = q3 * t3 / 6.0;
+    _Q[1][1] = (q2 * t) + (q3 * t3 / 3.0);
+    _Q[1][2] = q3 * t2 / 2.0;
+    _Q[2][2] = q3 * t;
+    _Q[1][0] = _Q[0][1];
+    _Q[2][0] = _Q[0][2];
+    _Q[2][1] = _Q[1][2];
+
+    _R = _measurementNs * _measurementNs;
+}
@@ -0,0 +1,141 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Kalman.h
+
+    Description:
+    A Kalman filter steering law for SfeSiT5811Discipline, as an alternative to the PI loop.
+    Declare one per driver and attach it with SfeSiT5811Driver::setSteeringMode, e.g.
+        myOCXO.setSteeringMode(kSfeSiT5811SteeringKalman3, &myKalman);
+
+    The filter estimates the oscillator state from the GNSS RX clock bias:
+        phase - the time error (ns)
+        frequency - the free-running fractional frequency offset, before steering (PPB)
+        drift - the change in frequency (PPB per second). Three-state mode only
+    The frequency applied by the previous update is a known input, so the filter separates
+    the oscillator's own offset from the steering. The steering then cancels the estimated
+    offset and drift, and removes the phase over the phase time constant:
+        correction = -(frequency + drift * epoch / 2) - phase / phaseTimeConstant
+    The discipline applies its slew and pull range limits to the result, as it does for PI.
+
+    The noise is configured as 1-sigma values per one-second epoch:
+        measurement - the GNSS RX clock bias noise (s). Default 5ns
+        white FM - the oscillator white frequency noise (PPB). Default 0.01
+        random walk FM - the frequency random walk (PPB). Default 0.001
+        drift - the drift random walk (PPB per second). Default 1e-6
+    Larger process noise follows the oscillator faster; larger measurement noise trusts the
+    GNSS less.
+
+    Units are ns and PPB so the covariances stay well inside the range of a 32-bit float (AVR).
+    Each update is a fixed sequence of approx. 100 floating-point operations: no loops over
+    history, no allocation.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+class SfeSiT5811Kalman
+{
+public:
+    SfeSiT5811Kalman()
+        : _states{3}, _epochSeconds{1.0}, _measurementNs{5.0}, _whiteFMPPB{0.01}, _randomWalkFMPPB{0.001},
+          _driftPPBPerSecond{1.0e-6}, _phaseTimeConstantSeconds{20.0}
+    {
+        reset();
+    }
+
+    /// @brief Forget the state. The next update initializes the filter
+    void reset(void);
+
+    /// @brief Check if the filter has been initialized by an update
+    bool isInitialized(void) { return _initialized; }
+
+    /// @brief Set the number of states
+    /// @param states 2: phase and frequency. 3 (default): phase, frequency and drift
+    void setStates(uint8_t states);
+
+    /// @brief Get the number of states
+    uint8_t getStates(void) { return _states; }
+
+    /// @brief Set the time between updates
+    /// @param seconds the epoch. Default: 1
+    void setEpoch(double seconds);
+
+    /// @brief Get the time between updates in seconds
+    double getEpoch(void) { return _epochSeconds; }
+
+    /// @brief Set the GNSS RX clock bias noise
+    /// @param seconds the 1-sigma noise. Default: 5e-9
+    void setMeasurementNoise(double seconds);
+
+    /// @brief Get the GNSS RX clock bias noise in seconds
+    double getMeasurementNoise(void) { return _measurementNs * 1.0e-9; }
+
+    /// @brief Set the oscillator process noise, 1-sigma per one-second epoch
+    /// @param whiteFMPPB the white frequency noise in PPB. Default: 0.01
+    /// @param randomWalkFMPPB the frequency random walk in PPB. Default: 0.001
+    /// @param driftPPBPerSecond the drift random walk in PPB per second. Default: 1e-6. Ignored in two-state mode
+    void setProcessNoise(double whiteFMPPB, double randomWalkFMPPB, double driftPPBPerSecond);
+
+    /// @brief Set how quickly the phase (time error) is steered out
+    /// @param seconds the phase time constant. Default: 20
+    void setPhaseTimeConstant(double seconds);
+
+    /// @brief Get the phase time constant in seconds
+    double getPhaseTimeConstant(void) { return _phaseTimeConstantSeconds; }
+
+    /// @brief Perform one update step
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @param appliedPPB the steering applied since the last update: the output frequency offset from base, in PPB
+    /// @return the steering to apply now, in PPB
+    double update(double bias, double appliedPPB);
+
+    /// @brief Get the estimated phase (time error) in ns
+    double getPhaseNs(void) { return _x[0]; }
+
+    /// @brief Get the estimated free-running frequency offset in PPB. The steering cancels it
+    double getFrequencyPPB(void) { return _x[1]; }
+
+    /// @brief Get the estimated drift in PPB per second. Zero in two-state mode
+    double getDriftPPBPerSecond(void) { return _x[2]; }
+
+    /// @brief Get the last innovation: the measured minus the predicted phase, in ns
+    double getInnovationNs(void) { return _innovationNs; }
+
+    /// @brief Get the 1-sigma uncertainty of the estimated phase in ns
+    double getPhaseSigmaNs(void);
+
+    /// @brief Get the 1-sigma uncertainty of the estimated frequency in PPB
+    double getFrequencySigmaPPB(void);
+
+private:
+    /// @brief Recalculate the process noise covariance. Called when the epoch or the noise change
+    void updateProcessNoise(void);
+
+    uint8_t _states;
+    double _epochSeconds;
+    double _measurementNs;
+    double _whiteFMPPB;
+    double _randomWalkFMPPB;
+    double _driftPPBPerSecond;
+    double _phaseTimeConstantSeconds;
+
+    // Cached by updateProcessNoise
+    double _Q[3][3]; // The process noise covariance per epoch
+    double _R; // The measurement noise variance (ns^2)
+
+    // State
+    bool _initialized;
+    double _x[3]; // Phase (ns), frequency (PPB), drift (PPB/s)
+    double _P[3][3]; // The state covariance
+    double _innovationNs;
+};
@@ -0,0 +1,205 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_PPS.cpp
+
+    Description:
+    PPS edge capture: a lock-free single-producer, single-consumer ring, and the consumer
+    which turns the edges into a bias for setFrequencyByBiasMillis.
+
+*/
+
+#include "SparkFun_SiT5811_PPS.h"
+
+/// @brief Forget all edges. Call only when the producer is stopped (e.g. before attachInterrupt)
+void SfeSiT5811PPSQueue::reset(void)
+{
+    _head = 0;
+    _tail = 0;
+    _dropped = 0;
+}
+
+/// @brief Add an edge. Producer (ISR) only. Bounded: never blocks
+/// @param count the counter value captured at the edge
+/// @return true if the edge was queued, false if the ring was full and it was dropped
+bool SFE_SIT5811_ISR_ATTR SfeSiT5811PPSQueue::push(uint32_t count)
+{
+    uint8_t head = _head; // Only this side writes _head
+    uint8_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE); // The consumer has finished with the entries before tail
+
+    if ((uint8_t)(head - tail) >= _size)
+    {
+        if (_dropped < 255)
+            _dropped++;
+        return false;
+    }
+
+    sfe_SiT5811_pps_edge_t &edge = _edges[head & (_size - 1)];
+    edge.count = count;
+    edge.dropped = _dropped;
+    _dropped = 0;
+
+    __atomic_store_n(&_head, (uint8_t)(head + 1), __ATOMIC_RELEASE); // Publish the edge
+    return true;
+}
+
+/// @brief Remove the oldest edge. Consumer only
+/// @param edge returns the edge
+/// @return true if an edge was returned, false if the ring was empty
+bool SfeSiT5811PPSQueue::pop(sfe_SiT5811_pps_edge_t &edge)
+{
+    uint8_t tail = _tail; // Only this side writes _tail
+    uint8_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE); // The edges before head are complete
+
+    if (head == tail)
+        return false;
+
+    edge = _edges[tail & (_size - 1)];
+
+    __atomic_store_n(&_tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE); // Release the entry to the producer
+    return true;
+}
+
+/// @brief Get the number of edges waiting. Consumer only
+uint8_t SfeSiT5811PPSQueue::available(void)
+{
+    return (uint8_t)(__atomic_load_n(&_head, __ATOMIC_ACQUIRE) - _tail);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Start consuming edges
+/// @param queue the ring which the ISR pushes to
+/// @param driver the driver to steer. nullptr: measure only (getBiasMillis)
+/// @param countsPerSecond the nominal counter frequency in Hz. 0: the driver's base frequency
+/// @return true if started
+bool SfeSiT5811PPS::begin(SfeSiT5811PPSQueue *queue, SfeSiT5811Driver *driver, uint32_t countsPerSecond)
+{
+    _queue = queue;
+    _driver = driver;
+
+    if ((countsPerSecond == 0) && (driver != nullptr))
+        countsPerSecond = (uint32_t)(driver->getBaseFrequencyHz() + 0.5);
+    if (countsPerSecond != 0)
+        _countsPerSecond = countsPerSecond;
+
+    setTolerance(_tolerancePPM); // Recalculate the counts
+    reset();
+
+    return (_queue != nullptr);
+}
+
+/// @brief Forget the phase. The next edge is the new reference
+void SfeSiT5811PPS::reset(void)
+{
+    _haveReference = false;
+    _lastCount = 0;
+    _phaseCounts = 0;
+    _biasMillis = 0.0;
+    _edges = 0;
+    _dropped = 0;
+    _rejected = 0;
+    _skipped = 0;
+}
+
+/// @brief Set the PI gains passed to setFrequencyByBiasMillis
+/// @param Pk the Proportional term. Default: 0.5
+/// @param Ik the Integral term. Default: 0.1
+void SfeSiT5811PPS::setGains(double Pk, double Ik)
+{
+    _Pk = Pk;
+    _Ik = Ik;
+}
+
+/// @brief Set the glitch tolerance
+/// @param ppm reject an interval more than this far from a whole number of seconds. Default: 100
+void SfeSiT5811PPS::setTolerance(double ppm)
+{
+    if (ppm < 0.0)
+        ppm = 0.0 - ppm;
+    _tolerancePPM = ppm;
+
+    double counts = (double)_countsPerSecond * ppm * 1.0e-6;
+    if (counts > (double)(_countsPerSecond / 2))
+        counts = (double)(_countsPerSecond / 2); // Beyond this the whole seconds are ambiguous
+    _toleranceCounts = (uint32_t)counts;
+}
+
+/// @brief Drain the queue and steer with the newest edge
+/// @return the number of edges consumed
+uint8_t SfeSiT5811PPS::update(void)
+{
+    if (_queue == nullptr)
+        return 0;
+
+    uint8_t consumed = 0;
+    bool steer = false;
+    sfe_SiT5811_pps_edge_t edge;
+    while (_queue->pop(edge))
+    {
+        consumed++;
+        if (addEdge(edge))
+        {
+            if (steer)
+                _skipped++; // A newer edge replaces it
+            steer = true;
+        }
+    }
+
+    if (!steer)
+        return consumed;
+
+    _biasMillis = (getPhaseSeconds() - _offsetSeconds) * 1.0e3;
+
+    if (_driver != nullptr)
+        _driver->setFrequencyByBiasMillis(_biasMillis, _Pk, _Ik);
+
+    return consumed;
+}
+
+/// @brief Get the phase: the OCXO time minus the PPS time, from the first edge, in seconds
+double SfeSiT5811PPS::getPhaseSeconds(void)
+{
+    return (double)_phaseCounts / (double)_countsPerSecond;
+}
+
+/// @brief PRIVATE: Add an edge to the phase
+/// The interval since the last edge is rounded to whole seconds. The counts over or under
+/// countsPerSecond per second are the OCXO's phase change: more counts, the OCXO is fast (ahead).
+/// @param edge the edge
+/// @return true if the edge was used, false if it was rejected
+bool SfeSiT5811PPS::addEdge(const sfe_SiT5811_pps_edge_t &edge)
+{
+    _edges++;
+    _dropped += edge.dropped;
+
+    if (!_haveReference)
+    {
+        _haveReference = true;
+        _lastCount = edge.count;
+        return true; // Phase zero
+    }
+
+    uint32_t interval = edge.count - _lastCount; // Unsigned subtraction unwraps the counter
+    uint32_t seconds = (uint32_t)(((uint64_t)interval + (_countsPerSecond / 2)) / _countsPerSecond);
+    int64_t residual = (int64_t)interval - ((int64_t)seconds * (int64_t)_countsPerSecond);
+    uint64_t magnitude = (uint64_t)((residual < 0) ? (0 - residual) : residual);
+
+    // A glitch: a spurious edge (less than half a second), or too far from a whole number of seconds
+    if ((seconds == 0) || (magnitude > ((uint64_t)_toleranceCounts * seconds)))
+    {
+        _rejected++;
+        return false;
+    }
+
+    _lastCount = edge.count;
+    _phaseCounts += residual;
+    return true;
+}
@@ -0,0 +1,211 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_PPS.h
+
+    Description:
+    An alternative bias source: the GNSS PPS (pulse per second) edge, timestamped in an
+    interrupt against a counter clocked by the OCXO. The loop then runs at the PPS rate,
+    with no message parsing in the path.
+
+    SfeSiT5811PPSQueue is a lock-free single-producer, single-consumer ring of edges:
+        The ISR (the only producer) calls push with the captured counter value. push is a
+        few loads and stores: it never blocks, never allocates and never waits for the
+        consumer. If the ring is full the edge is dropped and counted; the count rides on
+        the next edge which fits.
+        The main loop (the only consumer) calls pop, usually via SfeSiT5811PPS::update.
+    Each side writes only its own index. The indexes are uint8_t, so every load and store
+    is a single access even on AVR, and the release/acquire ordering of the __atomic builtins
+    (GCC and Clang, on every Arduino core) publishes the edge before the index. No interrupt
+    masking is needed.
+
+    SfeSiT5811PPS is the consumer. For each edge it unwraps the 32-bit counter, rounds the
+    interval to whole seconds (so missed edges are fine) and accumulates the phase: the
+    counts over or under countsPerSecond per second. The phase is measured from the first
+    edge, so the loop holds the OCXO at the phase it had then; setPhaseOffset moves the
+    target. It converts the phase to a bias (a positive bias: the OCXO is ahead) and steers
+    with setFrequencyByBiasMillis, once per update with the newest edge. An interval which
+    is not within the tolerance (default 100ppm) of a whole number of seconds is rejected as
+    a glitch.
+
+    The resolution is one count: 100ns with a 10MHz counter. Use the fastest counter your
+    hardware has (e.g. a timer clocked from the OCXO through a PLL), or expect the time
+    error to limit-cycle within a count.
+
+    Usage:
+        SfeSiT5811PPSQueueN<8> ppsQueue;
+        SfeSiT5811PPS pps;
+
+        void SFE_SIT5811_ISR_ATTR ppsISR() { ppsQueue.push(readCaptureRegister()); }
+
+        pps.begin(&ppsQueue, &myOCXO, 10000000); // Counter at 10MHz
+        attachInterrupt(digitalPinToInterrupt(ppsPin), ppsISR, RISING);
+        ...
+        pps.update(); // In loop(): drains the queue and steers
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811.h"
+
+// push runs in an interrupt: on ESP32 and ESP8266 it must be in IRAM
+#ifndef SFE_SIT5811_ISR_ATTR
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+#define SFE_SIT5811_ISR_ATTR IRAM_ATTR
+#else
+#define SFE_SIT5811_ISR_ATTR
+#endif
+#endif
+
+// One PPS edge
+typedef struct
+{
+    uint32_t count; // The counter value captured at the edge
+    uint8_t dropped; // Edges dropped (ring full) just before this one. Saturates at 255
+} sfe_SiT5811_pps_edge_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811PPSQueue
+{
+public:
+    /// @brief Forget all edges. Call only when the producer is stopped (e.g. before attachInterrupt)
+    void reset(void);
+
+    /// @brief Add an edge. Producer (ISR) only. Bounded: never blocks
+    /// @param count the counter value captured at the edge
+    /// @return true if the edge was queued, false if the ring was full and it was dropped
+    bool push(uint32_t count);
+
+    /// @brief Remove the oldest edge. Consumer only
+    /// @param edge returns the edge
+    /// @return true if an edge was returned, false if the ring was empty
+    bool pop(sfe_SiT5811_pps_edge_t &edge);
+
+    /// @brief Get the number of edges waiting. Consumer only
+    uint8_t available(void);
+
+    /// @brief Get the ring size
+    uint8_t getCapacity(void) { return _size; }
+
+protected:
+    /// @brief Constructor. The storage is provided by SfeSiT5811PPSQueueN
+    SfeSiT5811PPSQueue(uint8_t size, sfe_SiT5811_pps_edge_t *edges) : _edges{edges}, _size{size}
+    {
+    }
+
+private:
+    sfe_SiT5811_pps_edge_t *_edges;
+    uint8_t _size; // A power of two, so the free-running indexes wrap cleanly at 256
+    uint8_t _head; // Edges pushed, modulo 256. Written by the producer only
+    uint8_t _tail; // Edges popped, modulo 256. Written by the consumer only
+    uint8_t _dropped; // Edges dropped since the last push. Producer only
+};
+
+/// @brief The PPS ring, with its storage. Size is the number of edges it can hold
+template <uint8_t Size> class SfeSiT5811PPSQueueN : public SfeSiT5811PPSQueue
+{
+public:
+    static_assert((Size >= 2) && (Size <= 128) && ((Size & (Size - 1)) == 0), "Size must be a power of two, 2 to 128");
+
+    /// @brief Constructor
+    SfeSiT5811PPSQueueN() : SfeSiT5811PPSQueue(Size, _edgeStore)
+    {
+        reset();
+    }
+
+private:
+    sfe_SiT5811_pps_edge_t _edgeStore[Size];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811PPS
+{
+public:
+    SfeSiT5811PPS()
+        : _queue{nullptr}, _driver{nullptr}, _countsPerSecond{10000000}, _tolerancePPM{100.0}, _toleranceCounts{1000},
+          _Pk{0.5}, _Ik{0.1}, _offsetSeconds{0.0}
+    {
+        reset();
+    }
+
+    /// @brief Start consuming edges
+    /// @param queue the ring which the ISR pushes to
+    /// @param driver the driver to steer. nullptr: measure only (getBiasMillis)
+    /// @param countsPerSecond the nominal counter frequency in Hz. 0: the driver's base frequency
+    /// @return true if started
+    bool begin(SfeSiT5811PPSQueue *queue, SfeSiT5811Driver *driver, uint32_t countsPerSecond = 0);
+
+    /// @brief Forget the phase. The next edge is the new reference
+    void reset(void);
+
+    /// @brief Set the PI gains passed to setFrequencyByBiasMillis
+    /// @param Pk the Proportional term. Default: 0.5
+    /// @param Ik the Integral term. Default: 0.1
+    void setGains(double Pk, double Ik);
+
+    /// @brief Set the glitch tolerance
+    /// @param ppm reject an interval more than this far from a whole number of seconds. Default: 100
+    void setTolerance(double ppm);
+
+    /// @brief Set the target phase
+    /// @param seconds the phase to hold, relative to the first edge. Default: 0
+    void setPhaseOffset(double seconds) { _offsetSeconds = seconds; }
+
+    /// @brief Drain the queue and steer with the newest edge
+    /// @return the number of edges consumed
+    uint8_t update(void);
+
+    /// @brief Get the phase: the OCXO time minus the PPS time, from the first edge, in seconds
+    double getPhaseSeconds(void);
+
+    /// @brief Get the bias used for the last steering step, in milliseconds
+    double getBiasMillis(void) { return _biasMillis; }
+
+    /// @brief Get the number of edges consumed since reset
+    uint32_t getEdges(void) { return _edges; }
+
+    /// @brief Get the number of edges dropped by the ISR (ring full) since reset
+    uint32_t getDropped(void) { return _dropped; }
+
+    /// @brief Get the number of edges rejected as glitches since reset
+    uint32_t getRejected(void) { return _rejected; }
+
+    /// @brief Get the number of edges which were not steered with because a newer edge was waiting
+    uint32_t getSkipped(void) { return _skipped; }
+
+private:
+    /// @brief Add an edge to the phase
+    /// @param edge the edge
+    /// @return true if the edge was used, false if it was rejected
+    bool addEdge(const sfe_SiT5811_pps_edge_t &edge);
+
+    SfeSiT5811PPSQueue *_queue;
+    SfeSiT5811Driver *_driver;
+    uint32_t _countsPerSecond;
+    double _tolerancePPM;
+    uint32_t _toleranceCounts; // _tolerancePPM in counts per second
+    double _Pk;
+    double _Ik;
+    double _offsetSeconds;
+
+    bool _haveReference; // true after the first edge
+    uint32_t _lastCount; // The counter at the last edge used
+    int64_t _phaseCounts; // Counts over or under countsPerSecond per second, since the first edge
+    double _biasMillis;
+    uint32_t _edges;
+    uint32_t _dropped;
+    uint32_t _rejected;
+    uint32_t _skipped;
+};
@@ -0,0 +1,176 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_RegisterFile.cpp
+
+    Description:
+    An in-memory stand-in for the SiT5811, implementing SfeSiT5811Bus.
+
+*/
+
+#include "SparkFun_SiT5811_RegisterFile.h"
+
+/// @brief Clear all registers and counters
+void SfeSiT5811RegisterFile::reset(void)
+{
+    for (size_t i = 0; i < sizeof(_registerBytes); i++)
+        _registerBytes[i] = 0;
+
+    _writePollsRemaining = 0;
+
+    resetCounters();
+}
+
+/// @brief Clear the transaction and byte counters
+void SfeSiT5811RegisterFile::resetCounters(void)
+{
+    _transactions = 0;
+    _bytesOnWire = 0;
+}
+
+/// @brief Set a 16-bit register directly (without counting a transaction)
+/// @param reg the register address (0x00 to 0x0E)
+/// @param value the 16-bit register value
+void SfeSiT5811RegisterFile::setRegister(uint8_t reg, uint16_t value)
+{
+    if (reg >= kSfeSiT5811RegisterFileNumRegs)
+        return;
+
+    _registerBytes[(reg * 2) + 0] = (uint8_t)(value >> 8); // MSB first
+    _registerBytes[(reg * 2) + 1] = (uint8_t)(value & 0xFF);
+}
+
+/// @brief Get a 16-bit register directly (without counting a transaction)
+/// @param reg the register address (0x00 to 0x0E)
+/// @return the 16-bit register value. Zero if reg is out of range
+uint16_t SfeSiT5811RegisterFile::getRegister(uint8_t reg)
+{
+    if (reg >= kSfeSiT5811RegisterFileNumRegs)
+        return 0;
+
+    return (((uint16_t)_registerBytes[(reg * 2) + 0]) << 8) | ((uint16_t)_registerBytes[(reg * 2) + 1]);
+}
+
+/// @brief Get the 39-bit frequency control word held in registers 0x0C to 0x0E
+/// @return The 39-bit frequency control word as int64_t (signed, two's complement)
+int64_t SfeSiT5811RegisterFile::getFrequencyControlWord(void)
+{
+    // Extract the 39-bit Frequency Control Word - as per the emulator
+    uint64_t freqControl = ((uint64_t)_registerBytes[28]) >> 1;
+    freqControl |= ((uint64_t)_registerBytes[27]) << 7;
+    freqControl |= ((uint64_t)_registerBytes[26]) << 15;
+    freqControl |= ((uint64_t)_registerBytes[25]) << 23;
+    freqControl |= ((uint64_t)_registerBytes[24]) << 31;
+    if (freqControl & 0x0000004000000000) // Correct two's complement
+        freqControl |= 0xFFFFFFC000000000;
+
+    union // Avoid any ambiguity when converting uint64_t to int64_t
+    {
+        uint64_t unsigned64;
+        int64_t signed64;
+    } unsignedSigned64;
+    unsignedSigned64.unsigned64 = freqControl;
+
+    return unsignedSigned64.signed64;
+}
+
+/// @brief Check that the device is present on the bus
+/// @return kSfeSiT5811ErrOk
+sfe_SiT5811_err_t SfeSiT5811RegisterFile::ping(void)
+{
+    countTransaction(1); // Address only
+
+    return kSfeSiT5811ErrOk;
+}
+
+/// @brief Read a block of bytes, starting at register address reg
+/// @param reg the (8-bit) register address
+/// @param data pointer to the buffer which will hold the bytes
+/// @param numBytes the number of bytes to read
+/// @param readBytes returns the number of bytes actually read
+/// @return kSfeSiT5811ErrOk. readBytes will be less than numBytes if the read runs off the end of the file
+sfe_SiT5811_err_t SfeSiT5811RegisterFile::readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes)
+{
+    readBytes = loadBytes(reg, data, numBytes);
+    countTransaction(3 + readBytes); // Address + register address + repeated-start address + data
+
+    return kSfeSiT5811ErrOk;
+}
+
+/// @brief Write a block of bytes, starting at register address reg
+/// @param reg the (8-bit) register address
+/// @param data pointer to the bytes to be written
+/// @param numBytes the number of bytes to write
+/// @return kSfeSiT5811ErrOk. Bytes beyond the end of the file are discarded
+sfe_SiT5811_err_t SfeSiT5811RegisterFile::writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    storeBytes(reg, data, numBytes);
+    countTransaction(2 + numBytes); // Address + register address + data
+
+    return kSfeSiT5811ErrOk;
+}
+
+/// @brief Start a write without waiting for it to complete
+/// @param reg the (8-bit) register address
+/// @param data pointer to the bytes to be written. Must remain valid until pollWrite returns kSfeSiT5811ErrOk
+/// @param numBytes the number of bytes to write
+/// @return kSfeSiT5811ErrOk if the write has completed, kSfeSiT5811ErrBusy if it is in progress
+sfe_SiT5811_err_t SfeSiT5811RegisterFile::startWriteRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    if (_writePolls == 0)
+        return writeRegisterRegion(reg, data, numBytes);
+
+    // The registers are updated when the write completes, as they would be on a real bus
+    _writeReg = reg;
+    _writeData = data;
+    _writeNumBytes = numBytes;
+    _writePollsRemaining = _writePolls;
+
+    return kSfeSiT5811ErrBusy;
+}
+
+/// @brief Check on a write started by startWriteRegisterRegion
+/// @return kSfeSiT5811ErrOk if the write has completed, kSfeSiT5811ErrBusy if it is in progress
+sfe_SiT5811_err_t SfeSiT5811RegisterFile::pollWrite(void)
+{
+    if (_writePollsRemaining == 0)
+        return kSfeSiT5811ErrOk;
+
+    if (--_writePollsRemaining > 0)
+        return kSfeSiT5811ErrBusy;
+
+    return writeRegisterRegion(_writeReg, _writeData, _writeNumBytes);
+}
+
+/// @brief  PROTECTED: Copy register bytes out, from register reg to the end of the file
+/// @return the number of bytes copied
+size_t SfeSiT5811RegisterFile::loadBytes(uint8_t reg, uint8_t *data, size_t numBytes)
+{
+    size_t count = 0;
+    for (size_t i = reg * 2; (i < sizeof(_registerBytes)) && (count < numBytes); i++)
+        data[count++] = _registerBytes[i];
+    return count;
+}
+
+/// @brief  PROTECTED: Copy bytes into the registers, from register reg. Bytes beyond the end of the file are discarded
+void SfeSiT5811RegisterFile::storeBytes(uint8_t reg, const uint8_t *data, size_t numBytes)
+{
+    for (size_t i = 0; i < numBytes; i++)
+        if (((reg * 2) + i) < sizeof(_registerBytes))
+            _registerBytes[(reg * 2) + i] = data[i];
+}
+
+/// @brief  PROTECTED: Count a bus transaction
+/// @param  bytesOnWire the bytes it put on the wire, including the address
+void SfeSiT5811RegisterFile::countTransaction(uint32_t bytesOnWire)
+{
+    _transactions++;
+    _bytesOnWire += bytesOnWire;
+}
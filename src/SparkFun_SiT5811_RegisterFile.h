@@ -0,0 +1,99 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_RegisterFile.h
+
+    Description:
+    An in-memory stand-in for the SiT5811, implementing SfeSiT5811Bus.
+    It has the same register semantics as examples/SiT5811_Emulator:
+        Registers 0x00 (DCXO Clip) to 0x0E (DCXO LSW), 16-bit, MSB first
+        Reads return the bytes from the register address to the end of the file
+        Writes beyond the end of the file are discarded
+    It also counts bus transactions and bytes, so the driver's bus traffic can be
+    measured without a logic analyzer.
+    SfeSiT5811Emulator derives from it to inject bus faults.
+
+*/
+
+#pragma once
+
+#include "SparkFun_SiT5811_Bus.h"
+
+const uint8_t kSfeSiT5811RegisterFileNumRegs = 15; // Registers 0x00 to 0x0E
+
+class SfeSiT5811RegisterFile : public SfeSiT5811Bus
+{
+public:
+    /// @brief Constructor. All registers are zero (clip = 0 = +/-800ppm)
+    SfeSiT5811RegisterFile() : _writePolls{0}
+    {
+        reset();
+    }
+
+    /// @brief Clear all registers and counters
+    void reset(void);
+
+    /// @brief Clear the transaction and byte counters
+    void resetCounters(void);
+
+    /// @brief Set a 16-bit register directly (without counting a transaction)
+    /// @param reg the register address (0x00 to 0x0E)
+    /// @param value the 16-bit register value
+    void setRegister(uint8_t reg, uint16_t value);
+
+    /// @brief Get a 16-bit register directly (without counting a transaction)
+    /// @param reg the register address (0x00 to 0x0E)
+    /// @return the 16-bit register value. Zero if reg is out of range
+    uint16_t getRegister(uint8_t reg);
+
+    /// @brief Get the 39-bit frequency control word held in registers 0x0C to 0x0E
+    /// @return The 39-bit frequency control word as int64_t (signed, two's complement)
+    int64_t getFrequencyControlWord(void);
+
+    /// @brief Get the number of bus transactions (ping, read or write) since the last resetCounters
+    uint32_t getTransactions(void) { return _transactions; }
+
+    /// @brief Get the number of bytes on the wire since the last resetCounters
+    /// Note: this includes the address byte of each transaction and the register address byte of each read and write
+    uint32_t getBytesOnWire(void) { return _bytesOnWire; }
+
+    /// @brief Emulate a non-blocking bus: startWriteRegisterRegion completes after this many calls to pollWrite
+    /// @param polls the number of pollWrite calls per write. 0 (default): writes complete immediately
+    void setWritePolls(uint8_t polls) { _writePolls = polls; }
+
+    sfe_SiT5811_err_t ping(void);
+    sfe_SiT5811_err_t readRegisterRegion(uint8_t reg, uint8_t *data, size_t numBytes, size_t &readBytes);
+    sfe_SiT5811_err_t writeRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes);
+    sfe_SiT5811_err_t startWriteRegisterRegion(uint8_t reg, const uint8_t *data, size_t numBytes);
+    sfe_SiT5811_err_t pollWrite(void);
+
+protected:
+    /// @brief Copy register bytes out, from register reg to the end of the file
+    /// @return the number of bytes copied
+    size_t loadBytes(uint8_t reg, uint8_t *data, size_t numBytes);
+
+    /// @brief Copy bytes into the registers, from register reg. Bytes beyond the end of the file are discarded
+    void storeBytes(uint8_t reg, const uint8_t *data, size_t numBytes);
+
+    /// @brief Count a bus transaction
+    /// @param bytesOnWire the bytes it put on the wire, including the address
+    void countTransaction(uint32_t bytesOnWire);
+
+private:
+    uint8_t _registerBytes[kSfeSiT5811RegisterFileNumRegs * 2]; // The register contents, MSB first
+    uint32_t _transactions; // Number of bus transactions
+    uint32_t _bytesOnWire; // Number of bytes on the wire
+
+    uint8_t _writePolls; // pollWrite calls per non-blocking write
+    uint8_t _writePollsRemaining; // pollWrite calls until the write in progress completes
+    uint8_t _writeReg; // The write in progress
+    const uint8_t *_writeData;
+    size_t _writeNumBytes;
+};
@@ -0,0 +1,288 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Shared.cpp
+
+    Description:
+    SfeSiT5811Driver shared by several tasks: serialized writers, and readers which copy
+    a sequence latch and never take the lock.
+
+    The ordering: publish starts with a release fence, so the sequence store of the previous
+    publish (which moved the readers off the copy now being written) is visible before any of
+    the new words. read ends with an acquire fence before it re-reads the sequence, so if it
+    saw any of the new words it also sees the new sequence, and copies again.
+
+*/
+
+#include "SparkFun_SiT5811_Shared.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#endif
+
+/// @brief Share a driver. Call once, before the other tasks start, after the driver's begin
+/// @param driver the driver
+/// @param lock the lock which serializes the writers. nullptr: a SfeSiT5811SpinLock
+/// @return true if started
+bool SfeSiT5811Shared::begin(SfeSiT5811Driver *driver, SfeSiT5811Lock *lock)
+{
+    if (driver == nullptr)
+        return false;
+
+    _driver = driver;
+    _lock = (lock != nullptr) ? lock : &_spinLock;
+
+    // Fill both copies, so a reader never sees an empty one
+    _lock->lock();
+    publish();
+    publish();
+    _lock->unlock();
+
+    return true;
+}
+
+/// @brief setFrequencyControlWord, serialized
+bool SfeSiT5811Shared::setFrequencyControlWord(int64_t freq)
+{
+    if (_driver == nullptr)
+        return false;
+
+    _lock->lock();
+    return finish(_driver->setFrequencyControlWord(freq));
+}
+
+/// @brief setFrequencyHz, serialized
+bool SfeSiT5811Shared::setFrequencyHz(double freq)
+{
+    if (_driver == nullptr)
+        return false;
+
+    _lock->lock();
+    return finish(_driver->setFrequencyHz(freq));
+}
+
+/// @brief setFrequencyOffsetPPQ, serialized
+bool SfeSiT5811Shared::setFrequencyOffsetPPQ(int64_t ppq)
+{
+    if (_driver == nullptr)
+        return false;
+
+    _lock->lock();
+    return finish(_driver->setFrequencyOffsetPPQ(ppq));
+}
+
+/// @brief setFrequencyByBiasMillis, serialized
+bool SfeSiT5811Shared::setFrequencyByBiasMillis(double bias, double Pk, double Ik)
+{
+    if (_driver == nullptr)
+        return false;
+
+    _lock->lock();
+    _lastBiasMillis = bias;
+    return finish(_driver->setFrequencyByBiasMillis(bias, Pk, Ik));
+}
+
+/// @brief setBaseFrequencyHz, serialized
+void SfeSiT5811Shared::setBaseFrequencyHz(double freq)
+{
+    if (_driver == nullptr)
+        return;
+
+    _lock->lock();
+    _driver->setBaseFrequencyHz(freq);
+    finish(true);
+}
+
+/// @brief readRegisters, serialized
+bool SfeSiT5811Shared::readRegisters(void)
+{
+    if (_driver == nullptr)
+        return false;
+
+    _lock->lock();
+    return finish(_driver->readRegisters());
+}
+
+/// @brief readAllRegisters, serialized
+bool SfeSiT5811Shared::readAllRegisters(void)
+{
+    if (_driver == nullptr)
+        return false;
+
+    _lock->lock();
+    return finish(_driver->readAllRegisters());
+}
+
+/// @brief poll, serialized. In asynchronous mode the word is published when its write completes
+sfe_SiT5811_err_t SfeSiT5811Shared::poll(void)
+{
+    if (_driver == nullptr)
+        return kSfeSiT5811ErrBusNotInit;
+
+    _lock->lock();
+    sfe_SiT5811_err_t result = _driver->poll();
+    finish(result >= kSfeSiT5811ErrOk); // kSfeSiT5811ErrBusy is not a failure
+    return result;
+}
+
+/// @brief Take the lock, for anything the writers above do not cover. Call release when done
+/// @return the driver
+SfeSiT5811Driver *SfeSiT5811Shared::acquire(void)
+{
+    if (_driver == nullptr)
+        return nullptr;
+
+    _lock->lock();
+    return _driver;
+}
+
+/// @brief Publish the state and release the lock taken by acquire
+void SfeSiT5811Shared::release(void)
+{
+    if (_driver == nullptr)
+        return;
+
+    finish(true);
+}
+
+/// @brief Copy the published state
+/// @param state returns the state
+void SfeSiT5811Shared::read(sfe_SiT5811_shared_state_t &state)
+{
+    cache_t copy;
+    sfe_SiT5811_sequence_t before;
+    sfe_SiT5811_sequence_t after;
+
+    do
+    {
+        before = loadSequence();
+
+        const sfe_SiT5811_word_t *words = _cache[before & 1];
+        for (uint8_t i = 0; i < kWords; i++)
+            copy.words[i] = __atomic_load_n(&words[i], __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = loadSequence();
+    } while (before != after);
+
+    state = copy.state;
+}
+
+/// @brief Get the 39-bit frequency control word - from the published state
+int64_t SfeSiT5811Shared::getFrequencyControlWord(void)
+{
+    sfe_SiT5811_shared_state_t state;
+    read(state);
+    return state.frequencyControl;
+}
+
+/// @brief Get the oscillator frequency - from the published state
+double SfeSiT5811Shared::getFrequencyHz(void)
+{
+    sfe_SiT5811_shared_state_t state;
+    read(state);
+    return state.frequencyHz;
+}
+
+/// @brief Get the fractional frequency offset in PPQ - from the published state
+int64_t SfeSiT5811Shared::getFrequencyOffsetPPQ(void)
+{
+    sfe_SiT5811_shared_state_t state;
+    read(state);
+    return state.frequencyOffsetPPQ;
+}
+
+/// @brief Get the bias passed to the last setFrequencyByBiasMillis - from the published state
+double SfeSiT5811Shared::getLastBiasMillis(void)
+{
+    sfe_SiT5811_shared_state_t state;
+    read(state);
+    return state.lastBiasMillis;
+}
+
+/// @brief Get the number of times the state has been published
+uint32_t SfeSiT5811Shared::getUpdates(void)
+{
+    sfe_SiT5811_shared_state_t state;
+    read(state);
+    return state.updates;
+}
+
+/// @brief PRIVATE: Copy the driver's state to the readers' cache. Call with the lock held
+/// The readers use _cache[_sequence & 1]. This writes the other copy, then increments _sequence
+void SfeSiT5811Shared::publish(void)
+{
+    cache_t copy;
+    for (uint8_t i = 0; i < kWords; i++)
+        copy.words[i] = 0; // The padding too
+
+    _updates++;
+    copy.state.frequencyControl = _driver->getFrequencyControlWord();
+    copy.state.frequencyOffsetPPQ = _driver->getFrequencyOffsetPPQ();
+    copy.state.frequencyHz = _driver->getFrequencyHz();
+    copy.state.baseFrequencyHz = _driver->getBaseFrequencyHz();
+    copy.state.maxPullAvailable = _driver->getMaxPullAvailable();
+    copy.state.lastBiasMillis = _lastBiasMillis;
+    copy.state.updates = _updates;
+    copy.state.failures = _failures;
+    copy.state.clip = _driver->getPullRangeClip();
+
+    sfe_SiT5811_sequence_t sequence = _sequence; // Only the lock holder writes _sequence
+    sfe_SiT5811_word_t *words = _cache[(sequence + 1) & 1];
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (uint8_t i = 0; i < kWords; i++)
+        __atomic_store_n(&words[i], copy.words[i], __ATOMIC_RELAXED);
+
+    storeSequence((sfe_SiT5811_sequence_t)(sequence + 1));
+}
+
+/// @brief PRIVATE: Load the sequence, with acquire ordering
+/// @return the sequence
+sfe_SiT5811_sequence_t SfeSiT5811Shared::loadSequence(void)
+{
+#if defined(__AVR__)
+    // Both bytes with interrupts disabled. cli is also a compiler barrier
+    uint8_t sreg = SREG;
+    cli();
+    sfe_SiT5811_sequence_t sequence = _sequence;
+    SREG = sreg;
+    return sequence;
+#else
+    return __atomic_load_n(&_sequence, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/// @brief PRIVATE: Store the sequence, with release ordering. Call with the lock held
+/// @param sequence the new sequence
+void SfeSiT5811Shared::storeSequence(sfe_SiT5811_sequence_t sequence)
+{
+#if defined(__AVR__)
+    uint8_t sreg = SREG;
+    cli();
+    _sequence = sequence;
+    SREG = sreg;
+#else
+    __atomic_store_n(&_sequence, sequence, __ATOMIC_RELEASE);
+#endif
+}
+
+/// @brief PRIVATE: Count a failed write, publish and release the lock
+/// @param success the result of the write
+/// @return success
+bool SfeSiT5811Shared::finish(bool success)
+{
+    if (!success)
+        _failures++;
+    publish();
+    _lock->unlock();
+    return success;
+}
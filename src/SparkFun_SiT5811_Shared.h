@@ -0,0 +1,261 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Shared.h
+
+    Description:
+    SfeSiT5811Driver shared by several tasks or threads (e.g. FreeRTOS on ESP32): one task
+    steers while others read the frequency for telemetry or a web page.
+
+    SfeSiT5811Driver itself is not synchronized, and its 64-bit control word can tear on a
+    32-bit core. SfeSiT5811Shared wraps a driver:
+        Writers (setFrequency..., read...Registers, poll) are serialized by a lock, so only
+        one task is ever on the bus. Any number of tasks may write.
+        After each write the driver's state is published to a cache. Readers (read and the
+        get... methods) copy the cache and never take the lock: they never wait for the bus,
+        and a reader of higher priority never waits for the writer to run.
+
+    The cache is a sequence latch: two copies and a sequence number. The writer updates the
+    copy the readers are not using, then increments the sequence to switch them to it. A
+    reader copies the current copy and checks that the sequence did not change meanwhile;
+    if it did, it copies again. A reader retries only if an update completes during its
+    copy: a writer preempted mid-update cannot stall the readers, they keep the other copy.
+
+    The lock is a SfeSiT5811Lock. On ESP32 use SfeSiT5811FreeRTOSLock (a FreeRTOS mutex, with
+    priority inheritance). The default is SfeSiT5811SpinLock, which needs no RTOS but must
+    not be used where a task can preempt the lock holder on the same core and then spin.
+
+    Usage:
+        SfeSiT5811FreeRTOSLock ocxoLock;
+        SfeSiT5811Shared sharedOCXO;
+
+        myOCXO.begin();
+        sharedOCXO.begin(&myOCXO, &ocxoLock);
+
+        sharedOCXO.setFrequencyByBiasMillis(bias); // Steering task
+        double hz = sharedOCXO.getFrequencyHz(); // Any other task: never blocks
+
+    Everything else (the discipline, setAsyncMode, attached engines such as SfeSiT5811PPS or
+    SfeSiT5811Holdover which call the driver themselves) must run between acquire and release.
+    The asynchronous callback runs with the lock held: it must not call the writers.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+// The cache is copied in words of this size. On AVR, byte copies keep every access single-instruction
+#if defined(__AVR__)
+typedef uint8_t sfe_SiT5811_word_t;
+#else
+typedef uint32_t sfe_SiT5811_word_t;
+#endif
+
+// The sequence. A reader is fooled only if it is held off for exactly a multiple of 2^bits publishes
+// while it copies (the sequence wraps back to the value it first read). On AVR a byte would wrap after
+// 256: the sequence is 16 bits, loaded and stored with interrupts disabled (AVR has no 16-bit atomics)
+#if defined(__AVR__)
+typedef uint16_t sfe_SiT5811_sequence_t;
+#else
+typedef uint32_t sfe_SiT5811_sequence_t;
+#endif
+
+// The driver state published to the readers
+typedef struct
+{
+    int64_t frequencyControl; // getFrequencyControlWord: the word on the device
+    int64_t frequencyOffsetPPQ; // getFrequencyOffsetPPQ
+    double frequencyHz; // getFrequencyHz
+    double baseFrequencyHz; // getBaseFrequencyHz
+    double maxPullAvailable; // getMaxPullAvailable
+    double lastBiasMillis; // The bias passed to the last setFrequencyByBiasMillis
+    uint32_t updates; // The number of times the state has been published
+    uint32_t failures; // The number of writes which failed
+    uint16_t clip; // getPullRangeClip
+} sfe_SiT5811_shared_state_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Lock
+{
+public:
+    /// @brief Wait for and take the lock
+    virtual void lock(void) = 0;
+
+    /// @brief Release the lock
+    virtual void unlock(void) = 0;
+};
+
+// A test-and-set spin lock. No RTOS needed, but a task which spins while the holder
+// is preempted on the same core never gets the lock back: use it only across cores, or
+// where the holder cannot be preempted by a task which takes the lock
+class SfeSiT5811SpinLock : public SfeSiT5811Lock
+{
+public:
+    SfeSiT5811SpinLock() : _locked{0}
+    {
+    }
+
+    void lock(void)
+    {
+        while (__atomic_exchange_n(&_locked, (uint8_t)1, __ATOMIC_ACQUIRE) != 0)
+        {
+        }
+    }
+
+    void unlock(void)
+    {
+        __atomic_store_n(&_locked, (uint8_t)0, __ATOMIC_RELEASE);
+    }
+
+private:
+    uint8_t _locked;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+// A FreeRTOS mutex (with priority inheritance). Statically allocated, so it can be a global
+class SfeSiT5811FreeRTOSLock : public SfeSiT5811Lock
+{
+public:
+    SfeSiT5811FreeRTOSLock()
+    {
+        _mutex = xSemaphoreCreateMutexStatic(&_mutexBuffer);
+    }
+
+    void lock(void)
+    {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+    }
+
+    void unlock(void)
+    {
+        xSemaphoreGive(_mutex);
+    }
+
+private:
+    StaticSemaphore_t _mutexBuffer;
+    SemaphoreHandle_t _mutex;
+};
+
+#endif // defined(ARDUINO_ARCH_ESP32)
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Shared
+{
+public:
+    SfeSiT5811Shared() : _driver{nullptr}, _lock{&_spinLock}, _sequence{0}, _lastBiasMillis{0.0}, _updates{0}, _failures{0}
+    {
+    }
+
+    /// @brief Share a driver. Call once, before the other tasks start, after the driver's begin
+    /// @param driver the driver
+    /// @param lock the lock which serializes the writers. nullptr: a SfeSiT5811SpinLock
+    /// @return true if started
+    bool begin(SfeSiT5811Driver *driver, SfeSiT5811Lock *lock = nullptr);
+
+    // Writers: serialized by the lock, then the state is published
+
+    /// @brief setFrequencyControlWord, serialized
+    bool setFrequencyControlWord(int64_t freq);
+
+    /// @brief setFrequencyHz, serialized
+    bool setFrequencyHz(double freq);
+
+    /// @brief setFrequencyOffsetPPQ, serialized
+    bool setFrequencyOffsetPPQ(int64_t ppq);
+
+    /// @brief setFrequencyByBiasMillis, serialized
+    bool setFrequencyByBiasMillis(double bias, double Pk = 0.5, double Ik = 0.1);
+
+    /// @brief setBaseFrequencyHz, serialized
+    void setBaseFrequencyHz(double freq);
+
+    /// @brief readRegisters, serialized
+    bool readRegisters(void);
+
+    /// @brief readAllRegisters, serialized
+    bool readAllRegisters(void);
+
+    /// @brief poll, serialized. In asynchronous mode the word is published when its write completes
+    sfe_SiT5811_err_t poll(void);
+
+    /// @brief Take the lock, for anything the writers above do not cover. Call release when done
+    /// @return the driver
+    SfeSiT5811Driver *acquire(void);
+
+    /// @brief Publish the state and release the lock taken by acquire
+    void release(void);
+
+    // Readers: never take the lock
+
+    /// @brief Copy the published state
+    /// @param state returns the state
+    void read(sfe_SiT5811_shared_state_t &state);
+
+    /// @brief Get the 39-bit frequency control word - from the published state
+    int64_t getFrequencyControlWord(void);
+
+    /// @brief Get the oscillator frequency - from the published state
+    double getFrequencyHz(void);
+
+    /// @brief Get the fractional frequency offset in PPQ - from the published state
+    int64_t getFrequencyOffsetPPQ(void);
+
+    /// @brief Get the bias passed to the last setFrequencyByBiasMillis - from the published state
+    double getLastBiasMillis(void);
+
+    /// @brief Get the number of times the state has been published
+    uint32_t getUpdates(void);
+
+private:
+    /// @brief Copy the driver's state to the readers' cache. Call with the lock held
+    void publish(void);
+
+    /// @brief Count a failed write, publish and release the lock
+    /// @param success the result of the write
+    /// @return success
+    bool finish(bool success);
+
+    /// @brief Load the sequence, with acquire ordering
+    sfe_SiT5811_sequence_t loadSequence(void);
+
+    /// @brief Store the sequence, with release ordering. Call with the lock held
+    void storeSequence(sfe_SiT5811_sequence_t sequence);
+
+    static const uint8_t kWords =
+        (uint8_t)((sizeof(sfe_SiT5811_shared_state_t) + sizeof(sfe_SiT5811_word_t) - 1) / sizeof(sfe_SiT5811_word_t));
+
+    typedef union {
+        sfe_SiT5811_shared_state_t state;
+        sfe_SiT5811_word_t words[kWords];
+    } cache_t;
+
+    SfeSiT5811Driver *_driver;
+    SfeSiT5811Lock *_lock;
+    SfeSiT5811SpinLock _spinLock; // The default lock
+
+    sfe_SiT5811_sequence_t _sequence; // Incremented by each publish. Readers use _cache[_sequence & 1]
+    sfe_SiT5811_word_t _cache[2][kWords];
+
+    // Writer only: protected by the lock
+    double _lastBiasMillis;
+    uint32_t _updates;
+    uint32_t _failures;
+};
@@ -0,0 +1,156 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Simulation.cpp
+
+    Description:
+    A simulated SiT5811 and GNSS receiver, for evaluating steering laws offline.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_Simulation.h"
+
+/// @brief Fill params with typical SiT5811 and GNSS receiver values
+/// @param params the parameters to fill
+void SfeSiT5811Simulation::getDefaultParameters(sfe_SiT5811_sim_params_t &params)
+{
+    params.epochSeconds = 1.0;
+    params.initialOffsetPPB = 5.0;
+    params.initialTimeErrorSeconds = 1.0e-6;
+    params.agingPPBPerDay = 0.05;
+    params.tempCoefficientPPBPerC = 0.01; // +/-1ppb over -40 to 85C
+    params.tempAmplitudeC = 5.0;
+    params.tempPeriodSeconds = 86400.0; // Daily
+    params.tempRandomWalkC = 0.001;
+    params.whiteFMPPB = 0.01; // ADEV(1s) of approx. 1e-11
+    params.flickerFMPPB = 0.005;
+    params.gnssNoiseSeconds = 5.0e-9; // Typical timing receiver
+    params.ovenTimeConstantSeconds = 0.0; // Already warm. Set (e.g.) 150 to simulate the warm-up
+    params.ovenSaturationSeconds = 90.0;
+    params.ovenWarmupPPB = 500.0;
+    params.ovenPowerSettled = 0.35;
+    params.ovenPowerPerC = -0.005; // Colder: more power
+    params.ovenPowerNoise = 2.0e-4;
+    params.chipID = 0x0000;
+}
+
+/// @brief Start (or restart) the simulation
+/// @param params the simulation parameters
+/// @param seed the PRNG seed. The same seed gives the same noise
+void SfeSiT5811Simulation::begin(const sfe_SiT5811_sim_params_t &params, uint64_t seed)
+{
+    _params = params;
+
+    _prng = (seed == 0) ? 1 : seed; // xorshift must not be seeded with zero
+    _epoch = 0;
+    _timeError = _params.initialTimeErrorSeconds;
+    _fractionalFrequency = 0.0;
+    _freeRunningFrequency = 0.0;
+    _aging = 0.0;
+    _temperature = 0.0;
+    _tempRandomWalk = 0.0;
+    _ovenPower = _params.ovenPowerSettled;
+    _warmupFrequency = 0.0;
+
+    _theRegisters.setRegister(kSfeSiT5811RegChipID, _params.chipID);
+
+    // Precompute everything which does not change per epoch
+    _agingPerEpoch = _params.agingPPBPerDay * 1.0e-9 * _params.epochSeconds / 86400.0;
+
+    double tempStep = 6.283185307179586 * _params.epochSeconds / _params.tempPeriodSeconds; // 2 * pi * fraction of a period
+    _tempCos = cos(tempStep);
+    _tempSin = sin(tempStep);
+    _tempPhasorCos = 1.0;
+    _tempPhasorSin = 0.0;
+
+    double tau = 10.0; // Time constants of 10, 100, 1000 and 10000 epochs
+    for (int i = 0; i < 4; i++)
+    {
+        _flickerA[i] = exp(-1.0 / tau);
+        _flickerB[i] = _params.flickerFMPPB * 1.0e-9 * sqrt(1.0 - (_flickerA[i] * _flickerA[i]));
+        _flicker[i] = 0.0;
+        tau *= 10.0;
+    }
+}
+
+/// @brief Advance the simulation by one epoch
+/// @return the GNSS RxClkBias in milliseconds - for setFrequencyByBiasMillis
+double SfeSiT5811Simulation::step(void)
+{
+    // The frequency set by the driver under test. Symmetric 2^38 scale
+    double control = (double)_theRegisters.getFrequencyControlWord() * (800.0e-6 / 274877906944.0);
+
+    // Aging
+    _aging += _agingPerEpoch;
+
+    // Temperature: rotate the phasor, add the random walk
+    double c = (_tempPhasorCos * _tempCos) - (_tempPhasorSin * _tempSin);
+    _tempPhasorSin = (_tempPhasorSin * _tempCos) + (_tempPhasorCos * _tempSin);
+    _tempPhasorCos = c;
+    _tempRandomWalk += _params.tempRandomWalkC * gaussian();
+    _temperature = (_params.tempAmplitudeC * _tempPhasorSin) + _tempRandomWalk;
+
+    // Flicker FM
+    double flicker = 0.0;
+    for (int i = 0; i < 4; i++)
+    {
+        _flicker[i] = (_flickerA[i] * _flicker[i]) + (_flickerB[i] * gaussian());
+        flicker += _flicker[i];
+    }
+
+    // Oven: full power, then an exponential settle. The warm-up offset settles with it
+    double settledPower = _params.ovenPowerSettled + (_params.ovenPowerPerC * _temperature);
+    if (_params.ovenTimeConstantSeconds > 0.0)
+    {
+        double seconds = (double)_epoch * _params.epochSeconds;
+        double remaining = 1.0;
+        if (seconds > _params.ovenSaturationSeconds)
+            remaining = exp(0.0 - ((seconds - _params.ovenSaturationSeconds) / _params.ovenTimeConstantSeconds));
+        _ovenPower = settledPower + ((1.0 - settledPower) * remaining) + (_params.ovenPowerNoise * gaussian());
+        _warmupFrequency = _params.ovenWarmupPPB * 1.0e-9 * remaining;
+    }
+    else
+        _ovenPower = settledPower;
+
+    double clamped = (_ovenPower < 0.0) ? 0.0 : ((_ovenPower > 1.0) ? 1.0 : _ovenPower);
+    uint32_t power = (uint32_t)((clamped * (double)kSfeSiT5811PowerIndicatorMax) + 0.5);
+    _theRegisters.setRegister(kSfeSiT5811RegPowerMSW, (uint16_t)(power >> 2));
+    _theRegisters.setRegister(kSfeSiT5811RegPowerLSW, (uint16_t)((power & 0x3) << 14));
+
+    _freeRunningFrequency = (_params.initialOffsetPPB * 1.0e-9) + _aging + (_params.tempCoefficientPPBPerC * 1.0e-9 * _temperature) +
+                            (_params.whiteFMPPB * 1.0e-9 * gaussian()) + flicker + _warmupFrequency;
+
+    _fractionalFrequency = _freeRunningFrequency + control;
+
+    // A fast oscillator makes the receiver time run ahead: positive bias
+    _timeError += _fractionalFrequency * _params.epochSeconds;
+
+    _epoch++;
+
+    double bias = _timeError + (_params.gnssNoiseSeconds * gaussian());
+    return bias * 1000.0; // Convert to milliseconds
+}
+
+/// @brief PRIVATE: Return an approximately Gaussian random number with zero mean and unit variance
+/// The sum of four uniform variables (Irwin-Hall) has variance 4/12. One xorshift64* output provides all four.
+double SfeSiT5811Simulation::gaussian(void)
+{
+    _prng ^= _prng >> 12;
+    _prng ^= _prng << 25;
+    _prng ^= _prng >> 27;
+    uint64_t r = _prng * 0x2545F4914F6CDD1D;
+
+    int32_t sum = (int32_t)(r & 0xFFFF) + (int32_t)((r >> 16) & 0xFFFF) + (int32_t)((r >> 32) & 0xFFFF) + (int32_t)(r >> 48);
+
+    return ((double)(sum - 131070)) * (1.7320508075688772 / 65536.0); // (sum - mean) * sqrt(3) / 65536
+}
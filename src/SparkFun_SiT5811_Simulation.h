@@ -0,0 +1,151 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Simulation.h
+
+    Description:
+    A simulated SiT5811 and GNSS receiver, for evaluating steering laws offline.
+    The oscillator reads its frequency control word from a SfeSiT5811RegisterFile,
+    so the driver under test is unmodified: it writes the register file exactly
+    as it would write the real part over I2C. The word is quantized to 39 bits
+    because that is all the registers can hold.
+
+    The oscillator fractional frequency is the sum of:
+        The control word (800ppm / 2^38 per LSB)
+        An initial frequency offset
+        Linear aging
+        Temperature: a sinusoid plus a random walk, times a temperature coefficient
+        White FM noise
+        Flicker FM noise (approximated by four first-order Markov processes, one per decade)
+        Oven warm-up: an offset which decays as the oven settles (off by default)
+    The oscillator time error is the integral of the fractional frequency.
+    The GNSS receiver reports RxClkBias = time error + white PM (measurement) noise, in milliseconds.
+
+    The oven is modeled from power-up: the heater is at full power for the saturation time,
+    then the power decays exponentially to its settled value, and the warm-up frequency
+    offset decays with it. The settled power follows the ambient temperature. Each epoch the
+    power is written to the Power Indicator registers (0x01-0x02); the Chip ID register
+    (0x03) is written by begin. With ovenTimeConstantSeconds zero the oven is already warm:
+    the power is the settled value, without noise.
+
+    Noise is generated with a xorshift64* PRNG and a four-term Irwin-Hall approximation to a
+    Gaussian. That is fast enough for millions of epochs per second on a PC, and repeatable
+    for a given seed.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811_RegisterFile.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation Parameters
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    double epochSeconds; // The time between epochs (RxClkBias reports)
+    double initialOffsetPPB; // Initial fractional frequency offset (PPB)
+    double initialTimeErrorSeconds; // Initial time error (s). Positive: receiver time is ahead
+    double agingPPBPerDay; // Linear aging (PPB per day)
+    double tempCoefficientPPBPerC; // Frequency change with temperature (PPB per degree C)
+    double tempAmplitudeC; // Amplitude of the sinusoidal temperature variation (degrees C)
+    double tempPeriodSeconds; // Period of the sinusoidal temperature variation (s)
+    double tempRandomWalkC; // Temperature random walk per epoch (degrees C, 1-sigma)
+    double whiteFMPPB; // White FM noise per epoch (PPB, 1-sigma)
+    double flickerFMPPB; // Flicker FM noise (PPB, 1-sigma of each of the four processes)
+    double gnssNoiseSeconds; // RxClkBias white PM noise (s, 1-sigma)
+    double ovenTimeConstantSeconds; // Oven settling time constant after saturation (s). 0: already warm
+    double ovenSaturationSeconds; // Time at full power after power-up (s)
+    double ovenWarmupPPB; // Frequency offset at power-up, decaying as the oven settles (PPB)
+    double ovenPowerSettled; // Settled oven power at the nominal temperature (fraction of full power)
+    double ovenPowerPerC; // Settled oven power change with temperature (fraction per degree C)
+    double ovenPowerNoise; // Power Indicator noise (fraction of full power, 1-sigma)
+    uint16_t chipID; // The Chip ID register value
+} sfe_SiT5811_sim_params_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Simulation
+{
+public:
+    /// @brief Constructor
+    /// @param theRegisters the register file the driver under test writes to
+    SfeSiT5811Simulation(SfeSiT5811RegisterFile &theRegisters) : _theRegisters(theRegisters)
+    {
+        getDefaultParameters(_params);
+        begin(_params);
+    }
+
+    /// @brief Fill params with typical SiT5811 and GNSS receiver values
+    /// @param params the parameters to fill
+    static void getDefaultParameters(sfe_SiT5811_sim_params_t &params);
+
+    /// @brief Start (or restart) the simulation
+    /// @param params the simulation parameters
+    /// @param seed the PRNG seed. The same seed gives the same noise
+    void begin(const sfe_SiT5811_sim_params_t &params, uint64_t seed = 1);
+
+    /// @brief Advance the simulation by one epoch
+    /// @return the GNSS RxClkBias in milliseconds - for setFrequencyByBiasMillis
+    double step(void);
+
+    /// @brief Get the number of epochs since begin
+    uint32_t getEpoch(void) { return _epoch; }
+
+    /// @brief Get the true time error (s), without the GNSS measurement noise
+    double getTimeErrorSeconds(void) { return _timeError; }
+
+    /// @brief Get the oscillator fractional frequency error (including the control word) for the last epoch
+    double getFractionalFrequency(void) { return _fractionalFrequency; }
+
+    /// @brief Get the fractional frequency error the control word would need to cancel (excluding the control word)
+    double getFreeRunningFrequency(void) { return _freeRunningFrequency; }
+
+    /// @brief Get the oscillator temperature offset (degrees C)
+    double getTemperatureC(void) { return _temperature; }
+
+    /// @brief Get the oven power for the last epoch (fraction of full power), before quantization
+    double getOvenPower(void) { return _ovenPower; }
+
+    /// @brief Get the oven warm-up frequency offset for the last epoch (fractional frequency)
+    double getWarmupFrequency(void) { return _warmupFrequency; }
+
+private:
+    /// @brief Return an approximately Gaussian random number with zero mean and unit variance
+    double gaussian(void);
+
+    SfeSiT5811RegisterFile &_theRegisters; // Where the driver under test writes the control word
+    sfe_SiT5811_sim_params_t _params;
+
+    // Cached by begin
+    double _agingPerEpoch; // Fractional frequency change per epoch due to aging
+    double _tempCos; // Rotation per epoch of the temperature phasor
+    double _tempSin;
+    double _flickerA[4]; // Markov process coefficients
+    double _flickerB[4];
+
+    // State
+    uint64_t _prng;
+    uint32_t _epoch;
+    double _timeError; // Seconds
+    double _fractionalFrequency;
+    double _freeRunningFrequency;
+    double _aging; // Fractional frequency due to aging
+    double _temperature; // Degrees C offset from nominal
+    double _tempRandomWalk; // Degrees C
+    double _tempPhasorCos; // The sinusoidal temperature, as a rotating phasor (no sin per epoch)
+    double _tempPhasorSin;
+    double _flicker[4]; // Flicker FM Markov processes
+    double _ovenPower; // Fraction of full power
+    double _warmupFrequency; // Fractional frequency due to the oven warm-up
+};
@@ -0,0 +1,104 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Snapshot.cpp
+
+    Description:
+    A warm-start snapshot of the steering state: the stored format, with versioning and a CRC.
+
+*/
+
+#include "SparkFun_SiT5811_Snapshot.h"
+
+// Store value in numBytes bytes, least significant first
+static void putLittleEndian(uint8_t *buffer, uint64_t value, uint8_t numBytes)
+{
+    for (uint8_t i = 0; i < numBytes; i++)
+    {
+        buffer[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+// Extract a value from numBytes bytes, least significant first
+static uint64_t getLittleEndian(const uint8_t *buffer, uint8_t numBytes)
+{
+    uint64_t value = 0;
+    for (uint8_t i = numBytes; i > 0; i--)
+        value = (value << 8) | buffer[i - 1];
+    return value;
+}
+
+/// @brief Convert a snapshot to the stored format
+/// @param snapshot the snapshot
+/// @param buffer the kSfeSiT5811SnapshotBytes buffer for the stored format
+void SfeSiT5811Snapshot::serialize(const sfe_SiT5811_snapshot_t &snapshot, uint8_t *buffer)
+{
+    buffer[0] = 'S';
+    buffer[1] = 'i';
+    buffer[2] = 'T';
+    buffer[3] = '5';
+    putLittleEndian(&buffer[4], kSfeSiT5811SnapshotVersion, 2);
+    putLittleEndian(&buffer[6], kSfeSiT5811SnapshotBytes, 2);
+    putLittleEndian(&buffer[8], snapshot.clip, 2);
+    putLittleEndian(&buffer[10], 0, 2); // Reserved
+    putLittleEndian(&buffer[12], snapshot.timestamp, 4);
+    putLittleEndian(&buffer[16], (uint64_t)snapshot.integratorPPQ, 8);
+    putLittleEndian(&buffer[24], (uint64_t)snapshot.driftMilliPPQ, 8);
+    putLittleEndian(&buffer[32], snapshot.baseFrequencyMilliHz, 8);
+    putLittleEndian(&buffer[40], crc32(buffer, 40), 4);
+}
+
+/// @brief Convert the stored format to a snapshot
+/// @param buffer the stored format
+/// @param numBytes the number of bytes in buffer
+/// @param snapshot returns the snapshot
+/// @return true if the magic, version, length and CRC are valid
+bool SfeSiT5811Snapshot::deserialize(const uint8_t *buffer, size_t numBytes, sfe_SiT5811_snapshot_t &snapshot)
+{
+    if (numBytes < kSfeSiT5811SnapshotBytes)
+        return false;
+
+    if ((buffer[0] != 'S') || (buffer[1] != 'i') || (buffer[2] != 'T') || (buffer[3] != '5'))
+        return false; // Nothing has been stored, or it is not a snapshot
+
+    uint16_t version = (uint16_t)getLittleEndian(&buffer[4], 2);
+    size_t length = (size_t)getLittleEndian(&buffer[6], 2);
+
+    if ((version != kSfeSiT5811SnapshotVersion) || (length != kSfeSiT5811SnapshotBytes))
+        return false;
+
+    if (crc32(buffer, length - 4) != (uint32_t)getLittleEndian(&buffer[length - 4], 4))
+        return false;
+
+    snapshot.clip = (uint16_t)getLittleEndian(&buffer[8], 2);
+    snapshot.timestamp = (uint32_t)getLittleEndian(&buffer[12], 4);
+    snapshot.integratorPPQ = (int64_t)getLittleEndian(&buffer[16], 8);
+    snapshot.driftMilliPPQ = (int64_t)getLittleEndian(&buffer[24], 8);
+    snapshot.baseFrequencyMilliHz = getLittleEndian(&buffer[32], 8);
+
+    return true;
+}
+
+/// @brief Calculate the CRC-32 (IEEE 802.3, reflected, polynomial 0x04C11DB7) of a block of bytes
+/// @param data the bytes
+/// @param numBytes the number of bytes
+/// @return the CRC
+uint32_t SfeSiT5811Snapshot::crc32(const uint8_t *data, size_t numBytes)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < numBytes; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1))); // No table: saves 1kB of flash
+    }
+    return ~crc;
+}
@@ -0,0 +1,102 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Snapshot.h
+
+    Description:
+    A warm-start snapshot of the steering state, so the loop re-locks in seconds after a reboot
+    instead of re-learning the oscillator offset from scratch.
+
+    SfeSiT5811Driver::saveSnapshot writes the snapshot to a SfeSiT5811Storage and
+    restoreSnapshot reads it back, then seeds the discipline integrator and the learned
+    drift, extrapolated over the time the system was down. Implement SfeSiT5811Storage
+    for your non-volatile memory: EEPROM or NVS on the target, a file on a host.
+
+    Stored format (kSfeSiT5811SnapshotBytes, all values little-endian):
+        char[4]  magic "SiT5"
+        uint16_t version (kSfeSiT5811SnapshotVersion)
+        uint16_t length - the number of bytes, including the CRC
+        uint16_t clip
+        uint16_t reserved (zero)
+        uint32_t timestamp (s)
+        int64_t  integrator offset from the base frequency (PPQ)
+        int64_t  learned drift (1e-18 per update)
+        uint64_t base frequency (mHz)
+        uint32_t CRC-32 (IEEE 802.3) of all the preceding bytes
+    The values are integers, so a snapshot saved on one platform can be restored on
+    another, whatever the size of double. A snapshot with a different version or length
+    is rejected, as is one with a bad CRC: the loop then starts cold, as it would with no
+    snapshot at all.
+    The control word is not stored: restoreSnapshot sets the frequency from the integrator,
+    which is what the loop would have converged to, so the word is recalculated.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const uint16_t kSfeSiT5811SnapshotVersion = 1;
+const size_t kSfeSiT5811SnapshotBytes = 44; // The version 1 length, including the CRC
+
+// The steering state
+typedef struct
+{
+    uint32_t timestamp; // When the snapshot was taken, in seconds (any epoch: GNSS, Unix, RTC). Zero if unknown
+    uint16_t clip; // The 13-bit Clip register value
+    int64_t integratorPPQ; // The discipline integrator: offset from the base frequency in PPQ (1e-15)
+    int64_t driftMilliPPQ; // The learned drift in 1e-18 per update (per second at 1Hz)
+    uint64_t baseFrequencyMilliHz; // The base frequency in mHz
+} sfe_SiT5811_snapshot_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Non-volatile storage for one snapshot
+class SfeSiT5811Storage
+{
+public:
+    /// @brief Read the stored bytes
+    /// @param data the buffer for the bytes
+    /// @param numBytes the number of bytes to read
+    /// @return true if the read is successful
+    virtual bool read(uint8_t *data, size_t numBytes) = 0;
+
+    /// @brief Store the bytes, replacing any previous snapshot
+    /// @param data the bytes to store
+    /// @param numBytes the number of bytes to store
+    /// @return true if the write is successful
+    virtual bool write(const uint8_t *data, size_t numBytes) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Converts snapshots to and from the stored format
+class SfeSiT5811Snapshot
+{
+public:
+    /// @brief Convert a snapshot to the stored format
+    /// @param snapshot the snapshot
+    /// @param buffer the kSfeSiT5811SnapshotBytes buffer for the stored format
+    static void serialize(const sfe_SiT5811_snapshot_t &snapshot, uint8_t *buffer);
+
+    /// @brief Convert the stored format to a snapshot
+    /// @param buffer the stored format
+    /// @param numBytes the number of bytes in buffer
+    /// @param snapshot returns the snapshot
+    /// @return true if the magic, version, length and CRC are valid
+    static bool deserialize(const uint8_t *buffer, size_t numBytes, sfe_SiT5811_snapshot_t &snapshot);
+
+    /// @brief Calculate the CRC-32 (IEEE 802.3, reflected, polynomial 0x04C11DB7) of a block of bytes
+    /// @param data the bytes
+    /// @param numBytes the number of bytes
+    /// @return the CRC
+    static uint32_t crc32(const uint8_t *data, size_t numBytes);
+};
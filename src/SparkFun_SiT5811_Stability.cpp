@@ -0,0 +1,197 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Stability.cpp
+
+    Description:
+    Streaming ADEV / TDEV / MTIE over the clock bias (phase) samples.
+
+    For phase samples x[i] at interval tau0, and tau = n tau0:
+        AVAR(tau) = sum((x[i+2n] - 2x[i+n] + x[i])^2) / (2 n^2 tau0^2 (N - 2n))
+        TVAR(tau) = sum(S[j]^2) / (6 n^2 (N - 3n + 1))
+            where S[j] = sum over n of the second differences = P[j+3n] - 3P[j+2n] + 3P[j+n] - P[j]
+            and P[k] = x[0] + ... + x[k-1] (prefix sums)
+        MTIE(tau) = max over all windows of n+1 samples of (max(x) - min(x))
+    The sums are updated as each sample arrives, so only the last 3n samples are needed.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_Stability.h"
+
+/// @brief Forget all samples
+void SfeSiT5811Stability::reset(void)
+{
+    _samples = 0;
+    _prefix[0] = 0.0; // P[0]
+
+    uint32_t *queue = _queues;
+    for (uint8_t k = 0; k < _octaves; k++)
+    {
+        uint16_t capacity = (uint16_t)((1UL << k) + 1); // A window of n+1 samples
+        sfe_SiT5811_stability_level_t *level = &_levels[k];
+
+        level->adevSum = 0.0;
+        level->adevCount = 0;
+        level->tdevSum = 0.0;
+        level->tdevCount = 0;
+        level->mtie = 0.0;
+        level->maxQueue = queue;
+        queue += capacity;
+        level->maxHead = 0;
+        level->maxCount = 0;
+        level->minQueue = queue;
+        queue += capacity;
+        level->minHead = 0;
+        level->minCount = 0;
+    }
+}
+
+/// @brief Add a phase (time error) sample
+/// @param seconds the time error in seconds
+void SfeSiT5811Stability::addPhase(double seconds)
+{
+    uint32_t t = _samples; // This sample's number
+    double x = seconds;
+
+    _phase[t & _mask] = x;
+    _prefix[(t + 1) & _mask] = _prefix[t & _mask] + x; // P[t+1]
+    double prefixNow = _prefix[(t + 1) & _mask];
+
+    for (uint8_t k = 0; k < _octaves; k++)
+    {
+        uint32_t n = 1UL << k;
+        uint16_t capacity = (uint16_t)(n + 1);
+        sfe_SiT5811_stability_level_t *level = &_levels[k];
+
+        // ADEV: second difference x[t] - 2x[t-n] + x[t-2n]
+        if (t >= (2 * n))
+        {
+            double d = x - (2.0 * _phase[(t - n) & _mask]) + _phase[(t - (2 * n)) & _mask];
+            level->adevSum += d * d;
+            level->adevCount++;
+        }
+
+        // TDEV: the sum of n second differences, from the prefix sums
+        if ((t + 1) >= (3 * n))
+        {
+            uint32_t p = t + 1;
+            double s = prefixNow - (3.0 * _prefix[(p - n) & _mask]) + (3.0 * _prefix[(p - (2 * n)) & _mask]) -
+                       _prefix[(p - (3 * n)) & _mask];
+            level->tdevSum += s * s;
+            level->tdevCount++;
+        }
+
+        // MTIE: sliding window maximum and minimum over samples t-n to t
+        // Remove the sample which has left the window, then the samples which can never be the max / min
+        if ((level->maxCount > 0) && ((t - level->maxQueue[level->maxHead]) > n))
+        {
+            level->maxHead = (level->maxHead + 1 == capacity) ? 0 : level->maxHead + 1;
+            level->maxCount--;
+        }
+        while (level->maxCount > 0)
+        {
+            uint16_t back = level->maxHead + level->maxCount - 1;
+            if (back >= capacity)
+                back -= capacity;
+            if (_phase[level->maxQueue[back] & _mask] > x)
+                break;
+            level->maxCount--;
+        }
+        uint16_t tail = level->maxHead + level->maxCount;
+        if (tail >= capacity)
+            tail -= capacity;
+        level->maxQueue[tail] = t;
+        level->maxCount++;
+
+        if ((level->minCount > 0) && ((t - level->minQueue[level->minHead]) > n))
+        {
+            level->minHead = (level->minHead + 1 == capacity) ? 0 : level->minHead + 1;
+            level->minCount--;
+        }
+        while (level->minCount > 0)
+        {
+            uint16_t back = level->minHead + level->minCount - 1;
+            if (back >= capacity)
+                back -= capacity;
+            if (_phase[level->minQueue[back] & _mask] < x)
+                break;
+            level->minCount--;
+        }
+        tail = level->minHead + level->minCount;
+        if (tail >= capacity)
+            tail -= capacity;
+        level->minQueue[tail] = t;
+        level->minCount++;
+
+        if (t >= n) // The window is full
+        {
+            double peakToPeak = _phase[level->maxQueue[level->maxHead] & _mask] - _phase[level->minQueue[level->minHead] & _mask];
+            if (peakToPeak > level->mtie)
+                level->mtie = peakToPeak;
+        }
+    }
+
+    _samples++;
+}
+
+/// @brief Add a GNSS RX clock bias sample
+/// @param bias the GNSS RX clock bias in milliseconds
+void SfeSiT5811Stability::addBiasMillis(double bias)
+{
+    addPhase(bias * 1.0e-3); // Convert to seconds
+}
+
+/// @brief Get tau for an octave
+/// @param octave 0 to getOctaves() - 1
+/// @return tau in seconds: tau0 * 2^octave
+double SfeSiT5811Stability::getTau(uint8_t octave)
+{
+    if (octave >= _octaves)
+        return 0.0;
+
+    return _tau0 * (double)(1UL << octave);
+}
+
+/// @brief Get the overlapping Allan deviation for an octave
+/// @param octave 0 to getOctaves() - 1
+/// @return ADEV (dimensionless). Zero if there are not yet enough samples (2 * 2^octave + 1)
+double SfeSiT5811Stability::getADEV(uint8_t octave)
+{
+    if ((octave >= _octaves) || (_levels[octave].adevCount == 0))
+        return 0.0;
+
+    double tau = getTau(octave);
+    return sqrt(_levels[octave].adevSum / (2.0 * tau * tau * (double)_levels[octave].adevCount));
+}
+
+/// @brief Get the time deviation for an octave
+/// @param octave 0 to getOctaves() - 1
+/// @return TDEV in seconds. Zero if there are not yet enough samples (3 * 2^octave)
+double SfeSiT5811Stability::getTDEV(uint8_t octave)
+{
+    if ((octave >= _octaves) || (_levels[octave].tdevCount == 0))
+        return 0.0;
+
+    double n = (double)(1UL << octave);
+    return sqrt(_levels[octave].tdevSum / (6.0 * n * n * (double)_levels[octave].tdevCount));
+}
+
+/// @brief Get the maximum time interval error for an octave
+/// @param octave 0 to getOctaves() - 1
+/// @return MTIE in seconds. Zero if there are not yet enough samples (2^octave + 1)
+double SfeSiT5811Stability::getMTIE(uint8_t octave)
+{
+    if (octave >= _octaves)
+        return 0.0;
+
+    return _levels[octave].mtie;
+}
@@ -0,0 +1,143 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Stability.h
+
+    Description:
+    Streaming frequency stability statistics over the clock bias (phase) samples:
+        Overlapping Allan deviation (ADEV)
+        Time deviation (TDEV)
+        Maximum time interval error (MTIE)
+    at octave-spaced taus: tau0, 2 tau0, 4 tau0 ... 2^(Octaves-1) tau0.
+
+    Memory is fixed by the number of octaves, independent of the run length:
+        Phase history and prefix sums: 2 x 2^(Octaves+1) doubles
+        MTIE sliding min/max queues: 2 x (2^Octaves - 1 + Octaves) uint32_t
+    E.g. 6 octaves (1s to 32s) needs approx. 2.6kB. Each sample costs O(Octaves),
+    i.e. O(1) for a given configuration. (The MTIE queues are amortized O(1).)
+
+    Usage:
+        SfeSiT5811StabilityN<6> myStability; // 6 octaves, 1s epochs
+        myOCXO.setStabilityEstimator(&myStability); // setFrequencyByBiasMillis now feeds it
+        ...
+        myStability.getADEV(3); // ADEV at tau = 8s
+
+    Note: the statistics use double. On AVR, double is a 32-bit float, which is too coarse
+    for the prefix sums used by TDEV over long runs. Use a 32-bit platform with a 64-bit double.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The running sums for one tau
+typedef struct
+{
+    double adevSum; // Sum of squared second differences of phase
+    uint32_t adevCount;
+    double tdevSum; // Sum of squared (sum of n second differences)
+    uint32_t tdevCount;
+    double mtie; // Maximum peak-to-peak phase in any window of n+1 samples
+    uint32_t *maxQueue; // Sliding window maximum: sample numbers, values decreasing
+    uint16_t maxHead;
+    uint16_t maxCount;
+    uint32_t *minQueue; // Sliding window minimum: sample numbers, values increasing
+    uint16_t minHead;
+    uint16_t minCount;
+} sfe_SiT5811_stability_level_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Stability
+{
+public:
+    /// @brief Forget all samples
+    void reset(void);
+
+    /// @brief Add a phase (time error) sample
+    /// @param seconds the time error in seconds
+    void addPhase(double seconds);
+
+    /// @brief Add a GNSS RX clock bias sample
+    /// @param bias the GNSS RX clock bias in milliseconds
+    void addBiasMillis(double bias);
+
+    /// @brief Get the number of octaves (taus)
+    uint8_t getOctaves(void) { return _octaves; }
+
+    /// @brief Get the number of samples since reset
+    uint32_t getSamples(void) { return _samples; }
+
+    /// @brief Get the sample interval tau0 (s)
+    double getTau0(void) { return _tau0; }
+
+    /// @brief Get tau for an octave
+    /// @param octave 0 to getOctaves() - 1
+    /// @return tau in seconds: tau0 * 2^octave
+    double getTau(uint8_t octave);
+
+    /// @brief Get the overlapping Allan deviation for an octave
+    /// @param octave 0 to getOctaves() - 1
+    /// @return ADEV (dimensionless). Zero if there are not yet enough samples (2 * 2^octave + 1)
+    double getADEV(uint8_t octave);
+
+    /// @brief Get the time deviation for an octave
+    /// @param octave 0 to getOctaves() - 1
+    /// @return TDEV in seconds. Zero if there are not yet enough samples (3 * 2^octave)
+    double getTDEV(uint8_t octave);
+
+    /// @brief Get the maximum time interval error for an octave
+    /// @param octave 0 to getOctaves() - 1
+    /// @return MTIE in seconds. Zero if there are not yet enough samples (2^octave + 1)
+    double getMTIE(uint8_t octave);
+
+protected:
+    /// @brief Constructor. The storage is provided by SfeSiT5811StabilityN
+    SfeSiT5811Stability(uint8_t octaves, double tau0, double *phase, double *prefix, uint32_t *queues,
+                        sfe_SiT5811_stability_level_t *levels)
+        : _octaves{octaves}, _tau0{tau0}, _mask{(uint32_t)((2UL << octaves) - 1)}, _phase{phase}, _prefix{prefix},
+          _queues{queues}, _levels{levels}
+    {
+    }
+
+private:
+    uint8_t _octaves; // The number of taus
+    double _tau0; // The sample interval (s)
+    uint32_t _mask; // Phase and prefix ring index mask: 2^(octaves+1) - 1
+    double *_phase; // Phase history ring: x[i]
+    double *_prefix; // Prefix sum ring: P[k] = x[0] + ... + x[k-1]
+    uint32_t *_queues; // MTIE queue storage
+    sfe_SiT5811_stability_level_t *_levels; // Per-tau running sums
+    uint32_t _samples; // Samples since reset
+};
+
+/// @brief The stability estimator, with its storage. Octaves sets the taus: tau0 to 2^(Octaves-1) tau0
+template <uint8_t Octaves> class SfeSiT5811StabilityN : public SfeSiT5811Stability
+{
+public:
+    static_assert((Octaves >= 1) && (Octaves <= 14), "Octaves must be 1 to 14");
+
+    /// @brief Constructor
+    /// @param tau0 the interval between samples in seconds. Default: 1 second
+    SfeSiT5811StabilityN(double tau0 = 1.0)
+        : SfeSiT5811Stability(Octaves, tau0, _phaseStore, _prefixStore, _queueStore, _levelStore)
+    {
+        reset();
+    }
+
+private:
+    double _phaseStore[2UL << Octaves];
+    double _prefixStore[2UL << Octaves];
+    uint32_t _queueStore[2 * ((1UL << Octaves) - 1 + Octaves)]; // Max and min queues of 2^k + 1 for each octave k
+    sfe_SiT5811_stability_level_t _levelStore[Octaves];
+};
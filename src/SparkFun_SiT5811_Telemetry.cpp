@@ -0,0 +1,260 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Telemetry.cpp
+
+    Description:
+    A compact binary record of every steering decision, held in a fixed-size ring buffer.
+
+*/
+
+#include "SparkFun_SiT5811_Clock.h"
+#include "SparkFun_SiT5811_Telemetry.h"
+
+// Append an unsigned LEB128 varint to buf. Return the number of bytes written
+static size_t putVarint(uint8_t *buf, uint64_t value)
+{
+    size_t len = 0;
+    while (value >= 0x80)
+    {
+        buf[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (uint8_t)value;
+    return len;
+}
+
+// Append a zigzag-encoded signed varint to buf. Return the number of bytes written
+static size_t putZigzag(uint8_t *buf, int64_t value)
+{
+    return putVarint(buf, (((uint64_t)value) << 1) ^ (uint64_t)(value >> 63));
+}
+
+/// @brief Forget all records
+void SfeSiT5811Telemetry::reset(void)
+{
+    _head = 0;
+    _count = 0;
+    _steps = 0;
+    _keyframe = true;
+    _lastTimestamp = 0;
+    _lastBiasPs = 0;
+    _lastControlWord = 0;
+    _records = 0;
+    _dropped = 0;
+}
+
+/// @brief Set the function which provides the timestamps
+/// @param clock returns the time in milliseconds. Default: millis() on Arduino, else a step counter
+void SfeSiT5811Telemetry::setClock(uint32_t (*clock)(void))
+{
+    _clock = clock;
+}
+
+/// @brief Add a record
+/// @param bias the GNSS RX clock bias in milliseconds
+/// @param controlWord the frequency control word
+/// @param flags kSfeSiT5811TelemetryFlag... (the keyframe flag is set automatically)
+/// @param busStatus the bus status (sfe_SiT5811_err_t)
+/// @return true if the record was stored, false if the buffer was full (the record is dropped)
+bool SfeSiT5811Telemetry::log(double bias, int64_t controlWord, uint8_t flags, int32_t busStatus)
+{
+#if defined(ARDUINO)
+    uint32_t timestamp = sfeSiT5811Millis(_clock);
+#else
+    uint32_t timestamp = (_clock != nullptr) ? _clock() : _steps++; // A host: a step counter, so a run is repeatable
+#endif
+
+    // Convert bias from milliseconds to picoseconds, rounded to nearest
+    double ps = bias * 1.0e9;
+    int64_t biasPs = (int64_t)((ps >= 0.0) ? (ps + 0.5) : (ps - 0.5));
+
+    // Encode the record
+    uint8_t record[kSfeSiT5811TelemetryMaxRecord];
+    size_t len = 0;
+
+    flags &= ~(kSfeSiT5811TelemetryFlagKeyframe | kSfeSiT5811TelemetryFlagBusError);
+    if (_keyframe)
+        flags |= kSfeSiT5811TelemetryFlagKeyframe;
+    if (busStatus != 0)
+        flags |= kSfeSiT5811TelemetryFlagBusError;
+    record[len++] = flags;
+
+    if (_keyframe)
+    {
+        len += putVarint(&record[len], timestamp);
+        len += putZigzag(&record[len], biasPs);
+        len += putZigzag(&record[len], controlWord);
+    }
+    else
+    {
+        len += putVarint(&record[len], (uint32_t)(timestamp - _lastTimestamp));
+        len += putZigzag(&record[len], biasPs - _lastBiasPs);
+        len += putZigzag(&record[len], controlWord - _lastControlWord);
+    }
+
+    if (busStatus != 0)
+        len += putZigzag(&record[len], busStatus);
+
+    // Store it - or drop it if there is no room
+    if (len > (_size - _count))
+    {
+        _dropped++;
+        _keyframe = true; // The decoder will have missed this delta
+        return false;
+    }
+
+    size_t tail = _head + _count;
+    if (tail >= _size)
+        tail -= _size;
+    for (size_t i = 0; i < len; i++)
+    {
+        _buffer[tail++] = record[i];
+        if (tail == _size)
+            tail = 0;
+    }
+    _count += len;
+
+    _keyframe = false;
+    _lastTimestamp = timestamp;
+    _lastBiasPs = biasPs;
+    _lastControlWord = controlWord;
+    _records++;
+
+    return true;
+}
+
+/// @brief Get the number of bytes waiting to be drained
+size_t SfeSiT5811Telemetry::available(void)
+{
+    return _count;
+}
+
+/// @brief Get a pointer to the next contiguous block of bytes to be drained - zero-copy
+/// @param data returns a pointer into the ring buffer
+/// @return the number of contiguous bytes at data. Call again after consume to get any bytes which wrapped
+size_t SfeSiT5811Telemetry::getReadable(const uint8_t *&data)
+{
+    data = &_buffer[_head];
+
+    if ((_head + _count) > _size) // The bytes wrap
+        return _size - _head;
+    return _count;
+}
+
+/// @brief Release bytes which have been drained
+/// @param bytes the number of bytes to release (up to the value returned by getReadable)
+void SfeSiT5811Telemetry::consume(size_t bytes)
+{
+    if (bytes > _count)
+        bytes = _count;
+
+    _head += bytes;
+    if (_head >= _size)
+        _head -= _size;
+    _count -= bytes;
+}
+
+/// @brief Forget the previous record. The next record must be a keyframe
+void SfeSiT5811TelemetryDecoder::reset(void)
+{
+    _field = 0;
+    _shift = 0;
+    _value = 0;
+    _synced = false;
+    _unsynced = 0;
+    _malformed = 0;
+}
+
+/// @brief Decode one byte
+/// @param b the next byte of the stream
+/// @param record returns the decoded record when complete
+/// @return true when a record is complete
+bool SfeSiT5811TelemetryDecoder::decode(uint8_t b, sfe_SiT5811_telemetry_record_t &record)
+{
+    if (_field == 0) // Flags
+    {
+        _current.flags = b;
+        _current.busStatus = 0;
+        _field = 1;
+        _shift = 0;
+        _value = 0;
+        return false;
+    }
+
+    if (_field == 5) // Skipping a malformed varint
+    {
+        if ((b & 0x80) == 0)
+            _field = 0; // The next byte is the flags of the next record
+        return false;
+    }
+
+    // Varint fields. A 64-bit value takes at most 10 bytes, and the 10th holds one bit
+    if ((_shift >= 64) || ((_shift == 63) && ((b & 0x7E) != 0)))
+    {
+        // Corrupt: reject the record and resynchronise at the next keyframe
+        _malformed++;
+        _synced = false;
+        _shift = 0;
+        _value = 0;
+        _field = ((b & 0x80) != 0) ? 5 : 0;
+        return false;
+    }
+
+    _value |= ((uint64_t)(b & 0x7F)) << _shift;
+    _shift += 7;
+    if ((b & 0x80) != 0)
+        return false; // More bytes follow
+
+    uint64_t value = _value;
+    int64_t signedValue = (int64_t)(value >> 1) ^ (0 - (int64_t)(value & 1)); // Undo zigzag
+    _value = 0;
+    _shift = 0;
+
+    bool keyframe = (_current.flags & kSfeSiT5811TelemetryFlagKeyframe) != 0;
+
+    switch (_field)
+    {
+    case 1:
+        _current.timestamp = keyframe ? (uint32_t)value : _last.timestamp + (uint32_t)value;
+        _field = 2;
+        return false;
+    case 2:
+        _current.biasPs = keyframe ? signedValue : _last.biasPs + signedValue;
+        _field = 3;
+        return false;
+    case 3:
+        _current.controlWord = keyframe ? signedValue : _last.controlWord + signedValue;
+        if ((_current.flags & kSfeSiT5811TelemetryFlagBusError) != 0)
+        {
+            _field = 4;
+            return false;
+        }
+        break;
+    default:
+        _current.busStatus = (int32_t)signedValue;
+        break;
+    }
+
+    // The record is complete
+    _field = 0;
+
+    if (keyframe)
+        _synced = true;
+    if (!_synced)
+    {
+        _unsynced++;
+        return false;
+    }
+
+    _last = _current;
+    record = _current;
+    return true;
+}
@@ -0,0 +1,175 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Telemetry.h
+
+    Description:
+    A compact binary record of every steering decision, held in a fixed-size
+    ring buffer (no heap). The buffer is drained zero-copy: getReadable returns
+    a pointer into the ring which can be passed straight to Serial.write or a
+    flash write, then consume releases the bytes.
+
+    Record format (one record per steering step):
+        uint8_t flags (kSfeSiT5811TelemetryFlag...)
+        varint  timestamp (ms) - delta from the previous record
+        zigzag  bias (ps) - delta from the previous record
+        zigzag  control word (LSB) - delta from the previous record
+        zigzag  bus status - only if kSfeSiT5811TelemetryFlagBusError is set
+    varint is LEB128: 7 bits per byte, least significant first, bit 7 set if more follow.
+    zigzag is a varint of (n << 1) ^ (n >> 63), so small negative numbers stay small.
+    If kSfeSiT5811TelemetryFlagKeyframe is set, the three values are absolute, not deltas.
+    The first record, and the first record after any dropped records, is a keyframe.
+    A steady-state record is typically 6-8 bytes.
+
+    SfeSiT5811TelemetryDecoder decodes the stream, e.g. in extras/host/SiT5811_TelemetryDecode.cpp.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Record Flags
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t kSfeSiT5811TelemetryFlagKeyframe = 0x01; // The values are absolute, not deltas
+const uint8_t kSfeSiT5811TelemetryFlagSlewLimited = 0x02; // The step was limited by the maximum frequency change
+const uint8_t kSfeSiT5811TelemetryFlagPullLimited = 0x04; // The step was limited by the pull range
+const uint8_t kSfeSiT5811TelemetryFlagBusError = 0x08; // The control word write failed. The bus status follows
+const uint8_t kSfeSiT5811TelemetryFlagRejected = 0x10; // The bias was rejected by the pre-filter (SfeSiT5811Filter)
+
+const size_t kSfeSiT5811TelemetryMaxRecord = 32; // The largest possible record, in bytes
+
+// A decoded record
+typedef struct
+{
+    uint8_t flags; // kSfeSiT5811TelemetryFlag...
+    uint32_t timestamp; // Milliseconds
+    int64_t biasPs; // GNSS RX clock bias in picoseconds
+    int64_t controlWord; // The 39-bit frequency control word
+    int32_t busStatus; // The bus status (sfe_SiT5811_err_t). Zero unless kSfeSiT5811TelemetryFlagBusError
+} sfe_SiT5811_telemetry_record_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Telemetry
+{
+public:
+    /// @brief Forget all records
+    void reset(void);
+
+    /// @brief Set the function which provides the timestamps
+    /// @param clock returns the time in milliseconds. Default: millis() on Arduino, else a step counter
+    void setClock(uint32_t (*clock)(void));
+
+    /// @brief Add a record
+    /// @param bias the GNSS RX clock bias in milliseconds
+    /// @param controlWord the frequency control word
+    /// @param flags kSfeSiT5811TelemetryFlag... (the keyframe flag is set automatically)
+    /// @param busStatus the bus status (sfe_SiT5811_err_t)
+    /// @return true if the record was stored, false if the buffer was full (the record is dropped)
+    bool log(double bias, int64_t controlWord, uint8_t flags, int32_t busStatus);
+
+    /// @brief Get the number of bytes waiting to be drained
+    size_t available(void);
+
+    /// @brief Get a pointer to the next contiguous block of bytes to be drained - zero-copy
+    /// @param data returns a pointer into the ring buffer
+    /// @return the number of contiguous bytes at data. Call again after consume to get any bytes which wrapped
+    size_t getReadable(const uint8_t *&data);
+
+    /// @brief Release bytes which have been drained
+    /// @param bytes the number of bytes to release (up to the value returned by getReadable)
+    void consume(size_t bytes);
+
+    /// @brief Get the number of records stored since reset
+    uint32_t getRecords(void) { return _records; }
+
+    /// @brief Get the number of records dropped because the buffer was full
+    uint32_t getDropped(void) { return _dropped; }
+
+protected:
+    /// @brief Constructor. The storage is provided by SfeSiT5811TelemetryN
+    SfeSiT5811Telemetry(uint8_t *buffer, size_t size) : _buffer{buffer}, _size{size}, _clock{nullptr}
+    {
+    }
+
+private:
+    uint8_t *_buffer; // The ring buffer
+    size_t _size; // The ring buffer size
+    size_t _head; // The next byte to drain
+    size_t _count; // The number of bytes waiting to be drained
+    uint32_t (*_clock)(void); // Timestamp source
+    uint32_t _steps; // Default timestamp: a step counter
+
+    // The previous record, for delta encoding
+    bool _keyframe; // true: the next record must be a keyframe
+    uint32_t _lastTimestamp;
+    int64_t _lastBiasPs;
+    int64_t _lastControlWord;
+
+    uint32_t _records;
+    uint32_t _dropped;
+};
+
+/// @brief The telemetry ring buffer, with its storage. Size is in bytes
+template <size_t Size> class SfeSiT5811TelemetryN : public SfeSiT5811Telemetry
+{
+public:
+    static_assert(Size >= kSfeSiT5811TelemetryMaxRecord, "Size must hold at least one record");
+
+    SfeSiT5811TelemetryN() : SfeSiT5811Telemetry(_store, Size)
+    {
+        reset();
+    }
+
+private:
+    uint8_t _store[Size];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Decodes the telemetry stream, one byte at a time
+class SfeSiT5811TelemetryDecoder
+{
+public:
+    SfeSiT5811TelemetryDecoder()
+    {
+        reset();
+    }
+
+    /// @brief Forget the previous record. The next record must be a keyframe
+    void reset(void);
+
+    /// @brief Decode one byte
+    /// @param b the next byte of the stream
+    /// @param record returns the decoded record when complete
+    /// @return true when a record is complete
+    bool decode(uint8_t b, sfe_SiT5811_telemetry_record_t &record);
+
+    /// @brief Get the number of records skipped because they were deltas with no preceding keyframe
+    uint32_t getUnsynced(void) { return _unsynced; }
+
+    /// @brief Get the number of records rejected because a varint was longer than 64 bits (a corrupt stream)
+    /// Note: the decoder skips to the end of the varint and waits for the next keyframe
+    uint32_t getMalformed(void) { return _malformed; }
+
+private:
+    uint8_t _field; // The field being decoded: 0 = flags ... 4 = bus status, 5 = skipping a malformed varint
+    uint8_t _shift; // The varint shift
+    uint64_t _value; // The varint being decoded
+    sfe_SiT5811_telemetry_record_t _current; // The record being decoded
+    sfe_SiT5811_telemetry_record_t _last; // The previous record, for delta decoding
+    bool _synced; // true once a keyframe has been decoded
+    uint32_t _unsynced;
+    uint32_t _malformed;
+};
@@ -0,0 +1,324 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Trajectory.cpp
+
+    Description:
+    Precomputed frequency trajectories: compiled once into packed control words, played out at a fixed rate.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_Clock.h"
+#include "SparkFun_SiT5811_Trajectory.h"
+
+/// @brief Start a new profile: forget the points. Call after setBaseFrequencyHz
+/// @param driver the driver to convert and write the words through
+/// @return true if started
+/// Note: the profile starts from the driver's current frequency
+bool SfeSiT5811Trajectory::begin(SfeSiT5811Driver *driver)
+{
+    clear();
+
+    _driver = driver;
+    if (_driver == nullptr)
+        return false;
+
+    double base = _driver->getBaseFrequencyHz();
+    if (base > 0.0)
+        _lastPPB = ((_driver->getFrequencyHz() - base) / base) * 1.0e9;
+    _targetPPB = _lastPPB;
+    return true;
+}
+
+/// @brief  PRIVATE: Forget the points and the statistics
+void SfeSiT5811Trajectory::clear(void)
+{
+    _length = 0;
+    _targetPPB = 0.0;
+    _lastPPB = 0.0;
+    _clamped = 0;
+    _slewLimited = 0;
+    _full = false;
+
+    _state = kSfeSiT5811TrajectoryIdle;
+    _position = 0;
+    _baseIndex = 0;
+    _baseMicros = 0;
+    _writes = 0;
+    _skipped = 0;
+    _writeFailures = 0;
+    _sumLateness = 0.0;
+    _sumLateness2 = 0.0;
+    _maxLatenessMicros = 0;
+}
+
+/// @brief Set the update interval. Call before adding segments: the points are compiled at this rate
+/// @param micros the interval in microseconds. Default: 100000 (10Hz)
+void SfeSiT5811Trajectory::setUpdateInterval(uint32_t micros)
+{
+    if (micros == 0)
+        micros = 1;
+    _intervalMicros = micros;
+}
+
+/// @brief Set the slew limit. Applies to the segments added after it
+/// @param ppbPerSecond the largest frequency change per second in PPB. 0 for no limit. Default: 0
+void SfeSiT5811Trajectory::setSlewLimit(double ppbPerSecond)
+{
+    _slewPPBPerSecond = fabs(ppbPerSecond);
+}
+
+/// @brief Hold the current target
+/// @param seconds the duration
+/// @return true if all the points fitted
+bool SfeSiT5811Trajectory::addHold(double seconds)
+{
+    uint32_t points = pointsFor(seconds);
+    bool ok = true;
+    for (uint32_t i = 0; i < points; i++)
+        ok = addPoint(_targetPPB) && ok;
+    return ok;
+}
+
+/// @brief Step to a new target and hold it. The step is slew limited
+/// @param ppb the target offset from the base frequency in PPB
+/// @param seconds the duration, including any slewing
+/// @return true if all the points fitted
+bool SfeSiT5811Trajectory::addStep(double ppb, double seconds)
+{
+    _targetPPB = ppb;
+    return addHold(seconds);
+}
+
+/// @brief Ramp linearly from the current target to a new target
+/// @param ppb the target offset from the base frequency in PPB
+/// @param seconds the duration
+/// @return true if all the points fitted
+bool SfeSiT5811Trajectory::addRamp(double ppb, double seconds)
+{
+    uint32_t points = pointsFor(seconds);
+    double from = _targetPPB;
+    bool ok = true;
+    for (uint32_t i = 1; i <= points; i++)
+        ok = addPoint(from + ((ppb - from) * (double)i / (double)points)) && ok;
+    _targetPPB = ppb;
+    return ok;
+}
+
+/// @brief A staircase: steps from start to stop in equal increments, each held for the dwell
+/// @param startPPB the first target offset in PPB
+/// @param stopPPB the last target offset in PPB
+/// @param steps the number of targets, including start and stop (at least 2)
+/// @param dwellSeconds the duration of each step
+/// @return true if all the points fitted
+bool SfeSiT5811Trajectory::addSweep(double startPPB, double stopPPB, uint16_t steps, double dwellSeconds)
+{
+    if (steps < 2)
+        steps = 2;
+
+    bool ok = true;
+    for (uint16_t i = 0; i < steps; i++)
+        ok = addStep(startPPB + ((stopPPB - startPPB) * (double)i / (double)(steps - 1)), dwellSeconds) && ok;
+    return ok;
+}
+
+/// @brief  PRIVATE: Compile one point: limit, convert and store
+/// @param  targetPPB the target offset in PPB
+/// @return true if the point fitted
+bool SfeSiT5811Trajectory::addPoint(double targetPPB)
+{
+    if ((_driver == nullptr) || (_state == kSfeSiT5811TrajectoryRunning))
+        return false;
+
+    if (_length >= _capacity)
+    {
+        _full = true;
+        return false;
+    }
+
+    // Limit to the pull range
+    double maxPPB = _driver->getMaxPullAvailable() * 1.0e9;
+    if (targetPPB > maxPPB)
+    {
+        targetPPB = maxPPB;
+        _clamped++;
+    }
+    if (targetPPB < (0.0 - maxPPB))
+    {
+        targetPPB = 0.0 - maxPPB;
+        _clamped++;
+    }
+
+    // Limit the change from the last point
+    if (_slewPPBPerSecond > 0.0)
+    {
+        double maxStep = _slewPPBPerSecond * (double)_intervalMicros * 1.0e-6;
+        if (targetPPB > (_lastPPB + maxStep))
+        {
+            targetPPB = _lastPPB + maxStep;
+            _slewLimited++;
+        }
+        else if (targetPPB < (_lastPPB - maxStep))
+        {
+            targetPPB = _lastPPB - maxStep;
+            _slewLimited++;
+        }
+    }
+    _lastPPB = targetPPB;
+
+    double base = _driver->getBaseFrequencyHz();
+    int64_t freq = _driver->getControlWordForHz(base + (base * targetPPB * 1.0e-9));
+
+    // Store the 39-bit word in five bytes, LSB first. Bits 39 and up are all sign
+    uint8_t *word = &_words[(uint32_t)_length * kSfeSiT5811TrajectoryWordBytes];
+    for (uint8_t i = 0; i < kSfeSiT5811TrajectoryWordBytes; i++)
+        word[i] = (uint8_t)(((uint64_t)freq) >> (8 * i));
+
+    _length++;
+    return true;
+}
+
+/// @brief  PRIVATE: Convert a duration to a number of points, at least one
+/// @param  seconds the duration
+uint32_t SfeSiT5811Trajectory::pointsFor(double seconds)
+{
+    double points = floor((seconds * 1.0e6 / (double)_intervalMicros) + 0.5);
+    if (points < 1.0)
+        return 1;
+    if (points > 65535.0)
+        return 65535; // More than any profile can hold
+    return (uint32_t)points;
+}
+
+/// @brief Get the duration of the profile in seconds
+double SfeSiT5811Trajectory::getDurationSeconds(void)
+{
+    return (double)_length * (double)_intervalMicros * 1.0e-6;
+}
+
+/// @brief Get a point of the profile
+/// @param index the point
+/// @return the control word, or zero if index is out of range
+int64_t SfeSiT5811Trajectory::getPoint(uint16_t index)
+{
+    if (index >= _length)
+        return 0;
+
+    const uint8_t *word = &_words[(uint32_t)index * kSfeSiT5811TrajectoryWordBytes];
+    uint32_t low = ((uint32_t)word[0]) | (((uint32_t)word[1]) << 8) | (((uint32_t)word[2]) << 16) |
+                   (((uint32_t)word[3]) << 24);
+    int64_t high = (int64_t)(int8_t)word[4]; // Sign extends bit 39
+    return (int64_t)(((uint64_t)high << 32) | (uint64_t)low);
+}
+
+/// @brief Start playing the profile from its first point. Resets the statistics
+/// @return true if started, false if there are no points
+bool SfeSiT5811Trajectory::start(void)
+{
+    if ((_driver == nullptr) || (_length == 0))
+        return false;
+
+    _position = 0;
+    _baseIndex = 0;
+    _baseMicros = now(); // The first point is due now
+    _writes = 0;
+    _skipped = 0;
+    _writeFailures = 0;
+    _sumLateness = 0.0;
+    _sumLateness2 = 0.0;
+    _maxLatenessMicros = 0;
+    _state = kSfeSiT5811TrajectoryRunning;
+    return true;
+}
+
+/// @brief Stop playing. The frequency stays where it is
+void SfeSiT5811Trajectory::stop(void)
+{
+    if (_state == kSfeSiT5811TrajectoryRunning)
+        _state = kSfeSiT5811TrajectoryIdle;
+}
+
+/// @brief Get the time
+/// @return the time in microseconds
+uint32_t SfeSiT5811Trajectory::now(void)
+{
+    return sfeSiT5811Micros(_clock); // No clock: only the first point is ever due. Call setClock
+}
+
+/// @brief Write the newest due point, if there is one
+/// @return the state
+sfe_SiT5811_trajectory_t SfeSiT5811Trajectory::update(void)
+{
+    if (_state != kSfeSiT5811TrajectoryRunning)
+        return _state;
+
+    // Find the newest due point. The schedule is rebased on each write, so the elapsed time
+    // stays short and the 32-bit microseconds wrap (71 minutes) is harmless
+    uint32_t timeNow = now();
+    uint32_t due = (uint32_t)_baseIndex + ((timeNow - _baseMicros) / _intervalMicros);
+    if (due < _position)
+        return _state; // Nothing due yet
+
+    if (due >= _length)
+        due = _length - 1; // Late for the last point: write it anyway
+
+    _skipped += due - _position;
+
+    _baseMicros += (due - _baseIndex) * _intervalMicros;
+    _baseIndex = (uint16_t)due;
+    uint32_t lateness = timeNow - _baseMicros;
+
+    if (!_driver->setFrequencyControlWord(getPoint((uint16_t)due)))
+        _writeFailures++;
+
+    _writes++;
+    _sumLateness += (double)lateness;
+    _sumLateness2 += (double)lateness * (double)lateness;
+    if (lateness > _maxLatenessMicros)
+        _maxLatenessMicros = lateness;
+
+    _position = (uint16_t)(due + 1);
+    if (_position >= _length)
+    {
+        if (_repeat)
+        {
+            // The first point is due one interval after the last
+            _position = 0;
+            _baseIndex = 0;
+            _baseMicros += _intervalMicros;
+        }
+        else
+            _state = kSfeSiT5811TrajectoryDone;
+    }
+
+    return _state;
+}
+
+/// @brief Get the mean lateness of the writes in microseconds
+double SfeSiT5811Trajectory::getMeanLatenessMicros(void)
+{
+    if (_writes == 0)
+        return 0.0;
+    return _sumLateness / (double)_writes;
+}
+
+/// @brief Get the standard deviation of the lateness of the writes in microseconds
+double SfeSiT5811Trajectory::getJitterMicros(void)
+{
+    if (_writes < 2)
+        return 0.0;
+    double mean = _sumLateness / (double)_writes;
+    double variance = (_sumLateness2 / (double)_writes) - (mean * mean);
+    if (variance <= 0.0)
+        return 0.0;
+    return sqrt(variance);
+}
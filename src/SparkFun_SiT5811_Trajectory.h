@@ -0,0 +1,254 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Trajectory.h
+
+    Description:
+    Precomputed frequency trajectories: ramps, steps and sweeps for calibration and test.
+
+    A profile is built from segments (hold, step, ramp, sweep) of frequency offsets in PPB
+    from the base frequency. Each segment is compiled once, when it is added, into one
+    control word per update interval (default 100ms):
+        The offset is limited to the pull range (getMaxPullAvailable)
+        The change from one point to the next is limited to the slew limit (PPB per second,
+        default none), so a step becomes a slew-limited ramp
+        The offset is converted with getControlWordForHz, so each word is exactly the word
+        setFrequencyHz would write for that offset
+    All of the floating point math happens here. The words are stored in five bytes each
+    (the 39-bit word, two's complement, in 40 bits): 200 bytes per 20 seconds at 10Hz.
+
+    Playback is integer only. start, then call update often: when a point is due it writes
+    that point's word with setFrequencyControlWord. The cost per point is the same for every
+    point: one division to find the due point, unpacking five bytes and the write. If update
+    is called too late for a point, that point is skipped (and counted) and the newest due
+    point is written, so the profile never falls behind its schedule.
+
+    The lateness of each write (the time from when the point was due to update writing it)
+    is measured, and reported as its mean, its standard deviation (the jitter) and maximum.
+
+    Usage:
+        SfeSiT5811TrajectoryN<600> myTrajectory; // 60 seconds at 10Hz: 3000 bytes
+        myTrajectory.begin(&myOCXO); // After setBaseFrequencyHz
+        myTrajectory.setSlewLimit(50.0); // PPB per second
+        myTrajectory.addStep(1000.0, 20.0); // +1ppm, held for 20s
+        myTrajectory.addRamp(-1000.0, 30.0); // Down to -1ppm over 30s
+        myTrajectory.addStep(0.0, 10.0);
+        myTrajectory.start();
+        ...
+        myTrajectory.update(); // In loop()
+
+    Playback bypasses the bias discipline. Do not call setFrequencyByBiasMillis while it
+    runs, and call resetDiscipline when it is done.
+
+    The time is micros() on Arduino, or CLOCK_MONOTONIC on a POSIX host. Call setClock to
+    use a different microsecond clock.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811.h"
+
+const uint8_t kSfeSiT5811TrajectoryWordBytes = 5; // Bytes stored per point
+
+typedef enum
+{
+    kSfeSiT5811TrajectoryIdle = 0, // Not started, or stopped
+    kSfeSiT5811TrajectoryRunning, // Playing
+    kSfeSiT5811TrajectoryDone // The last point has been written
+} sfe_SiT5811_trajectory_t;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SfeSiT5811Trajectory
+{
+public:
+    /// @brief Start a new profile: forget the points. Call after setBaseFrequencyHz
+    /// @param driver the driver to convert and write the words through
+    /// @return true if started
+    /// Note: the profile starts from the driver's current frequency
+    bool begin(SfeSiT5811Driver *driver);
+
+    /// @brief Set the update interval. Call before adding segments: the points are compiled at this rate
+    /// @param micros the interval in microseconds. Default: 100000 (10Hz)
+    void setUpdateInterval(uint32_t micros);
+
+    /// @brief Get the update interval in microseconds
+    uint32_t getUpdateInterval(void) { return _intervalMicros; }
+
+    /// @brief Set the slew limit. Applies to the segments added after it
+    /// @param ppbPerSecond the largest frequency change per second in PPB. 0 for no limit. Default: 0
+    void setSlewLimit(double ppbPerSecond);
+
+    /// @brief Get the slew limit in PPB per second
+    double getSlewLimit(void) { return _slewPPBPerSecond; }
+
+    /// @brief Hold the current target
+    /// @param seconds the duration
+    /// @return true if all the points fitted
+    bool addHold(double seconds);
+
+    /// @brief Step to a new target and hold it. The step is slew limited
+    /// @param ppb the target offset from the base frequency in PPB
+    /// @param seconds the duration, including any slewing
+    /// @return true if all the points fitted
+    bool addStep(double ppb, double seconds);
+
+    /// @brief Ramp linearly from the current target to a new target
+    /// @param ppb the target offset from the base frequency in PPB
+    /// @param seconds the duration
+    /// @return true if all the points fitted
+    bool addRamp(double ppb, double seconds);
+
+    /// @brief A staircase: steps from start to stop in equal increments, each held for the dwell
+    /// @param startPPB the first target offset in PPB
+    /// @param stopPPB the last target offset in PPB
+    /// @param steps the number of targets, including start and stop (at least 2)
+    /// @param dwellSeconds the duration of each step
+    /// @return true if all the points fitted
+    bool addSweep(double startPPB, double stopPPB, uint16_t steps, double dwellSeconds);
+
+    /// @brief Get the number of points in the profile
+    uint16_t getLength(void) { return _length; }
+
+    /// @brief Get the maximum number of points
+    uint16_t getCapacity(void) { return _capacity; }
+
+    /// @brief Get the duration of the profile in seconds
+    double getDurationSeconds(void);
+
+    /// @brief Get a point of the profile
+    /// @param index the point
+    /// @return the control word, or zero if index is out of range
+    int64_t getPoint(uint16_t index);
+
+    /// @brief Get the number of points limited by the pull range
+    uint16_t getClamped(void) { return _clamped; }
+
+    /// @brief Get the number of points limited by the slew limit
+    uint16_t getSlewLimited(void) { return _slewLimited; }
+
+    /// @brief Check if points were lost because the profile was full
+    bool isFull(void) { return _full; }
+
+    /// @brief Repeat the profile when it reaches the end
+    /// @param repeat true to repeat. Default: false
+    void setRepeat(bool repeat) { _repeat = repeat; }
+
+    /// @brief Start playing the profile from its first point. Resets the statistics
+    /// @return true if started, false if there are no points
+    bool start(void);
+
+    /// @brief Stop playing. The frequency stays where it is
+    void stop(void);
+
+    /// @brief Write the newest due point, if there is one
+    /// @return the state
+    sfe_SiT5811_trajectory_t update(void);
+
+    /// @brief Get the state
+    sfe_SiT5811_trajectory_t getState(void) { return _state; }
+
+    /// @brief Get the index of the next point to be written
+    uint16_t getPosition(void) { return _position; }
+
+    /// @brief Set the function which provides the time
+    /// @param clock returns the time in microseconds. nullptr to restore the default
+    void setClock(uint32_t (*clock)(void)) { _clock = clock; }
+
+    /// @brief Get the time
+    /// @return the time in microseconds
+    uint32_t now(void);
+
+    /// @brief Get the number of points written since start
+    uint32_t getWrites(void) { return _writes; }
+
+    /// @brief Get the number of points skipped since start, because update was called too late
+    uint32_t getSkipped(void) { return _skipped; }
+
+    /// @brief Get the number of failed writes since start
+    uint32_t getWriteFailures(void) { return _writeFailures; }
+
+    /// @brief Get the mean lateness of the writes in microseconds
+    double getMeanLatenessMicros(void);
+
+    /// @brief Get the standard deviation of the lateness of the writes in microseconds
+    double getJitterMicros(void);
+
+    /// @brief Get the largest lateness of a write in microseconds
+    uint32_t getMaxLatenessMicros(void) { return _maxLatenessMicros; }
+
+protected:
+    /// @brief Constructor. The storage is provided by SfeSiT5811TrajectoryN
+    SfeSiT5811Trajectory(uint16_t capacity, uint8_t *words)
+        : _words{words}, _capacity{capacity}, _driver{nullptr}, _clock{nullptr}, _intervalMicros{100000},
+          _slewPPBPerSecond{0.0}, _repeat{false}
+    {
+        clear();
+    }
+
+private:
+    /// @brief Forget the points and the statistics
+    void clear(void);
+
+    /// @brief Compile one point: limit, convert and store
+    /// @param targetPPB the target offset in PPB
+    /// @return true if the point fitted
+    bool addPoint(double targetPPB);
+
+    /// @brief Convert a duration to a number of points, at least one
+    /// @param seconds the duration
+    uint32_t pointsFor(double seconds);
+
+    uint8_t *_words;
+    uint16_t _capacity;
+    SfeSiT5811Driver *_driver;
+    uint32_t (*_clock)(void);
+    uint32_t _intervalMicros;
+    double _slewPPBPerSecond;
+    bool _repeat;
+
+    // Compiling
+    uint16_t _length;
+    double _targetPPB; // The profile's target: where the next segment starts
+    double _lastPPB; // The last compiled point, after the limits
+    uint16_t _clamped;
+    uint16_t _slewLimited;
+    bool _full;
+
+    // Playing
+    sfe_SiT5811_trajectory_t _state;
+    uint16_t _position; // The next point to be written
+    uint16_t _baseIndex; // The point which is due at _baseMicros
+    uint32_t _baseMicros;
+    uint32_t _writes;
+    uint32_t _skipped;
+    uint32_t _writeFailures;
+    double _sumLateness;
+    double _sumLateness2;
+    uint32_t _maxLatenessMicros;
+};
+
+/// @brief A trajectory with its storage. Points is the maximum number of points (5 bytes each)
+template <uint16_t Points> class SfeSiT5811TrajectoryN : public SfeSiT5811Trajectory
+{
+public:
+    static_assert(Points >= 2, "Points must be at least 2");
+
+    /// @brief Constructor
+    SfeSiT5811TrajectoryN() : SfeSiT5811Trajectory(Points, _wordStore)
+    {
+    }
+
+private:
+    uint8_t _wordStore[(uint32_t)Points * kSfeSiT5811TrajectoryWordBytes];
+};
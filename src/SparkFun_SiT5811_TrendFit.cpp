@@ -0,0 +1,104 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_TrendFit.cpp
+
+    Description:
+    An exponentially-weighted least-squares fit of y = a + b * t.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_TrendFit.h"
+
+/// @brief Forget the points. Does not change the time constant
+void SfeSiT5811TrendFit::reset(void)
+{
+    _s0 = 0.0;
+    _st = 0.0;
+    _stt = 0.0;
+    _sy = 0.0;
+    _sty = 0.0;
+    _syy = 0.0;
+}
+
+/// @brief Add a point
+/// @param y the value
+/// @param dt the time since the previous point in seconds. Ignored for the first point
+void SfeSiT5811TrendFit::add(double y, double dt)
+{
+    if (_s0 > 0.0)
+    {
+        // Move t = 0 to now: every earlier point is dt older. Then age the weights
+        _stt = _stt - (2.0 * dt * _st) + (dt * dt * _s0);
+        _st = _st - (dt * _s0);
+        _sty = _sty - (dt * _sy);
+
+        double w = exp(0.0 - (dt / _timeConstantSeconds));
+        _s0 *= w;
+        _st *= w;
+        _stt *= w;
+        _sy *= w;
+        _sty *= w;
+        _syy *= w;
+    }
+
+    // Add the new point at t = 0: only the t-independent sums change
+    _s0 += 1.0;
+    _sy += y;
+    _syy += y * y;
+}
+
+/// @brief Solve the fit at the latest point
+/// @param a returns the fitted value at the latest point
+/// @param b returns the fitted slope per second
+/// @return false if the fit is singular (fewer than two distinct times)
+bool SfeSiT5811TrendFit::solve(double &a, double &b)
+{
+    double determinant = (_s0 * _stt) - (_st * _st);
+    if ((_s0 <= 0.0) || (determinant <= 0.0))
+        return false; // Fewer than two distinct times
+
+    b = ((_s0 * _sty) - (_st * _sy)) / determinant;
+    a = (_sy - (b * _st)) / _s0;
+    return true;
+}
+
+/// @brief Get the weighted residual: sum of w.(y - a - b.t)^2
+/// @param a the fitted value, from solve
+/// @param b the fitted slope, from solve
+/// @return the residual. Zero if rounding makes it negative
+double SfeSiT5811TrendFit::getResidual(double a, double b)
+{
+    // Expanded. At the solution this reduces to _syy - a._sy - b._sty, but the full form
+    // is exact for any a and b
+    double residual = _syy - (2.0 * a * _sy) - (2.0 * b * _sty) + (a * a * _s0) + (2.0 * a * b * _st) + (b * b * _stt);
+    return (residual > 0.0) ? residual : 0.0;
+}
+
+/// @brief Get the standard errors of the fitted value and slope
+/// @param a the fitted value, from solve
+/// @param b the fitted slope, from solve
+/// @param sigmaA returns the standard error of a
+/// @param sigmaB returns the standard error of b, per second
+/// @return false if there are too few points (a total weight of two or less) or the residual is zero
+bool SfeSiT5811TrendFit::getStandardErrors(double a, double b, double &sigmaA, double &sigmaB)
+{
+    double residual = getResidual(a, b);
+    double determinant = (_s0 * _stt) - (_st * _st);
+    if ((residual <= 0.0) || (_s0 <= 2.0) || (determinant <= 0.0))
+        return false;
+
+    double variance = residual / (_s0 - 2.0);
+    sigmaA = sqrt(variance * _stt / determinant);
+    sigmaB = sqrt(variance * _s0 / determinant);
+    return true;
+}
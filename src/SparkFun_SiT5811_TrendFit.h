@@ -0,0 +1,84 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_TrendFit.h
+
+    Description:
+    An exponentially-weighted least-squares fit of y = a + b * t, used by SfeSiT5811Holdover
+    (the control word) and SfeSiT5811Warmup (the Power Indicator).
+
+    The fit is held as six running sums, with t measured back from the latest point (so a is
+    the fitted value now). Each add moves t = 0 to the new point, ages the weights by
+    exp(-dt / time constant), then adds the point: O(1) with fixed memory, and the sums never
+    grow with the run time.
+
+*/
+
+#pragma once
+
+class SfeSiT5811TrendFit
+{
+public:
+    /// @brief Constructor
+    /// @param seconds the time constant
+    SfeSiT5811TrendFit(double seconds) : _timeConstantSeconds{seconds}
+    {
+        reset();
+    }
+
+    /// @brief Forget the points. Does not change the time constant
+    void reset(void);
+
+    /// @brief Set the time constant
+    /// @param seconds older points are weighted by exp(-age / seconds)
+    void setTimeConstant(double seconds) { _timeConstantSeconds = seconds; }
+
+    /// @brief Get the time constant in seconds
+    double getTimeConstant(void) { return _timeConstantSeconds; }
+
+    /// @brief Add a point
+    /// @param y the value
+    /// @param dt the time since the previous point in seconds. Ignored for the first point
+    void add(double y, double dt);
+
+    /// @brief Solve the fit at the latest point
+    /// @param a returns the fitted value at the latest point
+    /// @param b returns the fitted slope per second
+    /// @return false if the fit is singular (fewer than two distinct times)
+    bool solve(double &a, double &b);
+
+    /// @brief Get the weighted residual: sum of w.(y - a - b.t)^2
+    /// @param a the fitted value, from solve
+    /// @param b the fitted slope, from solve
+    /// @return the residual. Zero if rounding makes it negative
+    double getResidual(double a, double b);
+
+    /// @brief Get the standard errors of the fitted value and slope
+    /// @param a the fitted value, from solve
+    /// @param b the fitted slope, from solve
+    /// @param sigmaA returns the standard error of a
+    /// @param sigmaB returns the standard error of b, per second
+    /// @return false if there are too few points (a total weight of two or less) or the residual is zero
+    bool getStandardErrors(double a, double b, double &sigmaA, double &sigmaB);
+
+    /// @brief Get the total weight: the number of points, aged
+    double getWeight(void) { return _s0; }
+
+private:
+    double _timeConstantSeconds;
+
+    // The weighted sums, with t = 0 at the latest point
+    double _s0; // Sum of w
+    double _st; // Sum of w.t
+    double _stt; // Sum of w.t^2
+    double _sy; // Sum of w.y
+    double _sty; // Sum of w.t.y
+    double _syy; // Sum of w.y^2
+};
@@ -0,0 +1,198 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Warmup.cpp
+
+    Description:
+    Oven warm-up and readiness detection: an incremental least-squares trend of the Power Indicator.
+
+*/
+
+#include <math.h>
+
+#include "SparkFun_SiT5811_Clock.h"
+#include "SparkFun_SiT5811_Warmup.h"
+
+/// @brief Start watching the oven. Call soon after power-up
+/// @param driver the driver to read the Power Indicator through
+/// @return true if started
+bool SfeSiT5811Warmup::begin(SfeSiT5811Driver *driver)
+{
+    reset();
+
+    _driver = driver;
+    if (_driver == nullptr)
+        return false;
+
+    _beginMillis = now();
+    _state = kSfeSiT5811WarmupHeating; // Until the first sample says otherwise
+    return true;
+}
+
+/// @brief Forget the samples and stop. Does not change the settings
+void SfeSiT5811Warmup::reset(void)
+{
+    _fit.reset();
+
+    _state = kSfeSiT5811WarmupStopped;
+    _ready = false;
+    _lastPower = 0.0;
+    _beginMillis = 0;
+    _lastSampleMillis = 0;
+    _settlingMillis = 0;
+    _settledMillis = 0;
+    _settling = false;
+    _settled = false;
+    _readySeconds = 0.0;
+    _samples = 0;
+    _readFailures = 0;
+    _consecutiveFailures = 0;
+}
+
+/// @brief Set the time constant of the trend fit
+/// @param seconds older samples are weighted by exp(-age / seconds). Default: 60
+void SfeSiT5811Warmup::setTimeConstant(double seconds)
+{
+    if (seconds < 5.0)
+        seconds = 5.0; // Shorter than this and the slope is mostly noise
+    _fit.setTimeConstant(seconds);
+}
+
+/// @brief Set the slope threshold
+/// @param fractionPerMinute settled when the power changes by less than this fraction of full power per minute. Default: 0.002
+void SfeSiT5811Warmup::setSlopeThreshold(double fractionPerMinute)
+{
+    _slopeThresholdPerMinute = fabs(fractionPerMinute);
+}
+
+/// @brief Get the time
+/// @return the time in milliseconds
+uint32_t SfeSiT5811Warmup::now(void)
+{
+    return sfeSiT5811Millis(_clock); // No clock: never ready. Call setClock
+}
+
+/// @brief Read the Power Indicator when a sample is due and update the state
+/// @return the state
+sfe_SiT5811_warmup_t SfeSiT5811Warmup::update(void)
+{
+    if ((_state == kSfeSiT5811WarmupStopped) || (_driver == nullptr))
+        return _state;
+
+    uint32_t millisNow = now();
+    if (((_samples > 0) || (_readFailures > 0)) && ((millisNow - _lastSampleMillis) < _sampleIntervalMillis))
+        return _state;
+
+    if (!_driver->readPowerIndicator())
+    {
+        _lastSampleMillis = millisNow; // Try again at the next interval
+        _readFailures++;
+        if (_consecutiveFailures < 255)
+            _consecutiveFailures++;
+        if ((_consecutiveFailures >= kSfeSiT5811WarmupMaxFailures) && !_ready)
+            _state = kSfeSiT5811WarmupFault;
+        return _state;
+    }
+
+    _consecutiveFailures = 0;
+    addSample(_driver->getPowerFraction(), millisNow);
+    return _state;
+}
+
+/// @brief Add a Power Indicator sample - update calls this
+/// @param power the power as a fraction of full power
+/// @param millisNow the time of the sample in milliseconds
+void SfeSiT5811Warmup::addSample(double power, uint32_t millisNow)
+{
+    double dt = (double)(millisNow - _lastSampleMillis) * 0.001; // Unsigned: correct across the 32-bit wrap
+    _fit.add(power, dt);
+
+    _lastPower = power;
+    _lastSampleMillis = millisNow;
+    _samples++;
+
+    if (_ready)
+    {
+        _state = kSfeSiT5811WarmupReady; // Latched. The fit keeps tracking the power
+        return;
+    }
+
+    if (power >= _saturation)
+    {
+        _settling = false;
+        _settled = false;
+        _state = kSfeSiT5811WarmupHeating;
+    }
+    else
+    {
+        if (!_settling)
+        {
+            _settling = true;
+            _settlingMillis = millisNow;
+        }
+
+        // The fit needs a time constant of samples below saturation before its slope means anything
+        double a;
+        double b;
+        bool slopeLow = ((double)(millisNow - _settlingMillis) >= (_fit.getTimeConstant() * 1000.0)) && _fit.solve(a, b) &&
+                        (fabs(b * 60.0) < _slopeThresholdPerMinute);
+
+        if (!slopeLow)
+            _settled = false;
+        else if (!_settled)
+        {
+            _settled = true;
+            _settledMillis = millisNow;
+        }
+
+        if (_settled && ((double)(millisNow - _settledMillis) >= (_holdSeconds * 1000.0)))
+        {
+            _ready = true;
+            _readySeconds = (double)(millisNow - _beginMillis) * 0.001;
+            _state = kSfeSiT5811WarmupReady;
+            return;
+        }
+
+        _state = kSfeSiT5811WarmupSettling;
+    }
+
+    if ((double)(millisNow - _beginMillis) >= (_timeoutSeconds * 1000.0))
+        _state = kSfeSiT5811WarmupTimeout;
+}
+
+/// @brief Get the fitted power trend
+/// @return the slope in fraction of full power per minute
+double SfeSiT5811Warmup::getSlopePerMinute(void)
+{
+    double a;
+    double b;
+    if (!_fit.solve(a, b))
+        return 0.0;
+    return b * 60.0;
+}
+
+/// @brief Get the RMS residual of the trend fit, as a fraction of full power
+double SfeSiT5811Warmup::getNoise(void)
+{
+    double a;
+    double b;
+    if (!_fit.solve(a, b))
+        return 0.0;
+
+    return sqrt(_fit.getResidual(a, b) / _fit.getWeight());
+}
+
+/// @brief Get the time since begin, in seconds
+double SfeSiT5811Warmup::getSeconds(void)
+{
+    if (_state == kSfeSiT5811WarmupStopped)
+        return 0.0;
+    return (double)(now() - _beginMillis) * 0.001;
+}
@@ -0,0 +1,171 @@
+/*
+    SparkFun SiT5811 OCXO Arduino Library
+
+    Repository
+    https://github.com/sparkfun/SparkFun_SiT5811_OCXO_Arduino_Library
+
+    SPDX-License-Identifier: MIT
+
+    Copyright (c) 2024 SparkFun Electronics
+
+    Name: SparkFun_SiT5811_Warmup.h
+
+    Description:
+    Oven warm-up and readiness detection from the Power Indicator (the oven PID output).
+
+    After power-up the oven heater runs at full power, then its power falls as the oven
+    approaches its set point and settles at a steady value which depends on the ambient
+    temperature. The crystal frequency settles with it. Instead of waiting a fixed,
+    pessimistic time before disciplining, watch the power:
+        Heating:  the power is at or above the saturation level (default 98%)
+        Settling: the power is falling. Its trend is an exponentially-weighted least-squares
+                  fit of power = a + b * t (time constant default 60s), held as six running
+                  sums (SfeSiT5811TrendFit, shared with SfeSiT5811Holdover): O(1) per sample, fixed memory
+        Ready:    the slope |b| has stayed below the threshold (default 0.2% of full power
+                  per minute) for the hold time (default 60s). Ready is latched until begin
+        Timeout:  not ready after the timeout (default 30 minutes). It can still become Ready
+        Fault:    the Power Indicator could not be read five times in a row
+
+    Usage:
+        SfeSiT5811Warmup myWarmup;
+        myWarmup.begin(&myOCXO); // Soon after power-up
+        ...
+        if (myWarmup.update() == kSfeSiT5811WarmupReady) // Call often: reads the power once per second
+            myOCXO.setFrequencyByBiasMillis(bias);
+
+    The time is millis() on Arduino, or CLOCK_MONOTONIC on a POSIX host. Call setClock to
+    use a different millisecond clock.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "SparkFun_SiT5811.h"
+#include "SparkFun_SiT5811_TrendFit.h"
+
+const uint8_t kSfeSiT5811WarmupMaxFailures = 5; // Consecutive read failures before Fault
+
+typedef enum
+{
+    kSfeSiT5811WarmupStopped = 0, // begin has not been called
+    kSfeSiT5811WarmupHeating, // The heater is at full power
+    kSfeSiT5811WarmupSettling, // The power is still changing
+    kSfeSiT5811WarmupReady, // The power has settled: start disciplining
+    kSfeSiT5811WarmupTimeout, // Not settled after the timeout
+    kSfeSiT5811WarmupFault // The Power Indicator cannot be read
+} sfe_SiT5811_warmup_t;
+
+class SfeSiT5811Warmup
+{
+public:
+    SfeSiT5811Warmup()
+        : _driver{nullptr}, _clock{nullptr}, _slopeThresholdPerMinute{0.002}, _holdSeconds{60.0}, _saturation{0.98},
+          _timeoutSeconds{1800.0}, _sampleIntervalMillis{1000}, _fit{60.0}
+    {
+        reset();
+    }
+
+    /// @brief Start watching the oven. Call soon after power-up
+    /// @param driver the driver to read the Power Indicator through
+    /// @return true if started
+    bool begin(SfeSiT5811Driver *driver);
+
+    /// @brief Forget the samples and stop. Does not change the settings
+    void reset(void);
+
+    /// @brief Set the time constant of the trend fit
+    /// @param seconds older samples are weighted by exp(-age / seconds). Default: 60
+    void setTimeConstant(double seconds);
+
+    /// @brief Set the slope threshold
+    /// @param fractionPerMinute settled when the power changes by less than this fraction of full power per minute. Default: 0.002
+    void setSlopeThreshold(double fractionPerMinute);
+
+    /// @brief Set how long the slope must stay below the threshold
+    /// @param seconds the hold time. Default: 60
+    void setHoldTime(double seconds) { _holdSeconds = seconds; }
+
+    /// @brief Set the saturation level
+    /// @param fraction at or above this fraction of full power the heater is saturated (Heating). Default: 0.98
+    void setSaturation(double fraction) { _saturation = fraction; }
+
+    /// @brief Set the timeout
+    /// @param seconds report Timeout if not ready after this long. Default: 1800
+    void setTimeout(double seconds) { _timeoutSeconds = seconds; }
+
+    /// @brief Set how often the Power Indicator is read
+    /// @param millis the interval in milliseconds. Default: 1000
+    void setSampleInterval(uint32_t millis) { _sampleIntervalMillis = millis; }
+
+    /// @brief Set the function which provides the time
+    /// @param clock returns the time in milliseconds. nullptr to restore the default
+    void setClock(uint32_t (*clock)(void)) { _clock = clock; }
+
+    /// @brief Get the time
+    /// @return the time in milliseconds
+    uint32_t now(void);
+
+    /// @brief Read the Power Indicator when a sample is due and update the state
+    /// @return the state
+    sfe_SiT5811_warmup_t update(void);
+
+    /// @brief Add a Power Indicator sample - update calls this
+    /// @param power the power as a fraction of full power
+    /// @param millisNow the time of the sample in milliseconds
+    void addSample(double power, uint32_t millisNow);
+
+    /// @brief Get the state
+    sfe_SiT5811_warmup_t getState(void) { return _state; }
+
+    /// @brief Check if the oven has settled
+    bool isReady(void) { return _ready; }
+
+    /// @brief Get the last power sample, as a fraction of full power
+    double getPower(void) { return _lastPower; }
+
+    /// @brief Get the fitted power trend
+    /// @return the slope in fraction of full power per minute
+    double getSlopePerMinute(void);
+
+    /// @brief Get the RMS residual of the trend fit, as a fraction of full power
+    double getNoise(void);
+
+    /// @brief Get the time since begin, in seconds
+    double getSeconds(void);
+
+    /// @brief Get the time from begin to Ready, in seconds. Zero if not ready
+    double getReadySeconds(void) { return _readySeconds; }
+
+    /// @brief Get the number of samples since begin
+    uint32_t getSamples(void) { return _samples; }
+
+    /// @brief Get the number of failed Power Indicator reads since begin
+    uint32_t getReadFailures(void) { return _readFailures; }
+
+private:
+    SfeSiT5811Driver *_driver;
+    uint32_t (*_clock)(void);
+    double _slopeThresholdPerMinute;
+    double _holdSeconds;
+    double _saturation;
+    double _timeoutSeconds;
+    uint32_t _sampleIntervalMillis;
+
+    SfeSiT5811TrendFit _fit; // y is the power, as a fraction of full power
+
+    sfe_SiT5811_warmup_t _state;
+    bool _ready;
+    double _lastPower;
+    uint32_t _beginMillis;
+    uint32_t _lastSampleMillis;
+    uint32_t _settlingMillis; // When the power fell below saturation
+    uint32_t _settledMillis; // When the slope went below the threshold
+    bool _settling; // The power is below saturation
+    bool _settled; // The slope is below the threshold
+    double _readySeconds;
+    uint32_t _samples;
+    uint32_t _readFailures;
+    uint8_t _consecutiveFailures;
+};